@@ -348,6 +348,38 @@ void am33xx_spl_board_init(void)
 }
 #endif
 
+#if defined(CONFIG_SPL_BUILD) && defined(CONFIG_SPL_OS_BOOT)
+void spl_board_prepare_for_linux(void)
+{
+	/* nothing to do, the kernel sets up everything it uses */
+}
+
+/*
+ * Falcon mode escape hatch: start U-Boot instead of Linux when 'c' is
+ * waiting on the console or, if the board has one, the (active low)
+ * CONFIG_SPL_OS_BOOT_KEY GPIO is held.
+ */
+int spl_start_uboot(void)
+{
+	if (serial_tstc() && serial_getc() == 'c')
+		return 1;
+
+#ifdef CONFIG_SPL_OS_BOOT_KEY
+	if (!gpio_request(CONFIG_SPL_OS_BOOT_KEY, "U-Boot key")) {
+		int val;
+
+		gpio_direction_input(CONFIG_SPL_OS_BOOT_KEY);
+		val = gpio_get_value(CONFIG_SPL_OS_BOOT_KEY);
+		gpio_free(CONFIG_SPL_OS_BOOT_KEY);
+		if (!val)
+			return 1;
+	}
+#endif
+
+	return 0;
+}
+#endif
+
 /*
  * early system init of muxing and clocks.
  */
@@ -483,11 +515,11 @@ int board_mmc_init(bd_t *bis)
 {
 	int ret;
 	
-	ret = omap_mmc_init(0, 0, 0);
+	ret = omap_mmc_init(0, 0, 0, OMAP_HSMMC_DMA);
 	if (ret)
 		return ret;
 
-	return omap_mmc_init(1, 0, 0);
+	return omap_mmc_init(1, 0, 0, OMAP_HSMMC_DMA);
 }
 #endif
 
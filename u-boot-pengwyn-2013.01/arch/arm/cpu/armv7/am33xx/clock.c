@@ -177,6 +177,17 @@ static void enable_per_clocks(void)
 		;
 }
 
+/*
+ * The SHA/MD5 accelerator is only clocked when its driver first
+ * needs it, which is in U-Boot proper after SPL set up the rest.
+ */
+void enable_sham_clock(void)
+{
+	writel(PRCM_MOD_EN, &cmper->sha0clkctrl);
+	while (readl(&cmper->sha0clkctrl) != PRCM_MOD_EN)
+		;
+}
+
 void mpu_pll_config(int mpupll_M)
 {
 	u32 clkmode, clksel, div_m2;
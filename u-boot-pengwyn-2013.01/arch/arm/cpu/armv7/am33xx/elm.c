@@ -6,9 +6,10 @@
  *
  * NOTE:
  * 1. Supports only continuous mode. Dont see need for page mode in uboot
- * 2. Supports only syndrome polynomial 0. i.e. poly local variable is
- *    always set to ELM_DEFAULT_POLY. Dont see need for other polynomial
- *    sets in uboot
+ * 2. elm_check_error() uses syndrome polynomial 0 only. The NAND page
+ *    read path loads one ECC step into each of the ELM_MAX_POLY sets
+ *    with elm_start_syndrome() and lets the ELM decode them while the
+ *    next steps are read; elm_get_result() collects them afterwards.
  *
  * See file CREDITS for list of people who contributed to this
  * project.
@@ -115,22 +116,49 @@ int elm_check_error(u8 *syndrome, u32 nibbles, u32 *error_count,
 		u32 *error_locations)
 {
 	u8 poly = ELM_DEFAULT_POLY;
-	s8 i;
-	u32 location_status;
 
+	elm_start_syndrome(syndrome, nibbles, poly);
+
+	return elm_get_result(poly, error_count, error_locations);
+}
+
+/**
+ * elm_start_syndrome - Start decoding a BCH syndrome
+ * @syndrome: BCH syndrome
+ * @nibbles:
+ * @poly: Syndrome Polynomial set to use
+ *
+ * Load the syndrome into polynomial set @poly and start processing it
+ * without waiting for the result; see elm_get_result().
+ */
+void elm_start_syndrome(u8 *syndrome, u32 nibbles, u8 poly)
+{
 	elm_load_syndromes(syndrome, nibbles, poly);
 
 	/* start processing */
 	writel((readl(&elm_cfg->syndrome_fragments[poly].syndrome_fragment_x[6])
 				| ELM_SYNDROME_FRAGMENT_6_SYNDROME_VALID),
 		&elm_cfg->syndrome_fragments[poly].syndrome_fragment_x[6]);
+}
+
+/**
+ * elm_get_result - Wait for a syndrome started by elm_start_syndrome()
+ * @poly: Syndrome Polynomial set used
+ * @error_count: Returns number of errrors in the syndrome
+ * @error_locations: Returns error locations (in decimal) in this array
+ *
+ * Returns -1 if the errors are not correctable, else returns 0
+ */
+int elm_get_result(u8 poly, u32 *error_count, u32 *error_locations)
+{
+	s8 i;
+	u32 location_status;
 
 	/* wait for processing to complete */
-	while ((readl(&elm_cfg->irqstatus) & (0x1 << poly)) != 0x1)
+	while (!(readl(&elm_cfg->irqstatus) & (0x1 << poly)))
 		;
-	/* clear status */
-	writel((readl(&elm_cfg->irqstatus) | (0x1 << poly)),
-			&elm_cfg->irqstatus);
+	/* clear status; the register is write 1 to clear */
+	writel(0x1 << poly, &elm_cfg->irqstatus);
 
 	/* check if correctable */
 	location_status = readl(&elm_cfg->error_location[poly].location_status);
@@ -155,14 +183,12 @@ int elm_check_error(u8 *syndrome, u32 nibbles, u32 *error_count,
  * @level: 4 / 8 / 16 bit BCH
  *
  * Configure ELM module based on BCH level.
- * Set mode as continuous mode.
- * Currently we are using only syndrome 0 and syndromes 1 to 6 are not used.
- * Also, the mode is set only for syndrome 0
+ * Set mode as continuous mode for all syndrome polynomial sets.
  */
 int elm_config(enum bch_level level)
 {
 	u32 val;
-	u8 poly = ELM_DEFAULT_POLY;
+	u32 polys = (0x1 << ELM_MAX_POLY) - 1;
 	u32 buffer_size = 0x7FF;
 
 	/* config size and level */
@@ -172,12 +198,10 @@ int elm_config(enum bch_level level)
 	writel(val, &elm_cfg->location_config);
 
 	/* config continous mode */
-	/* enable interrupt generation for syndrome polynomial set */
-	writel((readl(&elm_cfg->irqenable) | (0x1 << poly)),
-			&elm_cfg->irqenable);
-	/* set continuous mode for the syndrome polynomial set */
-	writel((readl(&elm_cfg->page_ctrl) & ~(0x1 << poly)),
-			&elm_cfg->page_ctrl);
+	/* enable interrupt generation for the syndrome polynomial sets */
+	writel((readl(&elm_cfg->irqenable) | polys), &elm_cfg->irqenable);
+	/* set continuous mode for the syndrome polynomial sets */
+	writel((readl(&elm_cfg->page_ctrl) & ~polys), &elm_cfg->page_ctrl);
 
 	return 0;
 }
@@ -84,3 +84,34 @@ int cleanup_before_linux(void)
 
 	return 0;
 }
+
+#ifdef CONFIG_USE_ARCH_MEM_NEON
+/* Tested by memcpy()/memset() before they take the NEON path */
+int arm_neon_usable __attribute__((section(".data")));
+
+int arm_neon_init(void)
+{
+	u32 cpacr, mvfr1;
+
+	/* Ask for full access to cp10/cp11, with Advanced SIMD enabled */
+	asm volatile ("mrc p15, 0, %0, c1, c0, 2" : "=r" (cpacr));
+	cpacr |= 0xf << 20;
+	cpacr &= ~(3 << 30);
+	asm volatile ("mcr p15, 0, %0, c1, c0, 2" : : "r" (cpacr));
+	CP15ISB;
+
+	/* The access bits only stick when the VFP is there */
+	asm volatile ("mrc p15, 0, %0, c1, c0, 2" : "=r" (cpacr));
+	if ((cpacr & (0xf << 20)) != (0xf << 20) || (cpacr & (1 << 31)))
+		return 0;
+
+	/* FPEXC.EN, then check MVFR1 for SIMD load/store and integer ops */
+	asm volatile ("mcr p10, 7, %0, cr8, cr0, 0" : : "r" (1 << 30));
+	asm volatile ("mrc p10, 7, %0, cr6, cr0, 0" : "=r" (mvfr1));
+	if ((mvfr1 & 0xff00) != 0x1100)
+		return 0;
+
+	arm_neon_usable = 1;
+	return 0;
+}
+#endif
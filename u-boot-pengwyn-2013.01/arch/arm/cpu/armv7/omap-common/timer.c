@@ -34,6 +34,7 @@
 
 #include <common.h>
 #include <asm/io.h>
+#include <div64.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -118,3 +119,15 @@ ulong get_tbclk(void)
 {
 	return CONFIG_SYS_HZ;
 }
+
+#ifdef CONFIG_BOOTSTAGE
+/*
+ * The counter is started by SPL and never reset after that, so this gives
+ * SPL and U-Boot bootstage records a common time base.
+ */
+ulong timer_get_boot_us(void)
+{
+	return lldiv((unsigned long long)readl(&timer_base->tcrr) * 1000,
+		     TIMER_CLOCK / 1000);
+}
+#endif
@@ -91,7 +91,11 @@ struct gpmc {
 	u32 status;		/* 0x54 */
 	u8 res5[0x8];		/* 0x58 */
 	struct gpmc_cs cs[8];	/* 0x60, 0x90, .. */
-	u8 res6[0x14];		/* 0x1E0 */
+	u32 prefetch_config1;	/* 0x1E0 */
+	u32 prefetch_config2;	/* 0x1E4 */
+	u8 res6[0x4];		/* 0x1E8 */
+	u32 prefetch_control;	/* 0x1EC */
+	u32 prefetch_status;	/* 0x1F0 */
 	u32 ecc_config;		/* 0x1F4 */
 	u32 ecc_control;	/* 0x1F8 */
 	u32 ecc_size_config;	/* 0x1FC */
@@ -194,7 +198,9 @@ struct cm_perpll {
 	unsigned int timer2clkctrl;	/* offset 0x80 */
 	unsigned int timer3clkctrl;	/* offset 0x84 */
 	unsigned int timer4clkctrl;	/* offset 0x88 */
-	unsigned int resv4[8];
+	unsigned int resv4[5];
+	unsigned int sha0clkctrl;	/* offset 0xA0 */
+	unsigned int resv11[2];
 	unsigned int gpio1clkctrl;	/* offset 0xAC */
 	unsigned int gpio2clkctrl;	/* offset 0xB0 */
 	unsigned int gpio3clkctrl;	/* offset 0xB4 */
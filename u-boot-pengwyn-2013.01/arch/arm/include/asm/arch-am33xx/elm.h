@@ -40,6 +40,9 @@
 #define ELM_LOCATION_STATUS_ECC_CORRECTABLE_MASK	(0x100)
 #define ELM_LOCATION_STATUS_ECC_NB_ERRORS_MASK		(0x1F)
 
+/* Number of syndrome polynomials the ELM decodes in parallel */
+#define ELM_MAX_POLY					8
+
 #ifndef __ASSEMBLY__
 
 enum bch_level {
@@ -86,6 +89,8 @@ struct elm {
 
 int elm_check_error(u8 *syndrome, u32 nibbles, u32 *error_count,
 		u32 *error_locations);
+void elm_start_syndrome(u8 *syndrome, u32 nibbles, u8 poly);
+int elm_get_result(u8 poly, u32 *error_count, u32 *error_locations);
 int elm_config(enum bch_level level);
 void elm_reset(void);
 void elm_init(void);
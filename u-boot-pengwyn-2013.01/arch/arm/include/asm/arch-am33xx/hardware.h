@@ -91,7 +91,15 @@
 #define AM335X_USB0_OTG_BASE		0x47401000
 #define AM335X_USB1_OTG_BASE		0x47401800
 
+/* USB subsystem CPPI 4.1 DMA */
+#define AM335X_USB_CPPI41_DMA_BASE	0x47402000
+#define AM335X_USB_CPPI41_SCHED_BASE	0x47403000
+#define AM335X_USB_CPPI41_QMGR_BASE	0x47404000
+
 /* RTC base address */
 #define AM335X_RTC_BASE			0x44E3E000
 
+/* SHA/MD5 crypto accelerator */
+#define AM335X_SHA0_BASE		0x53100000
+
 #endif /* __AM33XX_HARDWARE_H */
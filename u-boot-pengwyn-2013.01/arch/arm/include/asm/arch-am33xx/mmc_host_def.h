@@ -44,6 +44,9 @@ typedef struct hsmmc {
 	unsigned int ie;		/* 0x134 */
 	unsigned char res4[0x8];
 	unsigned int capa;		/* 0x140 */
+	unsigned char res5[0x10];
+	unsigned int admaes;		/* 0x154 */
+	unsigned int admasal;		/* 0x158 */
 } hsmmc_t;
 
 /*
@@ -65,9 +68,12 @@ typedef struct hsmmc {
 #define WPP_ACTIVEHIGH			(0x0 << 8)
 #define RESERVED_MASK			(0x3 << 9)
 #define CTPL_MMC_SD			(0x0 << 11)
+#define DDR_ENABLE			(0x1 << 19)
+#define DMA_MNS_MASTER			(0x1 << 20)
 #define BLEN_512BYTESLEN		(0x200 << 0)
 #define NBLK_STPCNT			(0x0 << 16)
 #define DE_DISABLE			(0x0 << 0)
+#define DE_ENABLE			(0x1 << 0)
 #define BCE_DISABLE			(0x0 << 1)
 #define BCE_ENABLE			(0x1 << 1)
 #define ACEN_DISABLE			(0x0 << 2)
@@ -100,6 +106,7 @@ typedef struct hsmmc {
 #define DTW_1_BITMODE			(0x0 << 1)
 #define DTW_4_BITMODE			(0x1 << 1)
 #define DTW_8_BITMODE                   (0x1 << 5) /* CON[DW8]*/
+#define DMAS_ADMA2			(0x2 << 3)
 #define SDBP_PWROFF			(0x0 << 8)
 #define SDBP_PWRON			(0x1 << 8)
 #define SDVS_1V8			(0x5 << 9)
@@ -133,10 +140,12 @@ typedef struct hsmmc {
 #define IE_DTO				(0x01 << 20)
 #define IE_DCRC				(0x01 << 21)
 #define IE_DEB				(0x01 << 22)
+#define IE_ADMAE			(0x01 << 25)
 #define IE_CERR				(0x01 << 28)
 #define IE_BADA				(0x01 << 29)
 
 #define VS30_3V0SUP			(1 << 25)
+#define AD2S_ADMA2SUP			(1 << 19)
 #define VS18_1V8SUP			(1 << 26)
 
 /* Driver definitions */
@@ -158,6 +167,11 @@ typedef struct hsmmc {
 #define mmc_reg_out(addr, mask, val)\
 	writel((readl(addr) & (~(mask))) | ((val) & (mask)), (addr))
 
-int omap_mmc_init(int dev_index, uint host_caps_mask, uint f_max);
+/* Data transfer modes for omap_mmc_init() */
+#define OMAP_HSMMC_PIO		0
+#define OMAP_HSMMC_DMA		1	/* if the controller supports ADMA2 */
+
+int omap_mmc_init(int dev_index, uint host_caps_mask, uint f_max,
+		  int transfer_mode);
 
 #endif /* MMC_HOST_DEF_H */
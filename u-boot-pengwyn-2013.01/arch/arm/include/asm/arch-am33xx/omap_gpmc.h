@@ -33,6 +33,16 @@
 #define ECCSIZE0	(ECCSIZE512BYTE << 12)
 #define ECCSIZE0SEL	(0x000 << 0)
 
+/* Prefetch/write-posting engine */
+#define PREFETCH_CONFIG1_CS_SHIFT	24
+#define PREFETCH_ENABLE			(0x1 << 7)
+#define PREFETCH_FIFOTHRESHOLD(n)	((n) << 8)
+#define PREFETCH_FIFOTHRESHOLD_MAX	0x40
+#define PREFETCH_COUNT_MAX		0x2000
+#define PREFETCH_START			(0x1 << 0)
+#define PREFETCH_STATUS_COUNT(v)	((v) & 0x3fff)
+#define PREFETCH_STATUS_FIFO_CNT(v)	(((v) >> 24) & 0x7f)
+
 /* Generic ECC Layouts */
 /* Large Page x8 NAND device Layout */
 #ifdef GPMC_NAND_ECC_LP_x8_LAYOUT
@@ -57,6 +57,7 @@ void sdelay(unsigned long);
 void gpmc_init(void);
 void omap_nand_switch_ecc(int);
 void am33xx_spl_board_init(void);
+void enable_sham_clock(void);
 
 /*
  * We have three pin mux functions that must exist.  We must be able to enable
@@ -195,6 +195,11 @@ struct hsmmc {
 #define mmc_reg_out(addr, mask, val)\
 	writel((readl(addr) & (~(mask))) | ((val) & (mask)), (addr))
 
-int omap_mmc_init(int dev_index, uint host_caps_mask, uint f_max);
+/* Data transfer modes for omap_mmc_init() */
+#define OMAP_HSMMC_PIO		0
+#define OMAP_HSMMC_DMA		1	/* if the controller supports ADMA2 */
+
+int omap_mmc_init(int dev_index, uint host_caps_mask, uint f_max,
+		  int transfer_mode);
 
 #endif /* MMC_HOST_DEF_H */
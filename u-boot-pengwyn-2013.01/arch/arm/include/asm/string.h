@@ -14,7 +14,7 @@ extern char * strrchr(const char * s, int c);
 #undef __HAVE_ARCH_STRCHR
 extern char * strchr(const char * s, int c);
 
-#ifdef CONFIG_USE_ARCH_MEMCPY
+#if defined(CONFIG_USE_ARCH_MEMCPY) && !defined(CONFIG_SPL_BUILD)
 #define __HAVE_ARCH_MEMCPY
 #endif
 extern void * memcpy(void *, const void *, __kernel_size_t);
@@ -26,11 +26,16 @@ extern void * memmove(void *, const void *, __kernel_size_t);
 extern void * memchr(const void *, int, __kernel_size_t);
 
 #undef __HAVE_ARCH_MEMZERO
-#ifdef CONFIG_USE_ARCH_MEMSET
+#if defined(CONFIG_USE_ARCH_MEMSET) && !defined(CONFIG_SPL_BUILD)
 #define __HAVE_ARCH_MEMSET
 #endif
 extern void * memset(void *, int, __kernel_size_t);
 
+#ifdef CONFIG_USE_ARCH_MEM_NEON
+/* Enable Advanced SIMD if present and let memcpy/memset use it */
+extern int arm_neon_init(void);
+#endif
+
 #if 0
 extern void __memzero(void *ptr, __kernel_size_t n);
 
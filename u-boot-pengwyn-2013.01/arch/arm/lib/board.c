@@ -233,6 +233,9 @@ int arch_cpu_init(void)
 
 init_fnc_t *init_sequence[] = {
 	arch_cpu_init,		/* basic arch cpu dependent setup */
+#ifdef CONFIG_USE_ARCH_MEM_NEON
+	arm_neon_init,		/* NEON for memcpy/memset, if present */
+#endif
 
 #if defined(CONFIG_BOARD_EARLY_INIT_F)
 	board_early_init_f,
@@ -509,6 +512,12 @@ void board_init_r(gd_t *id, ulong dest_addr)
 	malloc_start = dest_addr - TOTAL_MALLOC_LEN;
 	mem_malloc_init (malloc_start, TOTAL_MALLOC_LEN);
 
+#ifdef CONFIG_BOOTSTAGE_STASH
+	/* pick up the records of the previous stage (SPL) */
+	bootstage_unstash((void *)CONFIG_BOOTSTAGE_STASH,
+			  CONFIG_BOOTSTAGE_STASH_SIZE);
+#endif
+
 #ifdef CONFIG_ARCH_EARLY_INIT_R
 	arch_early_init_r();
 #endif
@@ -92,10 +92,14 @@ static int fixup_memory_node(void *blob)
 }
 #endif
 
-static void announce_and_cleanup(void)
+static void announce_and_cleanup(bootm_headers_t *images)
 {
 	printf("\nStarting kernel ...\n\n");
 	bootstage_mark_name(BOOTSTAGE_ID_BOOTM_HANDOFF, "start_kernel");
+#if defined(CONFIG_BOOTSTAGE_FDT) && defined(CONFIG_OF_LIBFDT)
+	if (images->ft_len)
+		bootstage_fdt_add_report(images->ft_addr);
+#endif
 #ifdef CONFIG_BOOTSTAGE_REPORT
 	bootstage_report();
 #endif
@@ -334,7 +338,7 @@ static void boot_jump_linux(bootm_headers_t *images)
 	debug("## Transferring control to Linux (at address %08lx)" \
 		"...\n", (ulong) kernel_entry);
 	bootstage_mark(BOOTSTAGE_ID_RUN_OS);
-	announce_and_cleanup();
+	announce_and_cleanup(images);
 
 #ifdef CONFIG_OF_LIBFDT
 	if (images->ft_len)
@@ -27,6 +27,8 @@
 #include <config.h>
 #include <spl.h>
 #include <image.h>
+#include <fdt.h>
+#include <asm/setup.h>
 #include <linux/compiler.h>
 
 /* Pointer to as well as the global data structure for SPL */
@@ -69,4 +71,21 @@ void __noreturn jump_to_image_linux(void *arg)
 	cleanup_before_linux();
 	image_entry(0, CONFIG_MACH_TYPE, arg);
 }
+
+/*
+ * Check that a loaded parameter image is an FDT or an ATAG list, so that
+ * an erased or never written args area falls back to U-Boot rather than
+ * starting Linux with garbage.
+ */
+int spl_check_os_args(const void *arg)
+{
+	const struct tag *t = arg;
+
+	if (be32_to_cpu(*(const u32 *)arg) == FDT_MAGIC)
+		return 0;
+	if (t->hdr.tag == ATAG_CORE)
+		return 0;
+
+	return -1;
+}
 #endif
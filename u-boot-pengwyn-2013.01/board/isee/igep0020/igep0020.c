@@ -134,7 +134,7 @@ static void setup_net_chip(void)
 #if defined(CONFIG_GENERIC_MMC) && !defined(CONFIG_SPL_BUILD)
 int board_mmc_init(bd_t *bis)
 {
-	omap_mmc_init(0, 0, 0);
+	omap_mmc_init(0, 0, 0, 0);
 	return 0;
 }
 #endif
@@ -135,7 +135,7 @@ void set_muxconf_regs(void)
 #if defined(CONFIG_GENERIC_MMC) && !defined(CONFIG_SPL_BUILD)
 int board_mmc_init(bd_t *bis)
 {
-       omap_mmc_init(0, 0, 0);
+       omap_mmc_init(0, 0, 0, 0);
        return 0;
 }
 #endif
@@ -23,12 +23,12 @@
 
 /*
  * This module records the progress of boot and arbitrary commands, and
- * permits accurate timestamping of each.
- *
- * TBD: Pass timings to kernel in the FDT
+ * permits accurate timestamping of each. Records can be stashed in memory
+ * for the next boot stage to pick up, and passed to the kernel in the FDT.
  */
 
 #include <common.h>
+#include <malloc.h>
 #include <libfdt.h>
 
 DECLARE_GLOBAL_DATA_PTR;
@@ -36,6 +36,7 @@ DECLARE_GLOBAL_DATA_PTR;
 enum bootstage_flags {
 	BOOTSTAGEF_ERROR	= 1 << 0,	/* Error record */
 	BOOTSTAGEF_ALLOC	= 1 << 1,	/* Allocate an id */
+	BOOTSTAGEF_VALID	= 1 << 2,	/* Record in use (0 is a time) */
 };
 
 struct bootstage_record {
@@ -45,14 +46,35 @@ struct bootstage_record {
 	enum bootstage_id id;
 };
 
-static struct bootstage_record record[BOOTSTAGE_ID_COUNT] = { {1} };
+/*
+ * Stash layout: a header, hdr.count records, then the record names as
+ * consecutive NUL-terminated strings ("" for unnamed records).
+ */
+#define BOOTSTAGE_MAGIC		0xb00757a3
+#define BOOTSTAGE_VERSION	0
+
+struct bootstage_hdr {
+	uint32_t magic;		/* BOOTSTAGE_MAGIC */
+	uint32_t version;	/* BOOTSTAGE_VERSION */
+	uint32_t count;		/* Number of records */
+	uint32_t size;		/* Total size of the stash in bytes */
+};
+
+struct bootstage_stash_record {
+	uint32_t time_us;
+	uint32_t id;
+	uint32_t flags;
+};
+
+/* In .data, as records are made before relocation clears the BSS */
+static struct bootstage_record record[BOOTSTAGE_ID_COUNT]
+	__attribute__((section(".data")));
 static int next_id = BOOTSTAGE_ID_USER;
 
-ulong bootstage_add_record(enum bootstage_id id, const char *name,
-			   int flags)
+static enum bootstage_id bootstage_insert(enum bootstage_id id,
+		const char *name, int flags, ulong mark)
 {
 	struct bootstage_record *rec;
-	ulong mark = timer_get_boot_us();
 
 	if (flags & BOOTSTAGEF_ALLOC)
 		id = next_id++;
@@ -61,14 +83,24 @@ ulong bootstage_add_record(enum bootstage_id id, const char *name,
 		rec = &record[id];
 
 		/* Only record the first event for each */
-		if (!rec->time_us) {
+		if (!(rec->flags & BOOTSTAGEF_VALID)) {
 			rec->time_us = mark;
 			rec->name = name;
-			rec->flags = flags;
+			rec->flags = flags | BOOTSTAGEF_VALID;
 			rec->id = id;
 		}
 	}
 
+	return id;
+}
+
+ulong bootstage_add_record(enum bootstage_id id, const char *name,
+			   int flags)
+{
+	ulong mark = timer_get_boot_us();
+
+	id = bootstage_insert(id, name, flags, mark);
+
 	/* Tell the board about this progress */
 	show_boot_progress(flags & BOOTSTAGEF_ERROR ? -id : id);
 	return mark;
@@ -94,6 +126,144 @@ ulong bootstage_mark_name(enum bootstage_id id, const char *name)
 	return bootstage_add_record(id, name, flags);
 }
 
+int bootstage_stash(void *base, int size)
+{
+	struct bootstage_hdr *hdr = base;
+	struct bootstage_stash_record *srec;
+	struct bootstage_record *rec;
+	char *ptr, *end = (char *)base + size;
+	const char *name;
+	uint32_t count = 0;
+	int id, len;
+
+	for (id = 0, rec = record; id < BOOTSTAGE_ID_COUNT; id++, rec++)
+		if (rec->flags & BOOTSTAGEF_VALID)
+			count++;
+
+	srec = (struct bootstage_stash_record *)(hdr + 1);
+	ptr = (char *)(srec + count);
+	if (ptr > end)
+		goto overflow;
+
+	for (id = 0, rec = record; id < BOOTSTAGE_ID_COUNT; id++, rec++) {
+		if (!(rec->flags & BOOTSTAGEF_VALID))
+			continue;
+		name = rec->name ? rec->name : "";
+		len = strlen(name) + 1;
+		if (ptr + len > end)
+			goto overflow;
+		srec->time_us = rec->time_us;
+		srec->id = rec->id;
+		srec->flags = rec->flags;
+		srec++;
+		memcpy(ptr, name, len);
+		ptr += len;
+	}
+
+	hdr->magic = BOOTSTAGE_MAGIC;
+	hdr->version = BOOTSTAGE_VERSION;
+	hdr->count = count;
+	hdr->size = ptr - (char *)base;
+	debug("Stashed %u bootstage records (%u bytes) at %p\n", count,
+	      hdr->size, base);
+	return 0;
+
+overflow:
+	debug("%s: %d bytes are not enough for bootstage records\n",
+	      __func__, size);
+	return -1;
+}
+
+int bootstage_unstash(void *base, int size)
+{
+	struct bootstage_hdr *hdr = base;
+	const struct bootstage_stash_record *srec;
+	const char *name, *end;
+	uint32_t i;
+	int flags;
+
+	if (hdr->magic != BOOTSTAGE_MAGIC) {
+		debug("%s: no bootstage stash at %p\n", __func__, base);
+		return -1;
+	}
+	if (hdr->version != BOOTSTAGE_VERSION || hdr->size > size ||
+	    sizeof(*hdr) + hdr->count * sizeof(*srec) > hdr->size) {
+		debug("%s: invalid bootstage stash at %p\n", __func__, base);
+		return -1;
+	}
+
+	srec = (const struct bootstage_stash_record *)(hdr + 1);
+	name = (const char *)(srec + hdr->count);
+	end = (const char *)base + hdr->size;
+	for (i = 0; i < hdr->count && name < end; i++, srec++) {
+		/* user ids of the previous stage get new ones here */
+		flags = srec->flags;
+		if (srec->id >= BOOTSTAGE_ID_USER)
+			flags |= BOOTSTAGEF_ALLOC;
+		/* the stash may be overwritten later, keep our own names */
+		bootstage_insert(srec->id, *name ? strdup(name) : NULL,
+				 flags, srec->time_us);
+		name += strlen(name) + 1;
+	}
+	debug("Unstashed %u bootstage records from %p\n", i, base);
+
+	/* so that a later boot without a fresh stash does not merge it */
+	hdr->magic = 0;
+
+	return 0;
+}
+
+static const char *get_record_name(char *buf, enum bootstage_id id,
+				   const struct bootstage_record *rec)
+{
+	if (rec->name)
+		return rec->name;
+	if (id >= BOOTSTAGE_ID_USER)
+		sprintf(buf, "user_%d", id - BOOTSTAGE_ID_USER);
+	else
+		sprintf(buf, "id=%d", id);
+	return buf;
+}
+
+#ifdef CONFIG_BOOTSTAGE_FDT
+/*
+ * Add a /bootstage node with one subnode per record, named by its id and
+ * holding "name" and "mark" (time in microseconds) properties.
+ */
+int bootstage_fdt_add_report(void *blob)
+{
+	struct bootstage_record *rec;
+	int bootstage, node, id;
+	char buf[20], namebuf[20];
+
+	bootstage = fdt_subnode_offset(blob, 0, "bootstage");
+	if (bootstage >= 0)
+		fdt_del_node(blob, bootstage);
+	bootstage = fdt_add_subnode(blob, 0, "bootstage");
+	if (bootstage < 0)
+		goto err;
+
+	for (id = 0, rec = record; id < BOOTSTAGE_ID_COUNT; id++, rec++) {
+		if (!(rec->flags & BOOTSTAGEF_VALID))
+			continue;
+		sprintf(buf, "%d", rec->id);
+		node = fdt_add_subnode(blob, bootstage, buf);
+		if (node < 0 ||
+		    fdt_setprop_string(blob, node, "name",
+				get_record_name(namebuf, rec->id, rec)) ||
+		    fdt_setprop_cell(blob, node, "mark", rec->time_us))
+			goto err;
+	}
+
+	return 0;
+
+err:
+	puts("bootstage: Failed to add to device tree\n");
+	return -1;
+}
+#endif
+
+#ifndef CONFIG_SPL_BUILD
 static void print_time(unsigned long us_time)
 {
 	char str[15], *s;
@@ -112,14 +282,11 @@ static void print_time(unsigned long us_time)
 static uint32_t print_time_record(enum bootstage_id id,
 			struct bootstage_record *rec, uint32_t prev)
 {
+	char buf[20];
+
 	print_time(rec->time_us);
 	print_time(rec->time_us - prev);
-	if (rec->name)
-		printf("  %s\n", rec->name);
-	else if (id >= BOOTSTAGE_ID_USER)
-		printf("  user_%d\n", id - BOOTSTAGE_ID_USER);
-	else
-		printf("  id=%d\n", id);
+	printf("  %s\n", get_record_name(buf, id, rec));
 	return rec->time_us;
 }
 
@@ -142,13 +309,14 @@ void bootstage_report(void)
 	/* Fake the first record - we could get it from early boot */
 	rec->name = "reset";
 	rec->time_us = 0;
+	rec->flags = 0;
 	prev = print_time_record(BOOTSTAGE_ID_AWAKE, rec, 0);
 
 	/* Sort records by increasing time */
 	qsort(record, ARRAY_SIZE(record), sizeof(*rec), h_compare_record);
 
 	for (id = 0; id < BOOTSTAGE_ID_COUNT; id++, rec++) {
-		if (rec->time_us != 0)
+		if (rec->flags & BOOTSTAGEF_VALID)
 			prev = print_time_record(rec->id, rec, prev);
 	}
 	if (next_id > BOOTSTAGE_ID_COUNT)
@@ -156,6 +324,7 @@ void bootstage_report(void)
 			"- please increase CONFIG_BOOTSTAGE_USER_COUNT\n",
 		       next_id - BOOTSTAGE_ID_COUNT);
 }
+#endif
 
 ulong __timer_get_boot_us(void)
 {
@@ -0,0 +1,134 @@
+/*
+ * Block cache control
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+#include <common.h>
+#include <command.h>
+#include <part.h>
+
+static int blkc_stats(cmd_tbl_t *cmdtp, int flag, int argc,
+		      char * const argv[])
+{
+	struct block_cache_stats stats;
+	unsigned total;
+
+	blkcache_stats(&stats);
+	total = stats.hits + stats.misses;
+
+	printf("    hits: %u\n"
+	       "    misses: %u\n", stats.hits, stats.misses);
+	if (total)
+		printf("    hit rate: %u%%\n", stats.hits * 100 / total);
+	printf("    evictions: %u\n"
+	       "    deferred writes: %u\n"
+	       "    write backs: %u\n"
+	       "    entries: %u/%u\n"
+	       "    max blocks/entry: %u\n",
+	       stats.evictions, stats.deferred, stats.writebacks,
+	       stats.entries, stats.max_entries, stats.max_blocks_per_entry);
+
+	return 0;
+}
+
+static int blkc_configure(cmd_tbl_t *cmdtp, int flag, int argc,
+			  char * const argv[])
+{
+	unsigned blocks, entries;
+
+	if (argc != 3)
+		return CMD_RET_USAGE;
+
+	blocks = simple_strtoul(argv[1], NULL, 0);
+	entries = simple_strtoul(argv[2], NULL, 0);
+	blkcache_configure(blocks, entries);
+
+	printf("changed to max of %u entries of %u blocks each\n",
+	       entries, blocks);
+
+	return 0;
+}
+
+static int blkc_invalidate(cmd_tbl_t *cmdtp, int flag, int argc,
+			   char * const argv[])
+{
+	block_dev_desc_t *dev_desc;
+	int dev;
+
+	if (argc != 3)
+		return CMD_RET_USAGE;
+
+	dev = simple_strtoul(argv[2], NULL, 10);
+	dev_desc = get_dev(argv[1], dev);
+	if (!dev_desc) {
+		printf("** Bad device %s %d **\n", argv[1], dev);
+		return 1;
+	}
+
+	if (blkcache_flush(dev_desc))
+		return 1;
+	blkcache_invalidate(dev_desc->if_type, dev_desc->dev);
+
+	return 0;
+}
+
+static int blkc_flush(cmd_tbl_t *cmdtp, int flag, int argc,
+		      char * const argv[])
+{
+	return blkcache_flush(NULL) ? 1 : 0;
+}
+
+static cmd_tbl_t cmd_blkc_sub[] = {
+	U_BOOT_CMD_MKENT(stats, 1, 0, blkc_stats, "", ""),
+	U_BOOT_CMD_MKENT(configure, 3, 0, blkc_configure, "", ""),
+	U_BOOT_CMD_MKENT(invalidate, 3, 0, blkc_invalidate, "", ""),
+	U_BOOT_CMD_MKENT(flush, 1, 0, blkc_flush, "", ""),
+};
+
+static int do_blkcache(cmd_tbl_t *cmdtp, int flag, int argc,
+		       char * const argv[])
+{
+	cmd_tbl_t *c;
+
+	if (argc < 2)
+		return CMD_RET_USAGE;
+
+	/* Strip off leading argument */
+	argc--;
+	argv++;
+
+	c = find_cmd_tbl(argv[0], &cmd_blkc_sub[0], ARRAY_SIZE(cmd_blkc_sub));
+
+	if (!c)
+		return CMD_RET_USAGE;
+
+	return c->cmd(cmdtp, flag, argc, argv);
+}
+
+U_BOOT_CMD(
+	blkcache, 4, 0, do_blkcache,
+	"block cache diagnostics and control",
+	"stats - show cache hit/miss counters\n"
+	"blkcache configure blocks entries - set maximum blocks per entry\n"
+	"         and maximum number of entries (0 entries disables)\n"
+	"blkcache invalidate <interface> <dev> - write back and drop\n"
+	"         the cached blocks of one device\n"
+	"blkcache flush - write back all dirty blocks"
+);
@@ -314,6 +314,7 @@ static int bootm_start(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[]
 #define BOOTM_ERR_RESET		-1
 #define BOOTM_ERR_OVERLAP	-2
 #define BOOTM_ERR_UNIMPLEMENTED	-3
+#define BOOTM_ERR_BAD_IMAGE	-4	/* image corrupt, but left intact */
 static int bootm_load_os(image_info_t os, ulong *load_end, int boot_progress)
 {
 	uint8_t comp = os.comp;
@@ -345,6 +346,50 @@ static int bootm_load_os(image_info_t os, ulong *load_end, int boot_progress)
 		break;
 #ifdef CONFIG_GZIP
 	case IH_COMP_GZIP:
+#ifdef CONFIG_BOOTM_STREAM_VERIFY
+		if (images.verify_deferred) {
+			uint32_t dcrc;
+			/* gunzip may have written up to unc_len on failure */
+			int intact = load >= blob_end ||
+				     load + unc_len <= blob_start;
+
+			printf("   Uncompressing and verifying %s ... ",
+			       type_name);
+			if (gunzip_crc32((void *)load, unc_len,
+					 (uchar *)image_start, &image_len,
+					 &dcrc) != 0) {
+				if (intact) {
+					puts("GUNZIP: uncompress error\n");
+				} else {
+					puts("GUNZIP: uncompress, out-of-mem or "
+					     "overwrite error - must RESET "
+					     "board to recover\n");
+				}
+				if (boot_progress)
+					bootstage_error(
+						BOOTSTAGE_ID_DECOMP_IMAGE);
+				return intact ? BOOTM_ERR_BAD_IMAGE :
+						BOOTM_ERR_RESET;
+			}
+			if (dcrc != image_get_dcrc(&images.legacy_hdr_os_copy)) {
+				intact = load >= blob_end ||
+					 load + image_len <= blob_start;
+				if (intact)
+					puts("Bad Data CRC\n");
+				else
+					puts("Bad Data CRC - must RESET board "
+					     "to recover\n");
+				if (boot_progress)
+					bootstage_error(
+						BOOTSTAGE_ID_CHECK_CHECKSUM);
+				return intact ? BOOTM_ERR_BAD_IMAGE :
+						BOOTM_ERR_RESET;
+			}
+
+			*load_end = load + image_len;
+			break;
+		}
+#endif
 		printf("   Uncompressing %s ... ", type_name);
 		if (gunzip((void *)load, unc_len,
 				(uchar *)image_start, &image_len) != 0) {
@@ -422,7 +467,7 @@ static int bootm_load_os(image_info_t os, ulong *load_end, int boot_progress)
 		return BOOTM_ERR_UNIMPLEMENTED;
 	}
 
-	flush_cache(load, (*load_end - load) * sizeof(ulong));
+	flush_cache(load, *load_end - load);
 
 	puts("OK\n");
 	debug("   kernel loaded at 0x%08lx, end = 0x%08lx\n", load, *load_end);
@@ -673,6 +718,12 @@ int do_bootm(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 			bootstage_error(BOOTSTAGE_ID_DECOMP_UNIMPL);
 			return 1;
 		}
+		if (ret == BOOTM_ERR_BAD_IMAGE) {
+			/* the image is unchanged, let the caller fall back */
+			if (iflag)
+				enable_interrupts();
+			return 1;
+		}
 	}
 
 	lmb_reserve(&images.lmb, images.os.load, (load_end - images.os.load));
@@ -731,6 +782,25 @@ int bootm_maybe_autostart(cmd_tbl_t *cmdtp, const char *cmd)
 	return 0;
 }
 
+#ifdef CONFIG_BOOTM_STREAM_VERIFY
+/*
+ * The data CRC of a gzip compressed legacy kernel covers exactly the
+ * stream bootm_load_os() uncompresses, so it can be summed on the fly
+ * there instead of in a separate pass over the image beforehand.
+ */
+static int bootm_stream_verify(const image_header_t *hdr)
+{
+	return image_get_comp(hdr) == IH_COMP_GZIP &&
+	       (image_get_type(hdr) == IH_TYPE_KERNEL ||
+		image_get_type(hdr) == IH_TYPE_KERNEL_NOLOAD);
+}
+#else
+static inline int bootm_stream_verify(const image_header_t *hdr)
+{
+	return 0;
+}
+#endif
+
 /**
  * image_get_kernel - verify legacy format kernel image
  * @img_addr: in RAM address of the legacy format image to be verified
@@ -889,7 +959,10 @@ static void *boot_get_kernel(cmd_tbl_t *cmdtp, int flag, int argc,
 	case IMAGE_FORMAT_LEGACY:
 		printf("## Booting kernel from Legacy Image at %08lx ...\n",
 				img_addr);
-		hdr = image_get_kernel(img_addr, images->verify);
+		images->verify_deferred = images->verify &&
+			bootm_stream_verify((image_header_t *)img_addr);
+		hdr = image_get_kernel(img_addr,
+				images->verify && !images->verify_deferred);
 		if (!hdr)
 			return NULL;
 		bootstage_mark(BOOTSTAGE_ID_CHECK_IMAGETYPE);
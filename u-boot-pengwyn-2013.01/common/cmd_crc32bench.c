@@ -0,0 +1,81 @@
+/*
+ * CRC32 implementation benchmark
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+#include <common.h>
+#include <command.h>
+#include <div64.h>
+#include <watchdog.h>
+#include <u-boot/crc.h>
+
+static int do_crc32bench(cmd_tbl_t *cmdtp, int flag, int argc,
+			 char * const argv[])
+{
+	const struct crc32_impl *impl;
+	const uchar *buf;
+	ulong len, loops = 1, i, start, ms, rate;
+	uint32_t crc = 0, ref = 0;
+	int n;
+
+	if (argc < 3)
+		return CMD_RET_USAGE;
+
+	buf = (const uchar *)simple_strtoul(argv[1], NULL, 16);
+	len = simple_strtoul(argv[2], NULL, 16);
+	if (argc > 3)
+		loops = simple_strtoul(argv[3], NULL, 10);
+	if (!len || !loops)
+		return CMD_RET_USAGE;
+
+	for (n = 0; (impl = crc32_get_impl(n)) != NULL; n++) {
+		start = get_timer(0);
+		for (i = 0; i < loops; i++) {
+			crc = impl->no_comp(~0U, buf, len) ^ ~0U;
+			WATCHDOG_RESET();
+		}
+		ms = get_timer(start);
+
+		printf("%-12s crc %08x  ", impl->name, crc);
+		if (ms) {
+			/* bytes per millisecond is kB/s */
+			rate = lldiv((u64)len * loops, ms);
+			printf("%lu.%lu MB/s", rate / 1000, rate % 1000 / 100);
+		} else {
+			puts("too fast to time, raise loops");
+		}
+		if (n && crc != ref)
+			puts("  MISMATCH");
+		putc('\n');
+
+		if (!n)
+			ref = crc;
+	}
+
+	return 0;
+}
+
+U_BOOT_CMD(
+	crc32bench, 4, 0, do_crc32bench,
+	"time each CRC32 implementation",
+	"address count [loops]\n"
+	"    - checksum 'count' bytes at 'address' 'loops' times with\n"
+	"      every implementation and print the throughput"
+);
@@ -65,8 +65,10 @@ static int do_dfu(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 			goto exit;
 
 		usb_gadget_handle_interrupts();
+		dfu_write_poll();
 	}
 exit:
+	dfu_write_flush();
 	g_dnl_unregister();
 done:
 	dfu_free_entities();
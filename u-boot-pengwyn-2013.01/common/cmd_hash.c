@@ -0,0 +1,123 @@
+/*
+ * Hash command: digest memory and time the hash providers
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+#include <common.h>
+#include <command.h>
+#include <div64.h>
+#include <hash.h>
+#include <image.h>
+
+static void hash_print(const uint8_t *value, int len)
+{
+	int i;
+
+	for (i = 0; i < len; i++)
+		printf("%02x", value[i]);
+}
+
+static int hash_bench(const void *buf, ulong len, ulong loops)
+{
+	const struct hash_provider *hp, *ref = NULL;
+	uint8_t value[HASH_MAX_DIGEST_SIZE], first[HASH_MAX_DIGEST_SIZE];
+	ulong i, start, ms, rate;
+	int n, ret = 0;
+
+	for (n = 0; (hp = hash_get_provider(n)) != NULL; n++) {
+		start = get_timer(0);
+		for (i = 0; i < loops && !ret; i++)
+			ret = hp->digest(buf, len, value, CHUNKSZ);
+		ms = get_timer(start);
+
+		printf("%-7s %-10s ", hp->algo, hp->name);
+		if (ret) {
+			puts("failed\n");
+			ret = 0;
+			continue;
+		}
+		hash_print(value, hp->digest_size);
+		putc(' ');
+		if (ms) {
+			/* bytes per millisecond is kB/s */
+			rate = lldiv((u64)len * loops, ms);
+			printf(" %lu.%lu MB/s", rate / 1000, rate % 1000 / 100);
+		} else {
+			puts(" too fast to time, raise loops");
+		}
+
+		/* providers of one algorithm are listed together */
+		if (!ref || strcmp(ref->algo, hp->algo)) {
+			ref = hp;
+			memcpy(first, value, hp->digest_size);
+		} else if (memcmp(first, value, hp->digest_size)) {
+			puts("  MISMATCH");
+		}
+		putc('\n');
+
+		if (ctrlc())
+			return 1;
+	}
+
+	return 0;
+}
+
+static int do_hash(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
+{
+	uint8_t value[HASH_MAX_DIGEST_SIZE];
+	const void *buf;
+	ulong len, loops = 1;
+	int value_len;
+
+	if (argc < 4)
+		return CMD_RET_USAGE;
+
+	buf = (const void *)simple_strtoul(argv[2], NULL, 16);
+	len = simple_strtoul(argv[3], NULL, 16);
+
+	if (!strcmp(argv[1], "bench")) {
+		if (argc > 4)
+			loops = simple_strtoul(argv[4], NULL, 10);
+		if (!len || !loops)
+			return CMD_RET_USAGE;
+		return hash_bench(buf, len, loops);
+	}
+
+	if (argc > 4)
+		return CMD_RET_USAGE;
+	if (hash_digest(argv[1], buf, len, value, &value_len)) {
+		printf("Unknown hash algorithm '%s'\n", argv[1]);
+		return 1;
+	}
+	printf("%s for %08lx ... %08lx ==> ", argv[1], (ulong)buf,
+	       (ulong)buf + len - 1);
+	hash_print(value, value_len);
+	putc('\n');
+
+	return 0;
+}
+
+U_BOOT_CMD(
+	hash, 5, 1, do_hash,
+	"compute hashes, using hardware when available",
+	"algo address count\n"
+	"    - print the sha1, sha256 or md5 digest of 'count' bytes\n"
+	"hash bench address count [loops]\n"
+	"    - hash 'count' bytes 'loops' times with every provider of\n"
+	"      every algorithm and print the throughput"
+);
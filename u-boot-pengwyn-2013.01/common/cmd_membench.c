@@ -0,0 +1,120 @@
+/*
+ * memcpy/memmove/memset benchmark
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+#include <common.h>
+#include <command.h>
+#include <div64.h>
+#include <watchdog.h>
+
+enum { BENCH_MEMCPY, BENCH_MEMMOVE, BENCH_MEMSET };
+
+/* destination/source misalignment of each row */
+static const uchar bench_align[][2] = { { 0, 0 }, { 0, 1 }, { 1, 0 } };
+
+static void bench_one(int op, uchar *dst, uchar *src, ulong len, ulong loops)
+{
+	ulong i, start, ms, rate;
+
+	start = get_timer(0);
+	for (i = 0; i < loops; i++) {
+		switch (op) {
+		case BENCH_MEMCPY:
+			memcpy(dst, src, len);
+			break;
+		case BENCH_MEMMOVE:
+			/* overlapping move up by half the block */
+			memmove(src + len / 2, src, len);
+			break;
+		case BENCH_MEMSET:
+			memset(dst, i, len);
+			break;
+		}
+		WATCHDOG_RESET();
+	}
+	ms = get_timer(start);
+
+	if (ms) {
+		/* bytes per millisecond is kB/s */
+		rate = lldiv((u64)len * loops, ms);
+		printf("  %6lu.%lu", rate / 1000, rate % 1000 / 100);
+	} else {
+		printf("  %8s", "-");
+	}
+}
+
+static int do_membench(cmd_tbl_t *cmdtp, int flag, int argc,
+		       char * const argv[])
+{
+	uchar *src, *dst;
+	ulong count, loops = 1, len, n;
+	int a;
+
+	if (argc < 3)
+		return CMD_RET_USAGE;
+
+	src = (uchar *)simple_strtoul(argv[1], NULL, 16);
+	count = simple_strtoul(argv[2], NULL, 16);
+	if (argc > 3)
+		loops = simple_strtoul(argv[3], NULL, 10);
+	if (!count || !loops)
+		return CMD_RET_USAGE;
+	/* the memmove test needs one and a half blocks at the source */
+	dst = src + ALIGN(count + count / 2 + 1, 64);
+
+	printf("    size dst/src    memcpy   memmove    memset  (MB/s)\n");
+	len = min(count, 256UL);
+	for (;;) {
+		/* move the same amount of data at every size */
+		n = max(lldiv((u64)count * loops, len), 1ULL);
+
+		for (a = 0; a < ARRAY_SIZE(bench_align); a++) {
+			uchar *d = dst + bench_align[a][0];
+			uchar *s = src + bench_align[a][1];
+
+			printf("%8lx   +%d/+%d", len, bench_align[a][0],
+			       bench_align[a][1]);
+			bench_one(BENCH_MEMCPY, d, s, len, n);
+			bench_one(BENCH_MEMMOVE, d, s, len, n);
+			bench_one(BENCH_MEMSET, d, s, len, n);
+			putc('\n');
+
+			if (ctrlc())
+				return 1;
+		}
+
+		if (len == count)
+			break;
+		len = len > count >> 4 ? count : len << 4;
+	}
+
+	return 0;
+}
+
+U_BOOT_CMD(
+	membench, 4, 0, do_membench,
+	"time memcpy, memmove and memset",
+	"address count [loops]\n"
+	"    - copy, move and fill blocks of 256 bytes up to 'count' bytes\n"
+	"      at several alignments, moving 'count' * 'loops' bytes per\n"
+	"      test, and print the throughput. Uses 2.5 * 'count' bytes\n"
+	"      of scratch memory at 'address'"
+);
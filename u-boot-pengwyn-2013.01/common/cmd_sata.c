@@ -31,12 +31,21 @@
 int sata_curr_device = -1;
 block_dev_desc_t sata_dev_desc[CONFIG_SYS_SATA_MAX_DEVICE];
 
+/* Writes issued straight to the driver would leave stale cache entries */
+static ulong sata_bwrite(int dev, ulong start, lbaint_t blkcnt,
+			 const void *buffer)
+{
+	blk_media_written(IF_TYPE_SATA, dev, start, blkcnt);
+	return sata_write(dev, start, blkcnt, buffer);
+}
+
 int __sata_initialize(void)
 {
 	int rc;
 	int i;
 
 	for (i = 0; i < CONFIG_SYS_SATA_MAX_DEVICE; i++) {
+		blk_media_changed(IF_TYPE_SATA, i);
 		memset(&sata_dev_desc[i], 0, sizeof(struct block_dev_desc));
 		sata_dev_desc[i].if_type = IF_TYPE_SATA;
 		sata_dev_desc[i].dev = i;
@@ -45,7 +54,7 @@ int __sata_initialize(void)
 		sata_dev_desc[i].lba = 0;
 		sata_dev_desc[i].blksz = 512;
 		sata_dev_desc[i].block_read = sata_read;
-		sata_dev_desc[i].block_write = sata_write;
+		sata_dev_desc[i].block_write = sata_bwrite;
 
 		rc = init_sata(i);
 		if (!rc) {
@@ -24,9 +24,18 @@
 #include <common.h>
 #include <command.h>
 #include <cmd_spl.h>
+#include <mmc.h>
+#ifdef CONFIG_OF_LIBFDT
+#include <libfdt.h>
+#endif
+#include <asm/setup.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
+/* Parameter image of the last 'spl export', for 'spl save' */
+static void *spl_args;
+static ulong spl_args_size;
+
 static const char **subcmd_list[] = {
 
 	[SPL_EXPORT_FDT] = (const char * []) {
@@ -133,12 +142,25 @@ static int spl_export(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 		case SPL_EXPORT_FDT:
 			printf("Argument image is now in RAM: 0x%p\n",
 				(void *)images.ft_addr);
+#ifdef CONFIG_OF_LIBFDT
+			spl_args = images.ft_addr;
+			spl_args_size = fdt_totalsize(images.ft_addr);
+#endif
 			break;
-		case SPL_EXPORT_ATAGS:
+		case SPL_EXPORT_ATAGS: {
+			struct tag *t = (struct tag *)gd->bd->bi_boot_params;
+
 			printf("Argument image is now in RAM at: 0x%p\n",
 				(void *)gd->bd->bi_boot_params);
+			spl_args = t;
+			while (t->hdr.size)
+				t = tag_next(t);
+			/* include the ATAG_NONE terminator */
+			spl_args_size = (ulong)t + sizeof(struct tag_header) -
+					(ulong)spl_args;
 			break;
 		}
+		}
 	} else {
 		/* Unrecognized command */
 		return cmd_usage(cmdtp);
@@ -147,8 +169,57 @@ static int spl_export(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 	return 0;
 }
 
+#if defined(CONFIG_CMD_MMC) && defined(CONFIG_SYS_MMCSD_RAW_MODE_ARGS_SECTOR)
+/* Write the exported parameter image to the falcon mode MMC args area */
+static int spl_save_mmc(int dev)
+{
+	struct mmc *mmc = find_mmc_device(dev);
+	u32 cnt, n;
+
+	if (!mmc || mmc_init(mmc)) {
+		printf("no mmc device at slot %x\n", dev);
+		return -1;
+	}
+
+	cnt = DIV_ROUND_UP(spl_args_size, mmc->write_bl_len);
+	if (cnt > CONFIG_SYS_MMCSD_RAW_MODE_ARGS_SECTORS) {
+		printf("Argument image too large (%lu bytes)\n", spl_args_size);
+		return -1;
+	}
+
+	n = mmc->block_dev.block_write(dev,
+			CONFIG_SYS_MMCSD_RAW_MODE_ARGS_SECTOR, cnt, spl_args);
+	if (n != cnt)
+		return -1;
+
+	printf("Argument image saved to mmc %d, block 0x%x\n", dev,
+		CONFIG_SYS_MMCSD_RAW_MODE_ARGS_SECTOR);
+	return 0;
+}
+#endif
+
+static int spl_save(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
+{
+	if (argc < 2)
+		return cmd_usage(cmdtp);
+
+	if (!spl_args) {
+		printf("Run 'spl export' first\n");
+		return -1;
+	}
+
+#if defined(CONFIG_CMD_MMC) && defined(CONFIG_SYS_MMCSD_RAW_MODE_ARGS_SECTOR)
+	if (!strcmp(argv[1], "mmc"))
+		return spl_save_mmc(argc > 2 ?
+				    simple_strtoul(argv[2], NULL, 10) : 0);
+#endif
+
+	return cmd_usage(cmdtp);
+}
+
 static cmd_tbl_t cmd_spl_sub[] = {
 	U_BOOT_CMD_MKENT(export, 0, 1, (void *)SPL_EXPORT, "", ""),
+	U_BOOT_CMD_MKENT(save, 0, 1, (void *)SPL_SAVE, "", ""),
 };
 
 static int do_spl(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
@@ -169,6 +240,12 @@ static int do_spl(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 			if (spl_export(cmdtp, flag, argc, argv))
 				printf("Subcommand failed\n");
 			break;
+		case SPL_SAVE:
+			argc--;
+			argv++;
+			if (spl_save(cmdtp, flag, argc, argv))
+				printf("Subcommand failed\n");
+			break;
 		default:
 			/* unrecognized command */
 			return cmd_usage(cmdtp);
@@ -185,4 +262,6 @@ U_BOOT_CMD(
 	"export <img=atags|fdt> [kernel_addr] [initrd_addr] "
 	"[fdt_addr if <img> = fdt] - export a kernel parameter image\n"
 	"\t initrd_img can be set to \"-\" if fdt_addr without initrd img is"
-	"used");
+	"used\n"
+	"spl save mmc [dev] - write the exported image to the falcon mode\n"
+	"\t args area of mmc device dev");
@@ -108,6 +108,16 @@ static void display_ubi_info(struct ubi_device *ubi)
 	ubi_msg("number of PEBs reserved for bad PEB handling: %d",
 			ubi->beb_rsvd_pebs);
 	ubi_msg("max/mean erase counter: %d/%d", ubi->max_ec, ubi->mean_ec);
+#ifdef CONFIG_MTD_UBI_FASTMAP
+	if (ubi->fm_attached)
+		ubi_msg("attached from fastmap:      yes");
+#endif
+	ubi_msg("PEB headers read at once:   %d (%d one by one)",
+			ubi->scan_fast_pebs, ubi->scan_slow_pebs);
+	ubi_msg("attach time:                %lu ms", ubi->scan_ms +
+			ubi->vtbl_ms + ubi->eba_ms + ubi->wl_ms);
+	ubi_msg("  scan/vtbl/EBA/WL:         %lu/%lu/%lu/%lu ms",
+			ubi->scan_ms, ubi->vtbl_ms, ubi->eba_ms, ubi->wl_ms);
 }
 
 static int ubi_info(int layout)
@@ -0,0 +1,100 @@
+/*
+ * Hash provider selection
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+#include <common.h>
+#include <hash.h>
+#include <image.h>
+#include <sha1.h>
+#include <sha256.h>
+#include <u-boot/md5.h>
+
+#ifdef CONFIG_SHA1
+static int sha1_generic(const void *data, uint len, uint8_t *output,
+			uint chunk_sz)
+{
+	sha1_csum_wd((unsigned char *)data, len, output, chunk_sz);
+	return 0;
+}
+#endif
+
+#ifdef CONFIG_SHA256
+static int sha256_generic(const void *data, uint len, uint8_t *output,
+			  uint chunk_sz)
+{
+	sha256_csum_wd((unsigned char *)data, len, output, chunk_sz);
+	return 0;
+}
+#endif
+
+#ifdef CONFIG_MD5
+static int md5_generic(const void *data, uint len, uint8_t *output,
+		       uint chunk_sz)
+{
+	md5_wd((unsigned char *)data, len, output, chunk_sz);
+	return 0;
+}
+#endif
+
+/* Fastest first; hash_digest() uses the first one that works */
+static const struct hash_provider hash_providers[] = {
+#ifdef CONFIG_OMAP_SHAM
+	{ "sha1",	"omap-sham",	20, omap_sham_sha1 },
+	{ "sha256",	"omap-sham",	32, omap_sham_sha256 },
+	{ "md5",	"omap-sham",	16, omap_sham_md5 },
+#endif
+#ifdef CONFIG_SHA1
+	{ "sha1",	"generic",	20, sha1_generic },
+#endif
+#ifdef CONFIG_SHA256
+	{ "sha256",	"generic",	32, sha256_generic },
+#endif
+#ifdef CONFIG_MD5
+	{ "md5",	"generic",	16, md5_generic },
+#endif
+};
+
+const struct hash_provider *hash_get_provider(int n)
+{
+	if (n < 0 || n >= ARRAY_SIZE(hash_providers))
+		return NULL;
+	return &hash_providers[n];
+}
+
+int hash_digest(const char *algo, const void *data, uint len,
+		uint8_t *output, int *output_len)
+{
+	const struct hash_provider *hp;
+	int n;
+
+	for (n = 0; (hp = hash_get_provider(n)) != NULL; n++) {
+		if (strcmp(hp->algo, algo))
+			continue;
+		if (hp->digest(data, len, output, CHUNKSZ) == 0) {
+			*output_len = hp->digest_size;
+			return 0;
+		}
+		debug("%s: %s failed, trying the next one\n", algo, hp->name);
+	}
+
+	debug("Unsupported hash algorithm %s\n", algo);
+	return -1;
+}
@@ -54,6 +54,7 @@
 #if defined(CONFIG_FIT)
 #include <u-boot/md5.h>
 #include <sha1.h>
+#include <hash.h>
 
 static int fit_check_ramdisk(const void *fit, int os_noffset,
 		uint8_t arch, int verify);
@@ -70,6 +71,7 @@ static const image_header_t *image_get_ramdisk(ulong rd_addr, uint8_t arch,
 #else
 #include "mkimage.h"
 #include <u-boot/md5.h>
+#include <sha256.h>
 #include <time.h>
 #include <image.h>
 #endif /* !USE_HOSTCC*/
@@ -2547,6 +2549,12 @@ int fit_set_timestamp(void *fit, int noffset, time_t timestamp)
 static int calculate_hash(const void *data, int data_len, const char *algo,
 			uint8_t *value, int *value_len)
 {
+#ifndef USE_HOSTCC
+	/* let the fastest provider (maybe an accelerator) do it */
+	if (strcmp(algo, "crc32") != 0)
+		return hash_digest(algo, data, data_len, value, value_len);
+#endif
+
 	if (strcmp(algo, "crc32") == 0) {
 		*((uint32_t *)value) = crc32_wd(0, data, data_len,
 							CHUNKSZ_CRC32);
@@ -2559,6 +2567,12 @@ static int calculate_hash(const void *data, int data_len, const char *algo,
 	} else if (strcmp(algo, "md5") == 0) {
 		md5_wd((unsigned char *)data, data_len, value, CHUNKSZ_MD5);
 		*value_len = 16;
+#ifdef USE_HOSTCC
+	} else if (strcmp(algo, "sha256") == 0) {
+		sha256_csum_wd((unsigned char *)data, data_len,
+				(unsigned char *)value, CHUNKSZ_SHA256);
+		*value_len = SHA256_SUM_LEN;
+#endif
 	} else {
 		debug("Unsupported hash alogrithm\n");
 		return -1;
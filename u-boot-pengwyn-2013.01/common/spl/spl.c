@@ -156,6 +156,7 @@ void board_init_r(gd_t *dummy1, ulong dummy2)
 #endif
 
 	timer_init();
+	bootstage_mark_name(BOOTSTAGE_ID_START_SPL, "spl");
 
 #ifdef CONFIG_SPL_BOARD_INIT
 	spl_board_init();
@@ -222,6 +223,12 @@ void board_init_r(gd_t *dummy1, ulong dummy2)
 		hang();
 	}
 
+	bootstage_mark_name(BOOTSTAGE_ID_END_SPL, "end_spl");
+#ifdef CONFIG_BOOTSTAGE_STASH
+	bootstage_stash((void *)CONFIG_BOOTSTAGE_STASH,
+			CONFIG_BOOTSTAGE_STASH_SIZE);
+#endif
+
 	switch (spl_image.os) {
 	case IH_OS_U_BOOT:
 		debug("Jumping to U-Boot\n");
@@ -57,6 +57,10 @@ void spl_nand_load_image(void)
 				src++, dst++) {
 			writel(readl(src), dst);
 		}
+		if (spl_check_os_args((void *)CONFIG_SYS_SPL_ARGS_ADDR)) {
+			puts("No kernel parameters found in NAND\n");
+			goto load_uboot;
+		}
 
 		/* load linux */
 		nand_spl_load_image(CONFIG_SYS_NAND_SPL_KERNEL_OFFS,
@@ -75,6 +79,7 @@ void spl_nand_load_image(void)
 			puts("Trying to start u-boot now...\n");
 		}
 	}
+load_uboot:
 #endif
 #ifdef CONFIG_NAND_ENV_DST
 	nand_spl_load_image(CONFIG_ENV_OFFSET,
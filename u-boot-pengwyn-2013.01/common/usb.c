@@ -236,6 +236,16 @@ int usb_bulk_msg(struct usb_device *dev, unsigned int pipe,
 }
 
 
+/*
+ * Largest bulk transfer, in bytes, the host controller driver accepts in
+ * one submit_bulk_msg() call.  Drivers that handle more than the storage
+ * layer's conservative default override this.
+ */
+int __weak usb_get_max_xfer_size(struct usb_device *dev, size_t *size)
+{
+	return -1;
+}
+
 /*-------------------------------------------------------------------
  * Max Packet stuff
  */
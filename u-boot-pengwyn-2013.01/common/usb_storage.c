@@ -154,18 +154,17 @@ struct us_data {
 	ccb		*srb;			/* current srb */
 	trans_reset	transport_reset;	/* reset routine */
 	trans_cmnd	transport;		/* transport routine */
+	unsigned short	max_xfer_blk;		/* blocks per READ/WRITE */
 };
 
-#ifdef CONFIG_USB_EHCI
 /*
- * The U-Boot EHCI driver can handle any transfer length as long as there is
- * enough free heap space left, but the SCSI READ(10) and WRITE(10) commands are
- * limited to 65535 blocks.
+ * The SCSI READ(10)/WRITE(10) commands are limited to 65535 blocks.  Within
+ * that, a command moves as many blocks as the host controller driver accepts
+ * in one bulk transfer (see usb_get_max_xfer_size()); drivers that do not say
+ * get the historical 20 blocks.
  */
 #define USB_MAX_XFER_BLK	65535
-#else
-#define USB_MAX_XFER_BLK	20
-#endif
+#define USB_DEFAULT_XFER_BLK	20
 
 static struct us_data usb_stor[USB_MAX_STOR_DEV];
 
@@ -179,9 +178,9 @@ int usb_stor_get_info(struct usb_device *dev, struct us_data *us,
 int usb_storage_probe(struct usb_device *dev, unsigned int ifnum,
 		      struct us_data *ss);
 unsigned long usb_stor_read(int device, unsigned long blknr,
-			    unsigned long blkcnt, void *buffer);
+			    lbaint_t blkcnt, void *buffer);
 unsigned long usb_stor_write(int device, unsigned long blknr,
-			     unsigned long blkcnt, const void *buffer);
+			     lbaint_t blkcnt, const void *buffer);
 struct usb_device * usb_get_dev_index(int index);
 void uhci_show_temp_int_td(void);
 
@@ -249,6 +248,7 @@ int usb_stor_scan(int mode)
 	usb_disable_asynch(1); /* asynch transfer not allowed */
 
 	for (i = 0; i < USB_MAX_STOR_DEV; i++) {
+		blk_media_changed(IF_TYPE_USB, i);
 		memset(&usb_dev_desc[i], 0, sizeof(block_dev_desc_t));
 		usb_dev_desc[i].if_type = IF_TYPE_USB;
 		usb_dev_desc[i].dev = i;
@@ -994,6 +994,78 @@ static int usb_read_capacity(ccb *srb, struct us_data *ss)
 	return -1;
 }
 
+/*
+ * READ CAPACITY(16), for devices whose last LBA does not fit the 32 bits
+ * of READ CAPACITY(10).  Returns the number of blocks and the block size.
+ */
+static int usb_read_capacity_16(ccb *srb, struct us_data *ss,
+				u64 *capacity, unsigned long *blksz)
+{
+	ALLOC_CACHE_ALIGN_BUFFER(unsigned char, buf, 32);
+	unsigned char *pdata = srb->pdata;
+	int retry = 3, i;
+
+	srb->pdata = buf;
+	do {
+		memset(&srb->cmd[0], 0, 16);
+		srb->cmd[0] = SCSI_SRV_ACTION_IN;
+		srb->cmd[1] = SCSI_SAI_RD_CAPAC16;
+		srb->cmd[13] = 32;
+		srb->datalen = 32;
+		srb->cmdlen = 16;
+		if (ss->transport(srb, ss) == USB_STOR_TRANSPORT_GOOD)
+			break;
+	} while (retry--);
+	srb->pdata = pdata;
+
+	if (retry < 0)
+		return -1;
+
+	*capacity = 0;
+	for (i = 0; i < 8; i++)
+		*capacity = (*capacity << 8) | buf[i];
+	*capacity += 1;
+	*blksz = (buf[8] << 24) | (buf[9] << 16) | (buf[10] << 8) | buf[11];
+	return 0;
+}
+
+/* READ(10) and WRITE(10) only reach the first 2^32 blocks */
+static inline int usb_need_cdb16(unsigned long start, unsigned short blocks)
+{
+	return (u64)start + blocks > 0x100000000ULL;
+}
+
+static void usb_setup_cdb16(ccb *srb, unsigned char opcode,
+			    unsigned long start, unsigned short blocks)
+{
+	u64 lba = start;
+	int i;
+
+	memset(&srb->cmd[0], 0, 16);
+	srb->cmd[0] = opcode;
+	for (i = 0; i < 8; i++)
+		srb->cmd[2 + i] = (unsigned char)(lba >> (56 - 8 * i));
+	srb->cmd[12] = ((unsigned char) (blocks >> 8)) & 0xff;
+	srb->cmd[13] = (unsigned char) blocks & 0xff;
+	srb->cmdlen = 16;
+}
+
+static int usb_read_16(ccb *srb, struct us_data *ss, unsigned long start,
+		       unsigned short blocks)
+{
+	usb_setup_cdb16(srb, SCSI_READ16, start, blocks);
+	USB_STOR_PRINTF("read16: start %lx blocks %x\n", start, blocks);
+	return ss->transport(srb, ss);
+}
+
+static int usb_write_16(ccb *srb, struct us_data *ss, unsigned long start,
+			unsigned short blocks)
+{
+	usb_setup_cdb16(srb, SCSI_WRITE16, start, blocks);
+	USB_STOR_PRINTF("write16: start %lx blocks %x\n", start, blocks);
+	return ss->transport(srb, ss);
+}
+
 static int usb_read_10(ccb *srb, struct us_data *ss, unsigned long start,
 		       unsigned short blocks)
 {
@@ -1011,6 +1083,14 @@ static int usb_read_10(ccb *srb, struct us_data *ss, unsigned long start,
 	return ss->transport(srb, ss);
 }
 
+static int usb_read_blocks(ccb *srb, struct us_data *ss, unsigned long start,
+			   unsigned short blocks)
+{
+	if (usb_need_cdb16(start, blocks))
+		return usb_read_16(srb, ss, start, blocks);
+	return usb_read_10(srb, ss, start, blocks);
+}
+
 static int usb_write_10(ccb *srb, struct us_data *ss, unsigned long start,
 			unsigned short blocks)
 {
@@ -1028,6 +1108,34 @@ static int usb_write_10(ccb *srb, struct us_data *ss, unsigned long start,
 	return ss->transport(srb, ss);
 }
 
+static int usb_write_blocks(ccb *srb, struct us_data *ss, unsigned long start,
+			    unsigned short blocks)
+{
+	if (usb_need_cdb16(start, blocks))
+		return usb_write_16(srb, ss, start, blocks);
+	return usb_write_10(srb, ss, start, blocks);
+}
+
+/*
+ * Size the READ/WRITE commands to the largest bulk transfer the host
+ * controller driver takes in one go: one CBW/data/CSW round trip per
+ * 20 blocks is what made large loads over MUSB so slow.
+ */
+static void usb_stor_set_max_xfer_blk(struct us_data *ss, unsigned long blksz)
+{
+	unsigned long blks = USB_DEFAULT_XFER_BLK;
+	size_t size;
+
+	if (blksz && usb_get_max_xfer_size(ss->pusb_dev, &size) == 0)
+		blks = size / blksz;
+	if (blks > USB_MAX_XFER_BLK)
+		blks = USB_MAX_XFER_BLK;
+	if (blks == 0)
+		blks = 1;
+	ss->max_xfer_blk = blks;
+	USB_STOR_PRINTF("max transfer %lu blocks\n", blks);
+}
+
 
 #ifdef CONFIG_USB_BIN_FIXUP
 /*
@@ -1053,7 +1161,7 @@ static void usb_bin_fixup(struct usb_device_descriptor descriptor,
 #endif /* CONFIG_USB_BIN_FIXUP */
 
 unsigned long usb_stor_read(int device, unsigned long blknr,
-			    unsigned long blkcnt, void *buffer)
+			    lbaint_t blkcnt, void *buffer)
 {
 	unsigned long start, blks, buf_addr;
 	unsigned short smallblks;
@@ -1091,16 +1199,16 @@ unsigned long usb_stor_read(int device, unsigned long blknr,
 		/* XXX need some comment here */
 		retry = 2;
 		srb->pdata = (unsigned char *)buf_addr;
-		if (blks > USB_MAX_XFER_BLK)
-			smallblks = USB_MAX_XFER_BLK;
+		if (blks > ss->max_xfer_blk)
+			smallblks = ss->max_xfer_blk;
 		else
 			smallblks = (unsigned short) blks;
 retry_it:
-		if (smallblks == USB_MAX_XFER_BLK)
+		if (smallblks == ss->max_xfer_blk)
 			usb_show_progress();
 		srb->datalen = usb_dev_desc[device].blksz * smallblks;
 		srb->pdata = (unsigned char *)buf_addr;
-		if (usb_read_10(srb, ss, start, smallblks)) {
+		if (usb_read_blocks(srb, ss, start, smallblks)) {
 			USB_STOR_PRINTF("Read ERROR\n");
 			usb_request_sense(srb, ss);
 			if (retry--)
@@ -1118,13 +1226,13 @@ retry_it:
 			start, smallblks, buf_addr);
 
 	usb_disable_asynch(0); /* asynch transfer allowed */
-	if (blkcnt >= USB_MAX_XFER_BLK)
+	if (blkcnt >= ss->max_xfer_blk)
 		debug("\n");
 	return blkcnt;
 }
 
 unsigned long usb_stor_write(int device, unsigned long blknr,
-				unsigned long blkcnt, const void *buffer)
+				lbaint_t blkcnt, const void *buffer)
 {
 	unsigned long start, blks, buf_addr;
 	unsigned short smallblks;
@@ -1149,6 +1257,8 @@ unsigned long usb_stor_write(int device, unsigned long blknr,
 	}
 	ss = (struct us_data *)dev->privptr;
 
+	blk_media_written(IF_TYPE_USB, device, blknr, blkcnt);
+
 	usb_disable_asynch(1); /* asynch transfer not allowed */
 
 	srb->lun = usb_dev_desc[device].lun;
@@ -1165,16 +1275,16 @@ unsigned long usb_stor_write(int device, unsigned long blknr,
 		 */
 		retry = 2;
 		srb->pdata = (unsigned char *)buf_addr;
-		if (blks > USB_MAX_XFER_BLK)
-			smallblks = USB_MAX_XFER_BLK;
+		if (blks > ss->max_xfer_blk)
+			smallblks = ss->max_xfer_blk;
 		else
 			smallblks = (unsigned short) blks;
 retry_it:
-		if (smallblks == USB_MAX_XFER_BLK)
+		if (smallblks == ss->max_xfer_blk)
 			usb_show_progress();
 		srb->datalen = usb_dev_desc[device].blksz * smallblks;
 		srb->pdata = (unsigned char *)buf_addr;
-		if (usb_write_10(srb, ss, start, smallblks)) {
+		if (usb_write_blocks(srb, ss, start, smallblks)) {
 			USB_STOR_PRINTF("Write ERROR\n");
 			usb_request_sense(srb, ss);
 			if (retry--)
@@ -1192,7 +1302,7 @@ retry_it:
 			start, smallblks, buf_addr);
 
 	usb_disable_asynch(0); /* asynch transfer allowed */
-	if (blkcnt >= USB_MAX_XFER_BLK)
+	if (blkcnt >= ss->max_xfer_blk)
 		debug("\n");
 	return blkcnt;
 
@@ -1240,6 +1350,7 @@ int usb_storage_probe(struct usb_device *dev, unsigned int ifnum,
 
 	/* Initialize the us_data structure with some useful info */
 	ss->flags = flags;
+	ss->max_xfer_blk = USB_DEFAULT_XFER_BLK;
 	ss->ifnum = ifnum;
 	ss->pusb_dev = dev;
 	ss->attention_done = 0;
@@ -1346,6 +1457,8 @@ int usb_stor_get_info(struct usb_device *dev, struct us_data *ss,
 	ALLOC_CACHE_ALIGN_BUFFER(unsigned long, cap, 2);
 	ALLOC_CACHE_ALIGN_BUFFER(unsigned char, usb_stor_buf, 36);
 	unsigned long *capacity, *blksz;
+	u64 capacity16;
+	unsigned long blksz16;
 	ccb *pccb = &usb_ccb;
 
 	pccb->pdata = usb_stor_buf;
@@ -1398,7 +1511,6 @@ int usb_stor_get_info(struct usb_device *dev, struct us_data *ss,
 		cap[0] = 2880;
 		cap[1] = 0x200;
 	}
-	ss->flags &= ~USB_READY;
 	USB_STOR_PRINTF("Read Capacity returns: 0x%lx, 0x%lx\n", cap[0],
 			cap[1]);
 #if 0
@@ -1409,13 +1521,30 @@ int usb_stor_get_info(struct usb_device *dev, struct us_data *ss,
 	cap[1] = cpu_to_be32(cap[1]);
 
 	/* this assumes bigendian! */
-	cap[0] += 1;
+	capacity16 = (u64)cap[0] + 1;
+	blksz16 = cap[1];
+	if (cap[0] == 0xffffffff &&
+	    usb_read_capacity_16(pccb, ss, &capacity16, &blksz16) != 0) {
+		printf("READ_CAP16 ERROR\n");
+		capacity16 = 0x100000000ULL;
+	}
+	ss->flags &= ~USB_READY;
+
+	/* block_read()/block_write() take an unsigned long start block */
+	if (capacity16 > (unsigned long)~0UL) {
+		printf("Warning: only the first %lu of %llu blocks are "
+		       "accessible\n", ~0UL, capacity16);
+		capacity16 = ~0UL;
+	}
+	cap[0] = capacity16;
+	cap[1] = blksz16;
 	capacity = &cap[0];
 	blksz = &cap[1];
 	USB_STOR_PRINTF("Capacity = 0x%lx, blocksz = 0x%lx\n",
 			*capacity, *blksz);
 	dev_desc->lba = *capacity;
 	dev_desc->blksz = *blksz;
+	usb_stor_set_max_xfer_blk(ss, *blksz);
 	dev_desc->type = perq;
 	USB_STOR_PRINTF(" address %d\n", dev_desc->target);
 	USB_STOR_PRINTF("partype: %d\n", dev_desc->part_type);
@@ -35,6 +35,9 @@
 #define PRINTF(fmt,args...)
 #endif
 
+/* See blk_media_changed() */
+unsigned long blk_media_gen;
+
 #if (defined(CONFIG_CMD_IDE) || \
      defined(CONFIG_CMD_SATA) || \
      defined(CONFIG_CMD_SCSI) || \
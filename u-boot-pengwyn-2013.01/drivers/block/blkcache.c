@@ -0,0 +1,397 @@
+/*
+ * Generic block device cache
+ *
+ * Sits between the filesystems and the block_dev_desc_t read/write
+ * hooks of the MMC, USB storage and SATA drivers and keeps a small,
+ * size-bounded LRU list of recently accessed block ranges.  Filesystem
+ * metadata (FAT sectors, ext4 group descriptors and inode tables, ...)
+ * tends to be read over and over again while walking a path, so even a
+ * few dozen entries remove most of those device round trips.
+ *
+ * Optionally (CONFIG_BLOCK_CACHE_WRITEBACK) small writes are held in the
+ * cache as dirty entries and only written to the device on eviction or
+ * when blkcache_flush() is called at the end of a filesystem write.
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <part.h>
+#include <linux/list.h>
+
+#ifndef CONFIG_BLOCK_CACHE_MAX_BLOCKS
+#define CONFIG_BLOCK_CACHE_MAX_BLOCKS	8	/* blocks per cache entry */
+#endif
+
+#ifndef CONFIG_BLOCK_CACHE_MAX_ENTRIES
+#define CONFIG_BLOCK_CACHE_MAX_ENTRIES	32
+#endif
+
+struct block_cache_node {
+	struct list_head lh;
+	block_dev_desc_t *desc;
+	int if_type;
+	int dev;
+	lbaint_t start;
+	lbaint_t blkcnt;
+	unsigned long blksz;
+	int dirty;
+	char *cache;
+};
+
+static LIST_HEAD(block_cache);
+
+/* set while the cache itself writes to a device, see blkcache_written() */
+static int own_write;
+
+static struct block_cache_stats _stats = {
+	.max_blocks_per_entry = CONFIG_BLOCK_CACHE_MAX_BLOCKS,
+	.max_entries = CONFIG_BLOCK_CACHE_MAX_ENTRIES,
+};
+
+static int node_matches(struct block_cache_node *node,
+			block_dev_desc_t *desc)
+{
+	return node->if_type == desc->if_type && node->dev == desc->dev &&
+	       node->blksz == desc->blksz;
+}
+
+static int node_contains(struct block_cache_node *node,
+			 lbaint_t start, lbaint_t blkcnt)
+{
+	return start >= node->start &&
+	       start + blkcnt <= node->start + node->blkcnt;
+}
+
+static int node_overlaps(struct block_cache_node *node,
+			 lbaint_t start, lbaint_t blkcnt)
+{
+	return start < node->start + node->blkcnt &&
+	       node->start < start + blkcnt;
+}
+
+static void node_free(struct block_cache_node *node)
+{
+	list_del(&node->lh);
+	_stats.entries--;
+	free(node->cache);
+	free(node);
+}
+
+/* Write to the device without the driver hook dropping cached blocks */
+static ulong raw_write(block_dev_desc_t *desc, lbaint_t start,
+		       lbaint_t blkcnt, const void *buffer)
+{
+	ulong n;
+
+	own_write++;
+	n = desc->block_write(desc->dev, start, blkcnt, buffer);
+	own_write--;
+
+	return n;
+}
+
+/* Write a dirty entry back to its device and drop it */
+static int node_writeout(struct block_cache_node *node)
+{
+	ulong n;
+
+	list_del(&node->lh);
+	_stats.entries--;
+
+	n = raw_write(node->desc, node->start, node->blkcnt, node->cache);
+	if (n != node->blkcnt)
+		printf("blkcache: write back of block 0x%lx failed\n",
+		       (ulong)node->start);
+	else
+		_stats.writebacks++;
+
+	free(node->cache);
+	free(node);
+
+	return n == node->blkcnt ? 0 : -1;
+}
+
+static struct block_cache_node *node_find(block_dev_desc_t *desc,
+					  lbaint_t start, lbaint_t blkcnt)
+{
+	struct block_cache_node *node;
+
+	list_for_each_entry(node, &block_cache, lh) {
+		if (node_matches(node, desc) &&
+		    node_contains(node, start, blkcnt)) {
+			/* move to front of LRU list */
+			list_del(&node->lh);
+			list_add(&node->lh, &block_cache);
+			return node;
+		}
+	}
+
+	return NULL;
+}
+
+/* Write out every dirty entry of @desc overlapping the given range */
+static int sync_range(block_dev_desc_t *desc, lbaint_t start,
+		      lbaint_t blkcnt)
+{
+	struct block_cache_node *node;
+
+again:
+	list_for_each_entry(node, &block_cache, lh) {
+		if (node->dirty && node_matches(node, desc) &&
+		    node_overlaps(node, start, blkcnt)) {
+			if (node_writeout(node))
+				return -1;
+			goto again;
+		}
+	}
+
+	return 0;
+}
+
+static void node_insert(block_dev_desc_t *desc, lbaint_t start,
+			lbaint_t blkcnt, const void *buffer, int dirty)
+{
+	struct block_cache_node *node;
+	size_t bytes = blkcnt * desc->blksz;
+
+	if (!_stats.max_entries || blkcnt > _stats.max_blocks_per_entry)
+		return;
+
+	/* recycle the least recently used entry once the cache is full */
+	while (_stats.entries >= _stats.max_entries) {
+		node = list_entry(block_cache.prev, struct block_cache_node, lh);
+		if (node->dirty) {
+			if (node_writeout(node))
+				return;
+		} else {
+			node_free(node);
+		}
+		_stats.evictions++;
+	}
+
+	node = malloc(sizeof(*node));
+	if (!node)
+		return;
+
+	node->cache = malloc(bytes);
+	if (!node->cache) {
+		free(node);
+		return;
+	}
+
+	node->desc = desc;
+	node->if_type = desc->if_type;
+	node->dev = desc->dev;
+	node->start = start;
+	node->blkcnt = blkcnt;
+	node->blksz = desc->blksz;
+	node->dirty = dirty;
+	memcpy(node->cache, buffer, bytes);
+
+	list_add(&node->lh, &block_cache);
+	_stats.entries++;
+}
+
+ulong blk_dread(block_dev_desc_t *desc, lbaint_t start, lbaint_t blkcnt,
+		void *buffer)
+{
+	struct block_cache_node *node;
+	ulong n;
+
+	if (!desc->block_read)
+		return 0;
+
+	node = node_find(desc, start, blkcnt);
+	if (node) {
+		memcpy(buffer, node->cache +
+		       (start - node->start) * desc->blksz,
+		       blkcnt * desc->blksz);
+		_stats.hits++;
+		return blkcnt;
+	}
+
+	_stats.misses++;
+
+	if (sync_range(desc, start, blkcnt))
+		return 0;
+
+	n = desc->block_read(desc->dev, start, blkcnt, buffer);
+	if (n == blkcnt)
+		node_insert(desc, start, blkcnt, buffer, 0);
+
+	return n;
+}
+
+ulong blk_dwrite(block_dev_desc_t *desc, lbaint_t start, lbaint_t blkcnt,
+		 const void *buffer)
+{
+	struct block_cache_node *node, *tmp;
+	int absorbed = 0;
+
+	if (!desc->block_write)
+		return 0;
+
+	/*
+	 * Entries only partially covered by this write cannot be patched
+	 * in place; push their pending data out first so that it is
+	 * overwritten on the device rather than the other way around.
+	 */
+again:
+	list_for_each_entry(node, &block_cache, lh) {
+		if (node->dirty && node_matches(node, desc) &&
+		    node_overlaps(node, start, blkcnt) &&
+		    !node_contains(node, start, blkcnt)) {
+			if (node_writeout(node))
+				return 0;
+			goto again;
+		}
+	}
+
+	list_for_each_entry_safe(node, tmp, &block_cache, lh) {
+		if (!node_matches(node, desc) ||
+		    !node_overlaps(node, start, blkcnt))
+			continue;
+
+		if (!node_contains(node, start, blkcnt)) {
+			node_free(node);
+			continue;
+		}
+
+		memcpy(node->cache + (start - node->start) * desc->blksz,
+		       buffer, blkcnt * desc->blksz);
+#ifdef CONFIG_BLOCK_CACHE_WRITEBACK
+		node->dirty = 1;
+		absorbed = 1;
+#endif
+	}
+
+#ifdef CONFIG_BLOCK_CACHE_WRITEBACK
+	if (!absorbed && blkcnt <= _stats.max_blocks_per_entry &&
+	    _stats.max_entries) {
+		node_insert(desc, start, blkcnt, buffer, 1);
+		absorbed = node_find(desc, start, blkcnt) != NULL;
+	}
+#endif
+
+	if (absorbed) {
+		_stats.deferred++;
+		return blkcnt;
+	}
+
+	return raw_write(desc, start, blkcnt, buffer);
+}
+
+int blkcache_flush(block_dev_desc_t *desc)
+{
+	struct block_cache_node *node;
+	int ret = 0;
+
+again:
+	list_for_each_entry(node, &block_cache, lh) {
+		if (node->dirty && (!desc || node_matches(node, desc))) {
+			if (node_writeout(node))
+				ret = -1;
+			goto again;
+		}
+	}
+
+	return ret;
+}
+
+/*
+ * The medium may be another one now, so dirty entries are dropped too:
+ * writing them back could land on the wrong card.  Callers that still
+ * reach the old contents (a partition switch) flush first.
+ */
+void blkcache_invalidate(int if_type, int dev)
+{
+	struct block_cache_node *node, *tmp;
+	int lost = 0;
+
+	list_for_each_entry_safe(node, tmp, &block_cache, lh) {
+		if (node->if_type == if_type && node->dev == dev) {
+			lost += node->dirty;
+			node_free(node);
+		}
+	}
+
+	if (lost)
+		printf("blkcache: %d unwritten entries dropped\n", lost);
+}
+
+/*
+ * Called from the drivers' write and erase hooks before they touch the
+ * device.  For a write that did not come from the cache, entries it
+ * covers completely are dropped, dirty ones included since the new data
+ * supersedes them.  Dirty entries it only partly covers are written back
+ * first, so the outside write lands on top of them.  Returns 1 for such
+ * a write, or 0 for the cache's own write-through and write-back.
+ */
+int blkcache_written(int if_type, int dev, lbaint_t start, lbaint_t blkcnt)
+{
+	struct block_cache_node *node, *tmp;
+
+	if (own_write)
+		return 0;
+
+again:
+	list_for_each_entry_safe(node, tmp, &block_cache, lh) {
+		if (node->if_type != if_type || node->dev != dev ||
+		    !node_overlaps(node, start, blkcnt))
+			continue;
+
+		if (node->dirty && (node->start < start ||
+				    node->start + node->blkcnt > start + blkcnt)) {
+			/* drops the node, whether or not the write worked */
+			node_writeout(node);
+			goto again;
+		}
+		node_free(node);
+	}
+
+	return 1;
+}
+
+void blkcache_configure(unsigned blocks, unsigned entries)
+{
+	struct block_cache_node *node, *tmp;
+
+	if (blocks == _stats.max_blocks_per_entry &&
+	    entries == _stats.max_entries)
+		return;
+
+	blkcache_flush(NULL);
+	list_for_each_entry_safe(node, tmp, &block_cache, lh)
+		node_free(node);
+
+	_stats.max_blocks_per_entry = blocks;
+	_stats.max_entries = entries;
+	_stats.hits = 0;
+	_stats.misses = 0;
+	_stats.evictions = 0;
+	_stats.deferred = 0;
+	_stats.writebacks = 0;
+}
+
+void blkcache_stats(struct block_cache_stats *stats)
+{
+	memcpy(stats, &_stats, sizeof(*stats));
+}
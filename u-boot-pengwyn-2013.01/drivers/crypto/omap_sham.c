@@ -0,0 +1,206 @@
+/*
+ * OMAP4/AM33xx SHA1/SHA2/MD5 accelerator, polled I/O
+ *
+ * The whole buffer is hashed as one context: the length is written up
+ * front, the data is fed 64 bytes at a time as the module asks for it
+ * and the module adds the padding itself.
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+#include <common.h>
+#include <hash.h>
+#include <watchdog.h>
+#include <asm/io.h>
+#include <asm/arch/hardware.h>
+#include <asm/arch/sys_proto.h>
+
+struct sham_regs {
+	u32 odigest[8];		/* 0x00 */
+	u32 idigest[8];		/* 0x20 */
+	u32 digcnt;		/* 0x40 */
+	u32 mode;		/* 0x44 */
+	u32 length;		/* 0x48 */
+	u32 resv1[13];
+	u32 din[16];		/* 0x80 */
+	u32 resv2[16];
+	u32 rev;		/* 0x100 */
+	u32 resv3[3];
+	u32 sysconfig;		/* 0x110 */
+	u32 sysstatus;		/* 0x114 */
+	u32 irqstatus;		/* 0x118 */
+	u32 irqenable;		/* 0x11c */
+};
+
+#define SHAM_MODE_ALGO_MD5		(0 << 1)
+#define SHAM_MODE_ALGO_SHA1		(1 << 1)
+#define SHAM_MODE_ALGO_SHA256		(3 << 1)
+#define SHAM_MODE_ALGO_CONSTANT		(1 << 3)
+#define SHAM_MODE_CLOSE_HASH		(1 << 4)
+
+#define SHAM_SYSCONFIG_SOFTRESET	(1 << 1)
+#define SHAM_SYSSTATUS_RESETDONE	(1 << 0)
+
+#define SHAM_IRQSTATUS_OUTPUT_RDY	(1 << 0)
+#define SHAM_IRQSTATUS_INPUT_RDY	(1 << 1)
+
+#define SHAM_TIMEOUT_MS			100
+
+static struct sham_regs *const sham = (struct sham_regs *)AM335X_SHA0_BASE;
+
+static int sham_wait(u32 *reg, u32 mask)
+{
+	ulong start = get_timer(0);
+
+	while (!(readl(reg) & mask)) {
+		if (get_timer(start) > SHAM_TIMEOUT_MS)
+			return -1;
+	}
+	return 0;
+}
+
+static int sham_digest(u32 algo, int words, const void *data, uint len,
+		       uint8_t *output, uint chunk_sz);
+
+/* Known answers for "abc" (FIPS 180-2 and RFC 1321 test vectors) */
+static const struct {
+	u32 algo;
+	int words;
+	u8 digest[32];
+} sham_kat[] = {
+	{ SHAM_MODE_ALGO_SHA1, 5, {
+		0xa9, 0x99, 0x3e, 0x36, 0x47, 0x06, 0x81, 0x6a,
+		0xba, 0x3e, 0x25, 0x71, 0x78, 0x50, 0xc2, 0x6c,
+		0x9c, 0xd0, 0xd8, 0x9d } },
+	{ SHAM_MODE_ALGO_SHA256, 8, {
+		0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea,
+		0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+		0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c,
+		0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad } },
+	{ SHAM_MODE_ALGO_MD5, 4, {
+		0x90, 0x01, 0x50, 0x98, 0x3c, 0xd2, 0x4f, 0xb0,
+		0xd6, 0x96, 0x3f, 0x7d, 0x28, 0xe1, 0x7f, 0x72 } },
+};
+
+/*
+ * Reset the module and check it against the known answers once.  On
+ * any failure the provider stays disabled and hash_digest() falls back
+ * to the C code.
+ */
+static int sham_init(void)
+{
+	static int ready;
+	u8 out[32];
+	int i;
+
+	if (ready)
+		return ready < 0 ? -1 : 0;
+
+	enable_sham_clock();
+	writel(SHAM_SYSCONFIG_SOFTRESET, &sham->sysconfig);
+	if (sham_wait(&sham->sysstatus, SHAM_SYSSTATUS_RESETDONE)) {
+		debug("omap-sham: reset timed out\n");
+		ready = -1;
+		return -1;
+	}
+	debug("omap-sham: revision %08x\n", readl(&sham->rev));
+
+	ready = 1;
+	for (i = 0; i < ARRAY_SIZE(sham_kat); i++) {
+		if (sham_digest(sham_kat[i].algo, sham_kat[i].words, "abc", 3,
+				out, 64) ||
+		    memcmp(out, sham_kat[i].digest, 4 * sham_kat[i].words)) {
+			printf("omap-sham: self-test failed, disabled\n");
+			ready = -1;
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static int sham_digest(u32 algo, int words, const void *data, uint len,
+		       uint8_t *output, uint chunk_sz)
+{
+	const u8 *p = data;
+	u32 block[16], val;
+	const u32 *src;
+	uint n, since_wd = 0;
+	int i;
+
+	/* a zero length would never start the engine */
+	if (!len || sham_init())
+		return -1;
+
+	writel(algo | SHAM_MODE_ALGO_CONSTANT | SHAM_MODE_CLOSE_HASH,
+	       &sham->mode);
+	writel(len, &sham->length);
+
+	while (len) {
+		n = min(len, sizeof(block));
+		if (sham_wait(&sham->irqstatus, SHAM_IRQSTATUS_INPUT_RDY))
+			return -1;
+
+		if (n < sizeof(block) || ((ulong)p & 3)) {
+			memcpy(block, p, n);
+			src = block;
+		} else {
+			src = (const u32 *)p;
+		}
+		for (i = 0; i < DIV_ROUND_UP(n, 4); i++)
+			writel(src[i], &sham->din[i]);
+
+		p += n;
+		len -= n;
+		since_wd += n;
+		if (since_wd >= chunk_sz) {
+			WATCHDOG_RESET();
+			since_wd = 0;
+		}
+	}
+
+	if (sham_wait(&sham->irqstatus, SHAM_IRQSTATUS_OUTPUT_RDY))
+		return -1;
+
+	/* IDIGEST holds the digest in memory order for every algorithm */
+	for (i = 0; i < words; i++) {
+		val = readl(&sham->idigest[i]);
+		memcpy(output + 4 * i, &val, 4);
+	}
+
+	return 0;
+}
+
+int omap_sham_sha1(const void *data, uint len, uint8_t *output,
+		   uint chunk_sz)
+{
+	return sham_digest(SHAM_MODE_ALGO_SHA1, 5, data, len, output,
+			   chunk_sz);
+}
+
+int omap_sham_sha256(const void *data, uint len, uint8_t *output,
+		     uint chunk_sz)
+{
+	return sham_digest(SHAM_MODE_ALGO_SHA256, 8, data, len, output,
+			   chunk_sz);
+}
+
+int omap_sham_md5(const void *data, uint len, uint8_t *output,
+		  uint chunk_sz)
+{
+	return sham_digest(SHAM_MODE_ALGO_MD5, 4, data, len, output,
+			   chunk_sz);
+}
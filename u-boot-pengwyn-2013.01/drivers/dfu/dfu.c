@@ -21,6 +21,7 @@
 
 #include <common.h>
 #include <malloc.h>
+#include <div64.h>
 #include <fat.h>
 #include <dfu.h>
 #include <linux/list.h>
@@ -41,13 +42,121 @@ static int dfu_find_alt_num(const char *s)
 }
 
 static unsigned char __aligned(CONFIG_SYS_CACHELINE_SIZE)
-				     dfu_buf[DFU_DATA_BUF_SIZE];
+			dfu_buf[DFU_NUM_BUFS][DFU_DATA_BUF_SIZE];
 
-static int dfu_write_buffer_flush(struct dfu_entity *dfu)
+/*
+ * Downloads are received into one buffer of the ring while the filled
+ * ones wait to be written to the medium.  dfu_write_poll(), run from the
+ * gadget loop, writes them a DFU_WRITE_CHUNK_SIZE piece at a time, so the
+ * host keeps getting its DNLOAD requests answered while the eMMC or NAND
+ * is busy.  Only when every buffer is full does the download wait for
+ * the medium.
+ */
+struct dfu_pending {
+	struct dfu_entity *dfu;
+	u8 *buf;
+	u64 offset;	/* medium offset of buf[0] */
+	long len;
+	long done;	/* bytes already written */
+};
+
+static struct dfu_pending dfu_pending[DFU_NUM_BUFS];
+static int dfu_pending_head, dfu_pending_count;
+
+/* raw layouts can be written piecewise, file layouts only in one go */
+static long dfu_write_chunk(struct dfu_pending *p)
+{
+	long left = p->len - p->done;
+
+	if (p->dfu->layout == DFU_RAW_ADDR && left > DFU_WRITE_CHUNK_SIZE)
+		return DFU_WRITE_CHUNK_SIZE;
+	return left;
+}
+
+/* Write the next piece of the oldest pending buffer */
+static int dfu_write_pending_one(void)
 {
+	struct dfu_pending *p;
+	struct dfu_entity *dfu;
 	long w_size;
+	ulong start;
 	int ret;
 
+	if (!dfu_pending_count)
+		return 0;
+
+	p = &dfu_pending[dfu_pending_head];
+	dfu = p->dfu;
+	w_size = dfu_write_chunk(p);
+
+	start = get_timer(0);
+	ret = dfu->write_medium(dfu, p->offset + p->done, p->buf + p->done,
+				&w_size);
+	dfu->write_time += get_timer(start);
+	if (ret) {
+		printf("%s: Write error at offset 0x%llx!\n", __func__,
+		       p->offset + p->done);
+		dfu->write_err = ret;
+	}
+
+	p->done += w_size;
+	if (ret || w_size <= 0 || p->done >= p->len) {
+		dfu_pending_head = (dfu_pending_head + 1) % DFU_NUM_BUFS;
+		dfu_pending_count--;
+		puts("#");
+	}
+
+	return ret;
+}
+
+int dfu_write_poll(void)
+{
+	return dfu_write_pending_one();
+}
+
+int dfu_write_flush(void)
+{
+	int ret = 0;
+
+	while (dfu_pending_count)
+		if (dfu_write_pending_one())
+			ret = -1;
+
+	return ret;
+}
+
+/* First buffer of the ring that is neither pending nor being filled */
+static u8 *dfu_free_buffer(void)
+{
+	int i, j, busy;
+
+	for (i = 0; i < DFU_NUM_BUFS; i++) {
+		busy = 0;
+		for (j = 0; j < dfu_pending_count; j++)
+			if (dfu_pending[(dfu_pending_head + j) %
+					DFU_NUM_BUFS].buf == dfu_buf[i])
+				busy = 1;
+		if (!busy)
+			return dfu_buf[i];
+	}
+
+	return NULL;
+}
+
+static void dfu_set_buffer(struct dfu_entity *dfu, u8 *buf)
+{
+	dfu->i_buf_start = buf;
+	dfu->i_buf_end = buf + DFU_DATA_BUF_SIZE;
+	dfu->i_buf = dfu->i_buf_start;
+}
+
+static int dfu_write_buffer_flush(struct dfu_entity *dfu)
+{
+	struct dfu_pending *p;
+	long w_size;
+	u8 *buf;
+	int ret = 0;
+
 	/* flush size? */
 	w_size = dfu->i_buf - dfu->i_buf_start;
 	if (w_size == 0)
@@ -56,21 +165,38 @@ static int dfu_write_buffer_flush(struct dfu_entity *dfu)
 	/* update CRC32 */
 	dfu->crc = crc32(dfu->crc, dfu->i_buf_start, w_size);
 
-	ret = dfu->write_medium(dfu, dfu->offset, dfu->i_buf_start, &w_size);
-	if (ret)
-		debug("%s: Write error!\n", __func__);
-
-	/* point back */
-	dfu->i_buf = dfu->i_buf_start;
+	/* hand the buffer over to the writer */
+	p = &dfu_pending[(dfu_pending_head + dfu_pending_count) %
+			 DFU_NUM_BUFS];
+	p->dfu = dfu;
+	p->buf = dfu->i_buf_start;
+	p->offset = dfu->offset;
+	p->len = w_size;
+	p->done = 0;
+	dfu_pending_count++;
 
 	/* update offset */
 	dfu->offset += w_size;
 
-	puts("#");
+	/* receive into the next free buffer, waiting for one if need be */
+	while (!(buf = dfu_free_buffer()))
+		if (dfu_write_pending_one())
+			ret = -1;
+	dfu_set_buffer(dfu, buf);
 
 	return ret;
 }
 
+static void dfu_show_throughput(struct dfu_entity *dfu)
+{
+	ulong total = get_timer(dfu->start_time);
+
+	printf("%s: %llu bytes in %lu ms", dfu->name, dfu->offset, total);
+	if (total)
+		printf(" (%llu KiB/s)", lldiv(dfu->offset * 1000, total) >> 10);
+	printf(", medium busy %lu ms\n", dfu->write_time);
+}
+
 int dfu_write(struct dfu_entity *dfu, void *buf, int size, int blk_seq_num)
 {
 	int ret = 0;
@@ -86,9 +212,13 @@ int dfu_write(struct dfu_entity *dfu, void *buf, int size, int blk_seq_num)
 		dfu->crc = 0;
 		dfu->offset = 0;
 		dfu->i_blk_seq_num = 0;
-		dfu->i_buf_start = dfu_buf;
-		dfu->i_buf_end = dfu_buf + sizeof(dfu_buf);
-		dfu->i_buf = dfu->i_buf_start;
+		dfu->start_time = get_timer(0);
+		dfu->write_time = 0;
+		dfu->write_err = 0;
+
+		/* a previous download may still be on its way out */
+		dfu_write_flush();
+		dfu_set_buffer(dfu, dfu_buf[0]);
 
 		dfu->inited = 1;
 	}
@@ -141,17 +271,22 @@ int dfu_write(struct dfu_entity *dfu, void *buf, int size, int blk_seq_num)
 
 	/* end? */
 	if (size == 0) {
+		/* manifestation: everything must be on the medium now */
+		if (dfu_write_flush() && ret == 0)
+			ret = -1;
+		if (dfu->write_err && ret == 0)
+			ret = dfu->write_err;
+
 		debug("%s: DFU complete CRC32: 0x%x\n", __func__, dfu->crc);
 
 		printf("\nDownload complete (CRC32 0x%04x)\n", dfu->crc);
+		dfu_show_throughput(dfu);
 
 		/* clear everything */
 		dfu->crc = 0;
 		dfu->offset = 0;
 		dfu->i_blk_seq_num = 0;
-		dfu->i_buf_start = dfu_buf;
-		dfu->i_buf_end = dfu_buf + sizeof(dfu_buf);
-		dfu->i_buf = dfu->i_buf_start;
+		dfu_set_buffer(dfu, dfu_buf[0]);
 
 		dfu->inited = 0;
 
@@ -228,9 +363,8 @@ int dfu_read(struct dfu_entity *dfu, void *buf, int size, int blk_seq_num)
 		dfu->i_blk_seq_num = 0;
 		dfu->crc = 0;
 		dfu->offset = 0;
-		dfu->i_buf_start = dfu_buf;
-		dfu->i_buf_end = dfu_buf + sizeof(dfu_buf);
-		dfu->i_buf = dfu->i_buf_start;
+		dfu_write_flush();
+		dfu_set_buffer(dfu, dfu_buf[0]);
 		dfu->b_left = 0;
 
 		dfu->bad_skip = 0;
@@ -259,9 +393,7 @@ int dfu_read(struct dfu_entity *dfu, void *buf, int size, int blk_seq_num)
 		dfu->i_blk_seq_num = 0;
 		dfu->crc = 0;
 		dfu->offset = 0;
-		dfu->i_buf_start = dfu_buf;
-		dfu->i_buf_end = dfu_buf + sizeof(dfu_buf);
-		dfu->i_buf = dfu->i_buf_start;
+		dfu_set_buffer(dfu, dfu_buf[0]);
 		dfu->b_left = 0;
 
 		dfu->bad_skip = 0;
@@ -248,6 +248,11 @@ int mmc_set_blocklen(struct mmc *mmc, int len)
 {
 	struct mmc_cmd cmd;
 
+	/* The block length is fixed at 512 bytes, CMD16 is illegal in DDR */
+	if (mmc->timing == MMC_TIMING_MMC_DDR52 ||
+	    mmc->timing == MMC_TIMING_UHS_DDR50)
+		return 0;
+
 	cmd.cmdidx = MMC_CMD_SET_BLOCKLEN;
 	cmd.resp_type = MMC_RSP_R1;
 	cmd.cmdarg = len;
@@ -334,6 +339,8 @@ mmc_berase(int dev_num, unsigned long start, lbaint_t blkcnt)
 	if (!mmc)
 		return -1;
 
+	blk_media_written(IF_TYPE_MMC, dev_num, start, blkcnt);
+
 	if ((start % mmc->erase_grp_size) || (blkcnt % mmc->erase_grp_size))
 		printf("\n\nCaution! Your devices Erase group is 0x%x\n"
 			"The erase range would be change to 0x%lx~0x%lx\n\n",
@@ -422,6 +429,8 @@ mmc_bwrite(int dev_num, ulong start, lbaint_t blkcnt, const void*src)
 	if (!mmc)
 		return 0;
 
+	blk_media_written(IF_TYPE_MMC, dev_num, start, blkcnt);
+
 	if (mmc_set_blocklen(mmc, mmc->write_bl_len))
 		return 0;
 
@@ -528,6 +537,36 @@ int mmc_go_idle(struct mmc* mmc)
 	return 0;
 }
 
+/*
+ * Move a UHS-I card that accepted 1.8V signalling in its ACMD41 response
+ * over to 1.8V with CMD11.  If the card refuses the command it is still
+ * at 3.3V and simply gets used without the UHS modes; if the host fails
+ * halfway through, the card needs a power cycle.
+ */
+static int sd_switch_signal_voltage(struct mmc *mmc)
+{
+	struct mmc_cmd cmd;
+	int err;
+
+	cmd.cmdidx = SD_CMD_SWITCH_UHS18V;
+	cmd.resp_type = MMC_RSP_R1;
+	cmd.cmdarg = 0;
+
+	err = mmc_send_cmd(mmc, &cmd, NULL);
+	if (err || (cmd.response[0] & MMC_STATUS_ERROR))
+		return 0;
+
+	err = mmc->set_signal_voltage(mmc, MMC_SIGNAL_VOLTAGE_180);
+	if (err) {
+		printf("%s: switch to 1.8V signalling failed\n", mmc->name);
+		return err;
+	}
+
+	mmc->signal_voltage = MMC_SIGNAL_VOLTAGE_180;
+
+	return 0;
+}
+
 int
 sd_send_op_cond(struct mmc *mmc)
 {
@@ -561,6 +600,10 @@ sd_send_op_cond(struct mmc *mmc)
 		if (mmc->version == SD_VERSION_2)
 			cmd.cmdarg |= OCR_HCS;
 
+		if (mmc->version == SD_VERSION_2 &&
+		    (mmc->host_caps & MMC_MODE_UHS) && mmc->set_signal_voltage)
+			cmd.cmdarg |= OCR_S18R;
+
 		err = mmc_send_cmd(mmc, &cmd, NULL);
 
 		if (err)
@@ -591,6 +634,10 @@ sd_send_op_cond(struct mmc *mmc)
 	mmc->high_capacity = ((mmc->ocr & OCR_HCS) == OCR_HCS);
 	mmc->rca = 0;
 
+	if (!mmc_host_is_spi(mmc) && (cmd.cmdarg & OCR_S18R) &&
+	    (mmc->ocr & (OCR_HCS | OCR_S18R)) == (OCR_HCS | OCR_S18R))
+		return sd_switch_signal_voltage(mmc);
+
 	return 0;
 }
 
@@ -722,7 +769,7 @@ int mmc_change_freq(struct mmc *mmc)
 	if (err)
 		return err;
 
-	cardtype = ext_csd[EXT_CSD_CARD_TYPE] & 0xf;
+	cardtype = ext_csd[EXT_CSD_CARD_TYPE] & 0x3f;
 
 	err = mmc_switch(mmc, EXT_CSD_CMD_SET_NORMAL, EXT_CSD_HS_TIMING, 1);
 
@@ -745,6 +792,16 @@ int mmc_change_freq(struct mmc *mmc)
 	else
 		mmc->card_caps |= MMC_MODE_HS;
 
+	/*
+	 * DDR52 and HS200 are only selected once the bus width is known,
+	 * see mmc_select_timing().
+	 */
+	if (cardtype & EXT_CSD_CARD_TYPE_DDR_52)
+		mmc->card_caps |= MMC_MODE_DDR_52MHz;
+	/* HS200 is only run with 1.8V I/O, see mmc_select_hs200() */
+	if (cardtype & EXT_CSD_CARD_TYPE_HS200_1_8V)
+		mmc->card_caps |= MMC_MODE_HS200;
+
 	return 0;
 }
 
@@ -755,6 +812,10 @@ int mmc_switch_part(int dev_num, unsigned int part_num)
 	if (!mmc)
 		return -1;
 
+	/* Same device number, different contents */
+	blkcache_flush(&mmc->block_dev);
+	blk_media_changed(IF_TYPE_MMC, dev_num);
+
 	return mmc_switch(mmc, EXT_CSD_CMD_SET_NORMAL, EXT_CSD_PART_CONF,
 			  (mmc->part_config & ~PART_ACCESS_MASK)
 			  | (part_num & PART_ACCESS_MASK));
@@ -876,6 +937,24 @@ retry_scr:
 			break;
 	}
 
+	/*
+	 * A card at 1.8V is in SDR12 and offers the UHS access modes, which
+	 * are selected by sd_select_uhs() once the bus is 4 bits wide.
+	 */
+	if (mmc->signal_voltage == MMC_SIGNAL_VOLTAGE_180) {
+		uint support = __be32_to_cpu(switch_status[3]) >> 16;
+
+		if (support & (1 << SD_ACCESS_SDR50))
+			mmc->card_caps |= MMC_MODE_UHS_SDR50;
+		if (support & (1 << SD_ACCESS_SDR104))
+			mmc->card_caps |= MMC_MODE_UHS_SDR104;
+		if (support & (1 << SD_ACCESS_DDR50))
+			mmc->card_caps |= MMC_MODE_UHS_DDR50;
+
+		if (mmc->card_caps & mmc->host_caps & MMC_MODE_UHS)
+			return 0;
+	}
+
 	/* If high-speed isn't supported, we return */
 	if (!(__be32_to_cpu(switch_status[3]) & SD_HIGHSPEED_SUPPORTED))
 		return 0;
@@ -901,6 +980,51 @@ retry_scr:
 	return 0;
 }
 
+/*
+ * Switch a 1.8V card on a 4 bit bus to the fastest UHS-I access mode
+ * shared with the host.  SDR104 needs tuning with CMD19; SDR50 is tuned
+ * too when the host can do it.
+ */
+static int sd_select_uhs(struct mmc *mmc)
+{
+	ALLOC_CACHE_ALIGN_BUFFER(uint, switch_status, 16);
+	uint timing, clock;
+	u8 mode;
+	int err;
+
+	if ((mmc->card_caps & MMC_MODE_UHS_SDR104) && mmc->execute_tuning) {
+		mode = SD_ACCESS_SDR104;
+		timing = MMC_TIMING_UHS_SDR104;
+		clock = 208000000;
+	} else if (mmc->card_caps & MMC_MODE_UHS_DDR50) {
+		mode = SD_ACCESS_DDR50;
+		timing = MMC_TIMING_UHS_DDR50;
+		clock = 50000000;
+	} else if (mmc->card_caps & MMC_MODE_UHS_SDR50) {
+		mode = SD_ACCESS_SDR50;
+		timing = MMC_TIMING_UHS_SDR50;
+		clock = 100000000;
+	} else
+		return -1;
+
+	err = sd_switch(mmc, SD_SWITCH_SWITCH, 0, mode, (u8 *)switch_status);
+	if (err)
+		return err;
+
+	if (((__be32_to_cpu(switch_status[4]) >> 24) & 0xf) != mode)
+		return -1;
+
+	mmc->timing = timing;
+	mmc->tran_speed = clock;
+	mmc_set_clock(mmc, clock);
+
+	if (mode == SD_ACCESS_SDR104 ||
+	    (mode == SD_ACCESS_SDR50 && mmc->execute_tuning))
+		return mmc->execute_tuning(mmc, MMC_CMD_SEND_TUNING_BLOCK);
+
+	return 0;
+}
+
 /* frequency bases */
 /* divided by 10 to be nice to platforms without floating point */
 static const int fbase[] = {
@@ -957,6 +1081,86 @@ void mmc_set_bus_width(struct mmc *mmc, uint width)
 	mmc_set_ios(mmc);
 }
 
+/*
+ * HS200: 200MHz SDR on a 4 or 8 bit bus with 1.8V I/O.  The host has to
+ * tune its sampling point with CMD21 at the final clock; if that fails
+ * the card is put back into high-speed timing at 3.3V.
+ */
+static int mmc_select_hs200(struct mmc *mmc)
+{
+	int err;
+
+	err = mmc->set_signal_voltage(mmc, MMC_SIGNAL_VOLTAGE_180);
+	if (err) {
+		mmc->set_signal_voltage(mmc, MMC_SIGNAL_VOLTAGE_330);
+		return err;
+	}
+	mmc->signal_voltage = MMC_SIGNAL_VOLTAGE_180;
+
+	err = mmc_switch(mmc, EXT_CSD_CMD_SET_NORMAL, EXT_CSD_HS_TIMING,
+			 EXT_CSD_TIMING_HS200);
+	if (err)
+		goto out_330;
+
+	mmc->timing = MMC_TIMING_MMC_HS200;
+	mmc_set_clock(mmc, 200000000);
+
+	err = mmc->execute_tuning(mmc, MMC_CMD_SEND_TUNING_BLOCK_HS200);
+	if (!err) {
+		mmc->tran_speed = 200000000;
+		return 0;
+	}
+
+	mmc->timing = MMC_TIMING_MMC_HS;
+	mmc_set_clock(mmc, 52000000);
+	mmc_switch(mmc, EXT_CSD_CMD_SET_NORMAL, EXT_CSD_HS_TIMING,
+		   EXT_CSD_TIMING_HS);
+out_330:
+	mmc->set_signal_voltage(mmc, MMC_SIGNAL_VOLTAGE_330);
+	mmc->signal_voltage = MMC_SIGNAL_VOLTAGE_330;
+
+	return err;
+}
+
+/* DDR52: high-speed timing with data latched on both clock edges */
+static int mmc_select_ddr52(struct mmc *mmc, int width)
+{
+	int err;
+
+	err = mmc_switch(mmc, EXT_CSD_CMD_SET_NORMAL, EXT_CSD_BUS_WIDTH,
+			 width == EXT_CSD_BUS_WIDTH_8 ?
+			 EXT_CSD_DDR_BUS_WIDTH_8 : EXT_CSD_DDR_BUS_WIDTH_4);
+	if (err)
+		return err;
+
+	mmc->timing = MMC_TIMING_MMC_DDR52;
+	mmc_set_ios(mmc);
+
+	return 0;
+}
+
+/*
+ * Pick the fastest timing beyond 52MHz high-speed that both the card
+ * and the host support, once the card runs high-speed on a 4 or 8 bit
+ * bus ('width' is the EXT_CSD_BUS_WIDTH value in use).  Failing that
+ * the card just stays at high-speed.
+ */
+static void mmc_select_timing(struct mmc *mmc, int width)
+{
+	if (width != EXT_CSD_BUS_WIDTH_4 && width != EXT_CSD_BUS_WIDTH_8)
+		return;
+
+	if (!(mmc->card_caps & MMC_MODE_HS_52MHz))
+		return;
+
+	if ((mmc->card_caps & MMC_MODE_HS200) && mmc->execute_tuning &&
+	    mmc->set_signal_voltage && !mmc_select_hs200(mmc))
+		return;
+
+	if (mmc->card_caps & MMC_MODE_DDR_52MHz)
+		mmc_select_ddr52(mmc, width);
+}
+
 int mmc_startup(struct mmc *mmc)
 {
 	int err, width;
@@ -1173,9 +1377,17 @@ int mmc_startup(struct mmc *mmc)
 			mmc_set_bus_width(mmc, 4);
 		}
 
-		if (mmc->card_caps & MMC_MODE_HS)
+		if ((mmc->card_caps & MMC_MODE_UHS) &&
+		    (mmc->card_caps & MMC_MODE_4BIT)) {
+			if (sd_select_uhs(mmc)) {
+				/* Card stays in (or returns to) SDR12 */
+				mmc->timing = MMC_TIMING_LEGACY;
+				mmc->tran_speed = 25000000;
+			}
+		} else if (mmc->card_caps & MMC_MODE_HS) {
+			mmc->timing = MMC_TIMING_SD_HS;
 			mmc->tran_speed = 50000000;
-		else
+		} else
 			mmc->tran_speed = 25000000;
 	} else {
 		width = ((mmc->host_caps & MMC_MODE_MASK_WIDTH_BITS) >>
@@ -1212,11 +1424,14 @@ int mmc_startup(struct mmc *mmc)
 		}
 
 		if (mmc->card_caps & MMC_MODE_HS) {
+			mmc->timing = MMC_TIMING_MMC_HS;
 			if (mmc->card_caps & MMC_MODE_HS_52MHz)
 				mmc->tran_speed = 52000000;
 			else
 				mmc->tran_speed = 26000000;
 		}
+
+		mmc_select_timing(mmc, width);
 	}
 
 	mmc_set_clock(mmc, mmc->tran_speed);
@@ -1306,11 +1521,20 @@ int mmc_init(struct mmc *mmc)
 	if (mmc->has_init)
 		return 0;
 
+	/* The card may have been swapped since it was last initialized */
+	blk_media_changed(IF_TYPE_MMC, mmc->block_dev.dev);
+
 	err = mmc->init(mmc);
 
 	if (err)
 		return err;
 
+	mmc->timing = MMC_TIMING_LEGACY;
+	if (mmc->set_signal_voltage &&
+	    mmc->signal_voltage != MMC_SIGNAL_VOLTAGE_330)
+		mmc->set_signal_voltage(mmc, MMC_SIGNAL_VOLTAGE_330);
+	mmc->signal_voltage = MMC_SIGNAL_VOLTAGE_330;
+
 	mmc_set_bus_width(mmc, 1);
 	mmc_set_clock(mmc, 1);
 
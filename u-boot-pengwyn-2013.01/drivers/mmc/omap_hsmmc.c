@@ -41,10 +41,16 @@
 /* If we fail after 1 second wait, something is really bad */
 #define MAX_RETRY_MS	1000
 
+struct omap_hsmmc_data {
+	struct hsmmc *base_addr;
+	int transfer_mode;	/* OMAP_HSMMC_PIO or OMAP_HSMMC_DMA */
+};
+
 static int mmc_read_data(struct hsmmc *mmc_base, char *buf, unsigned int size);
 static int mmc_write_data(struct hsmmc *mmc_base, const char *buf,
 			unsigned int siz);
-static struct mmc hsmmc_dev[2];
+static struct mmc hsmmc_dev[3];
+static struct omap_hsmmc_data hsmmc_dev_data[3];
 
 #if defined(CONFIG_OMAP44XX) && defined(CONFIG_TWL6030_POWER)
 static void omap4_vmmc_pbias_config(struct mmc *mmc)
@@ -177,7 +183,9 @@ void mmc_init_stream(struct hsmmc *mmc_base)
 
 static int mmc_init_setup(struct mmc *mmc)
 {
-	struct hsmmc *mmc_base = (struct hsmmc *)mmc->priv;
+	struct omap_hsmmc_data *priv = (struct omap_hsmmc_data *)mmc->priv;
+	struct hsmmc *mmc_base = priv->base_addr;
+	unsigned int dma_con = 0, dma_hctl = 0, dma_ie = 0;
 	unsigned int reg_val;
 	unsigned int dsor;
 	ulong start;
@@ -202,7 +210,22 @@ static int mmc_init_setup(struct mmc *mmc)
 			return TIMEOUT;
 		}
 	}
-	writel(DTW_1_BITMODE | SDBP_PWROFF | SDVS_3V0, &mmc_base->hctl);
+#ifdef CONFIG_OMAP_HSMMC_DMA
+	if (priv->transfer_mode == OMAP_HSMMC_DMA) {
+		if (readl(&mmc_base->capa) & AD2S_ADMA2SUP) {
+			dma_con = DMA_MNS_MASTER;
+			dma_hctl = DMAS_ADMA2;
+			dma_ie = IE_ADMAE;
+		} else {
+			priv->transfer_mode = OMAP_HSMMC_PIO;
+		}
+	}
+#else
+	priv->transfer_mode = OMAP_HSMMC_PIO;
+#endif
+
+	writel(DTW_1_BITMODE | SDBP_PWROFF | SDVS_3V0 | dma_hctl,
+		&mmc_base->hctl);
 	writel(readl(&mmc_base->capa) | VS30_3V0SUP | VS18_1V8SUP,
 		&mmc_base->capa);
 
@@ -210,7 +233,8 @@ static int mmc_init_setup(struct mmc *mmc)
 
 	writel(CTPL_MMC_SD | reg_val | WPP_ACTIVEHIGH | CDP_ACTIVEHIGH |
 		MIT_CTO | DW8_1_4BITMODE | MODE_FUNC | STR_BLOCK |
-		HR_NOHOSTRESP | INIT_NOINIT | NOOPENDRAIN, &mmc_base->con);
+		HR_NOHOSTRESP | INIT_NOINIT | NOOPENDRAIN | dma_con,
+		&mmc_base->con);
 
 	dsor = 240;
 	mmc_reg_out(&mmc_base->sysctl, (ICE_MASK | DTO_MASK | CEN_MASK),
@@ -229,8 +253,8 @@ static int mmc_init_setup(struct mmc *mmc)
 	writel(readl(&mmc_base->hctl) | SDBP_PWRON, &mmc_base->hctl);
 
 	writel(IE_BADA | IE_CERR | IE_DEB | IE_DCRC | IE_DTO | IE_CIE |
-		IE_CEB | IE_CCRC | IE_CTO | IE_BRR | IE_BWR | IE_TC | IE_CC,
-		&mmc_base->ie);
+		IE_CEB | IE_CCRC | IE_CTO | IE_BRR | IE_BWR | IE_TC | IE_CC |
+		dma_ie, &mmc_base->ie);
 
 	mmc_init_stream(mmc_base);
 
@@ -259,10 +283,118 @@ static void mmc_reset_controller_fsm(struct hsmmc *mmc_base, u32 bit)
 	}
 }
 
+#ifdef CONFIG_OMAP_HSMMC_DMA
+/*
+ * ADMA2 descriptor table.  A transfer is described by up to
+ * ADMA_MAX_DESC descriptors of ADMA_MAX_LEN bytes each, which also
+ * bounds the number of blocks per command (mmc->b_max).
+ */
+#define ADMA_MAX_DESC		128
+#define ADMA_MAX_LEN		0x8000
+
+#define ADMA_DESC_VALID		(1 << 0)
+#define ADMA_DESC_END		(1 << 1)
+#define ADMA_DESC_TRAN		(2 << 4)
+
+struct omap_hsmmc_adma_desc {
+	u16 attr;
+	u16 len;
+	u32 addr;
+};
+
+static struct omap_hsmmc_adma_desc adma_desc[ADMA_MAX_DESC]
+	__aligned(ARCH_DMA_MINALIGN);
+
+/*
+ * Build the descriptor chain for 'data' and hand the buffer over to the
+ * controller.  Return 0 if the transfer is to be done by DMA, -1 if it
+ * must fall back to PIO (buffer not cache line aligned).
+ */
+static int omap_hsmmc_adma_prepare(struct hsmmc *mmc_base,
+				   struct mmc_data *data)
+{
+	ulong buf = (data->flags & MMC_DATA_READ) ?
+		(ulong)data->dest : (ulong)data->src;
+	ulong size = data->blocksize * data->blocks;
+	ulong addr = buf;
+	int i = 0;
+
+	if ((buf | size) & (ARCH_DMA_MINALIGN - 1))
+		return -1;
+	if (size > ADMA_MAX_DESC * ADMA_MAX_LEN)
+		return -1;
+
+	while (addr < buf + size) {
+		ulong len = min(buf + size - addr, (ulong)ADMA_MAX_LEN);
+
+		adma_desc[i].attr = ADMA_DESC_VALID | ADMA_DESC_TRAN;
+		adma_desc[i].len = len;
+		adma_desc[i].addr = addr;
+		addr += len;
+		i++;
+	}
+	adma_desc[i - 1].attr |= ADMA_DESC_END;
+
+	flush_dcache_range((ulong)adma_desc,
+			   (ulong)adma_desc + roundup(i * sizeof(adma_desc[0]),
+						      ARCH_DMA_MINALIGN));
+
+	/*
+	 * Also on reads: dirty lines evicted during the transfer would
+	 * otherwise overwrite the data written by the controller.
+	 */
+	if (data->flags & MMC_DATA_READ)
+		invalidate_dcache_range(buf, buf + size);
+	else
+		flush_dcache_range(buf, buf + size);
+
+	writel((ulong)adma_desc, &mmc_base->admasal);
+
+	return 0;
+}
+
+static int omap_hsmmc_adma_wait(struct hsmmc *mmc_base,
+				struct mmc_data *data)
+{
+	ulong size = data->blocksize * data->blocks;
+	ulong start = get_timer(0);
+	unsigned int mmc_stat;
+	int ret = 0;
+
+	do {
+		mmc_stat = readl(&mmc_base->stat);
+		if (mmc_stat & (IE_DTO | IE_DCRC | IE_DEB | IE_ADMAE)) {
+			printf("%s: transfer error (stat %x, adma %x)\n",
+			       __func__, mmc_stat, readl(&mmc_base->admaes));
+			mmc_reset_controller_fsm(mmc_base, SYSCTL_SRD);
+			ret = -1;
+			break;
+		}
+		/* allow a slow card 1 ms per block on top of the usual */
+		if (get_timer(0) - start > MAX_RETRY_MS + data->blocks) {
+			printf("%s: timedout waiting for transfer!\n",
+			       __func__);
+			mmc_reset_controller_fsm(mmc_base, SYSCTL_SRD);
+			ret = TIMEOUT;
+			break;
+		}
+	} while (!(mmc_stat & TC_MASK));
+
+	writel(mmc_stat, &mmc_base->stat);
+
+	if (data->flags & MMC_DATA_READ)
+		invalidate_dcache_range((ulong)data->dest,
+					(ulong)data->dest + size);
+
+	return ret;
+}
+#endif
+
 static int mmc_send_cmd(struct mmc *mmc, struct mmc_cmd *cmd,
 			struct mmc_data *data)
 {
-	struct hsmmc *mmc_base = (struct hsmmc *)mmc->priv;
+	struct omap_hsmmc_data *priv = (struct omap_hsmmc_data *)mmc->priv;
+	struct hsmmc *mmc_base = priv->base_addr;
 	unsigned int flags, mmc_stat;
 	ulong start;
 
@@ -333,6 +465,12 @@ static int mmc_send_cmd(struct mmc *mmc, struct mmc_cmd *cmd,
 			flags |= (DP_DATA | DDIR_READ);
 		else
 			flags |= (DP_DATA | DDIR_WRITE);
+
+#ifdef CONFIG_OMAP_HSMMC_DMA
+		if (priv->transfer_mode == OMAP_HSMMC_DMA &&
+		    !omap_hsmmc_adma_prepare(mmc_base, data))
+			flags |= DE_ENABLE;
+#endif
 	}
 
 	writel(cmd->cmdarg, &mmc_base->arg);
@@ -368,6 +506,11 @@ static int mmc_send_cmd(struct mmc *mmc, struct mmc_cmd *cmd,
 		}
 	}
 
+#ifdef CONFIG_OMAP_HSMMC_DMA
+	if (data && (flags & DE_ENABLE))
+		return omap_hsmmc_adma_wait(mmc_base, data);
+#endif
+
 	if (data && (data->flags & MMC_DATA_READ)) {
 		mmc_read_data(mmc_base,	data->dest,
 				data->blocksize * data->blocks);
@@ -489,7 +632,8 @@ static int mmc_write_data(struct hsmmc *mmc_base, const char *buf,
 
 static void mmc_set_ios(struct mmc *mmc)
 {
-	struct hsmmc *mmc_base = (struct hsmmc *)mmc->priv;
+	struct omap_hsmmc_data *priv = (struct omap_hsmmc_data *)mmc->priv;
+	struct hsmmc *mmc_base = priv->base_addr;
 	unsigned int dsor = 0;
 	ulong start;
 
@@ -516,6 +660,13 @@ static void mmc_set_ios(struct mmc *mmc)
 		break;
 	}
 
+#ifdef CONFIG_OMAP_HSMMC_DDR
+	if (mmc->timing == MMC_TIMING_MMC_DDR52)
+		writel(readl(&mmc_base->con) | DDR_ENABLE, &mmc_base->con);
+	else
+		writel(readl(&mmc_base->con) & ~DDR_ENABLE, &mmc_base->con);
+#endif
+
 	/* configure clock with 96Mhz system clock.
 	 */
 	if (mmc->clock != 0) {
@@ -540,11 +691,19 @@ static void mmc_set_ios(struct mmc *mmc)
 	writel(readl(&mmc_base->sysctl) | CEN_ENABLE, &mmc_base->sysctl);
 }
 
-int omap_mmc_init(int dev_index, uint host_caps_mask, uint f_max)
+int omap_mmc_init(int dev_index, uint host_caps_mask, uint f_max,
+		  int transfer_mode)
 {
+	struct omap_hsmmc_data *priv;
 	struct mmc *mmc;
 
+	if (dev_index < 0 || dev_index >= ARRAY_SIZE(hsmmc_dev))
+		return 1;
+
 	mmc = &hsmmc_dev[dev_index];
+	priv = &hsmmc_dev_data[dev_index];
+	mmc->priv = priv;
+	priv->transfer_mode = transfer_mode;
 
 	sprintf(mmc->name, "OMAP SD/MMC");
 	mmc->send_cmd = mmc_send_cmd;
@@ -554,25 +713,29 @@ int omap_mmc_init(int dev_index, uint host_caps_mask, uint f_max)
 
 	switch (dev_index) {
 	case 0:
-		mmc->priv = (struct hsmmc *)OMAP_HSMMC1_BASE;
+		priv->base_addr = (struct hsmmc *)OMAP_HSMMC1_BASE;
 		break;
 #ifdef OMAP_HSMMC2_BASE
 	case 1:
-		mmc->priv = (struct hsmmc *)OMAP_HSMMC2_BASE;
+		priv->base_addr = (struct hsmmc *)OMAP_HSMMC2_BASE;
 		break;
 #endif
 #ifdef OMAP_HSMMC3_BASE
 	case 2:
-		mmc->priv = (struct hsmmc *)OMAP_HSMMC3_BASE;
+		priv->base_addr = (struct hsmmc *)OMAP_HSMMC3_BASE;
 		break;
 #endif
 	default:
-		mmc->priv = (struct hsmmc *)OMAP_HSMMC1_BASE;
+		priv->base_addr = (struct hsmmc *)OMAP_HSMMC1_BASE;
 		return 1;
 	}
 	mmc->voltages = MMC_VDD_32_33 | MMC_VDD_33_34 | MMC_VDD_165_195;
 	mmc->host_caps = (MMC_MODE_4BIT | MMC_MODE_HS_52MHz | MMC_MODE_HS |
 				MMC_MODE_HC) & ~host_caps_mask;
+#ifdef CONFIG_OMAP_HSMMC_DDR
+	/* The controller can latch data on both clock edges (eMMC DDR52) */
+	mmc->host_caps |= MMC_MODE_DDR_52MHz & ~host_caps_mask;
+#endif
 
 	mmc->f_min = 400000;
 
@@ -597,6 +760,10 @@ int omap_mmc_init(int dev_index, uint host_caps_mask, uint f_max)
 	if ((get_cpu_family() == CPU_OMAP34XX) && (get_cpu_rev() <= CPU_3XX_ES21))
 		mmc->b_max = 1;
 #endif
+#ifdef CONFIG_OMAP_HSMMC_DMA
+	if (transfer_mode == OMAP_HSMMC_DMA && !mmc->b_max)
+		mmc->b_max = ADMA_MAX_DESC * ADMA_MAX_LEN / MMCSD_SECTOR_SIZE;
+#endif
 
 	mmc_register(mmc);
 
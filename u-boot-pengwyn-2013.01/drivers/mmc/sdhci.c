@@ -256,6 +256,7 @@ static int sdhci_set_clock(struct mmc *mmc, unsigned int clock)
 	unsigned int div, clk, timeout;
 
 	sdhci_writew(host, 0, SDHCI_CLOCK_CONTROL);
+	host->clock = 0;
 
 	if (clock == 0)
 		return 0;
@@ -302,6 +303,7 @@ static int sdhci_set_clock(struct mmc *mmc, unsigned int clock)
 
 	clk |= SDHCI_CLOCK_CARD_EN;
 	sdhci_writew(host, clk, SDHCI_CLOCK_CONTROL);
+	host->clock = clock;
 	return 0;
 }
 
@@ -335,15 +337,63 @@ static void sdhci_set_power(struct sdhci_host *host, unsigned short power)
 	sdhci_writeb(host, pwr, SDHCI_POWER_CONTROL);
 }
 
+/*
+ * Program the UHS mode select field for the bus timing chosen by the
+ * core.  The eMMC DDR52 and HS200 timings reuse the DDR50 and SDR104
+ * encodings.  The card clock must be off while the field changes, so
+ * this returns 1 when it had to stop it, 0 when nothing changed.
+ */
+static int sdhci_set_uhs_timing(struct sdhci_host *host, uint timing)
+{
+	u16 ctrl2, uhs;
+
+	switch (timing) {
+	case MMC_TIMING_MMC_HS:
+	case MMC_TIMING_SD_HS:
+		uhs = SDHCI_CTRL_UHS_SDR25;
+		break;
+	case MMC_TIMING_UHS_SDR50:
+		uhs = SDHCI_CTRL_UHS_SDR50;
+		break;
+	case MMC_TIMING_UHS_SDR104:
+	case MMC_TIMING_MMC_HS200:
+		uhs = SDHCI_CTRL_UHS_SDR104;
+		break;
+	case MMC_TIMING_UHS_DDR50:
+	case MMC_TIMING_MMC_DDR52:
+		uhs = SDHCI_CTRL_UHS_DDR50;
+		break;
+	default:
+		uhs = SDHCI_CTRL_UHS_SDR12;
+		break;
+	}
+
+	ctrl2 = sdhci_readw(host, SDHCI_HOST_CONTROL2);
+	if ((ctrl2 & SDHCI_CTRL_UHS_MASK) == uhs)
+		return 0;
+
+	sdhci_writew(host, sdhci_readw(host, SDHCI_CLOCK_CONTROL) &
+		     ~SDHCI_CLOCK_CARD_EN, SDHCI_CLOCK_CONTROL);
+	ctrl2 = (ctrl2 & ~SDHCI_CTRL_UHS_MASK) | uhs;
+	sdhci_writew(host, ctrl2, SDHCI_HOST_CONTROL2);
+
+	return 1;
+}
+
 void sdhci_set_ios(struct mmc *mmc)
 {
 	u32 ctrl;
+	int timing_changed = 0;
 	struct sdhci_host *host = (struct sdhci_host *)mmc->priv;
 
 	if (host->set_control_reg)
 		host->set_control_reg(host);
 
-	if (mmc->clock != host->clock)
+	if ((host->version & SDHCI_SPEC_VER_MASK) >= SDHCI_SPEC_300)
+		timing_changed = sdhci_set_uhs_timing(host, mmc->timing);
+
+	/* A timing change left the card clock off, turn it back on */
+	if (mmc->clock != host->clock || timing_changed)
 		sdhci_set_clock(mmc, mmc->clock);
 
 	/* Set bus width */
@@ -372,6 +422,131 @@ void sdhci_set_ios(struct mmc *mmc)
 	sdhci_writeb(host, ctrl, SDHCI_HOST_CONTROL);
 }
 
+/*
+ * Switch the I/O lines to 1.8V or back to 3.3V.  For an SD card this is
+ * the second half of the CMD11 voltage switch: the card holds DAT[3:0]
+ * low once it accepted the command, and releases them after the clock
+ * is restarted at 1.8V.  An eMMC has no such handshake, its I/O simply
+ * follows the host.
+ */
+static int sdhci_set_signal_voltage(struct mmc *mmc, uint voltage)
+{
+	struct sdhci_host *host = (struct sdhci_host *)mmc->priv;
+	u16 ctrl2, clk;
+
+	ctrl2 = sdhci_readw(host, SDHCI_HOST_CONTROL2);
+	if (voltage == MMC_SIGNAL_VOLTAGE_330) {
+		sdhci_writew(host, ctrl2 & ~SDHCI_CTRL_VDD_180,
+			     SDHCI_HOST_CONTROL2);
+		udelay(5000);
+		return 0;
+	}
+
+	if (!IS_SD(mmc)) {
+		sdhci_writew(host, ctrl2 | SDHCI_CTRL_VDD_180,
+			     SDHCI_HOST_CONTROL2);
+		udelay(5000);
+		if (!(sdhci_readw(host, SDHCI_HOST_CONTROL2) &
+		      SDHCI_CTRL_VDD_180))
+			return -1;
+		return 0;
+	}
+
+	clk = sdhci_readw(host, SDHCI_CLOCK_CONTROL);
+	sdhci_writew(host, clk & ~SDHCI_CLOCK_CARD_EN, SDHCI_CLOCK_CONTROL);
+	/* the card clock is left off on failure, have set_ios restart it */
+	host->clock = 0;
+
+	if (sdhci_readl(host, SDHCI_PRESENT_STATE) & SDHCI_DATA_LVL_MASK)
+		return -1;
+
+	sdhci_writew(host, ctrl2 | SDHCI_CTRL_VDD_180, SDHCI_HOST_CONTROL2);
+	udelay(5000);
+
+	/* The regulator behind the 1.8V enable did not follow */
+	if (!(sdhci_readw(host, SDHCI_HOST_CONTROL2) & SDHCI_CTRL_VDD_180))
+		return -1;
+
+	sdhci_writew(host, clk | SDHCI_CLOCK_CARD_EN, SDHCI_CLOCK_CONTROL);
+	host->clock = mmc->clock;
+	udelay(1000);
+
+	if ((sdhci_readl(host, SDHCI_PRESENT_STATE) & SDHCI_DATA_LVL_MASK) !=
+	    SDHCI_DATA_LVL_MASK)
+		return -1;
+
+	return 0;
+}
+
+/*
+ * Version 3.00 tuning: with Execute Tuning set, the controller moves
+ * its sampling point on each tuning block received, signals Buffer Read
+ * Ready for it and clears Execute Tuning when done.  The blocks never
+ * reach the buffer, so the generic command path cannot be used.
+ */
+static int sdhci_execute_tuning(struct mmc *mmc, uint opcode)
+{
+	struct sdhci_host *host = (struct sdhci_host *)mmc->priv;
+	unsigned int timeout;
+	u16 ctrl2, blksz;
+	u32 flags;
+	int i;
+
+	if (mmc->timing == MMC_TIMING_UHS_SDR50 &&
+	    !(sdhci_readl(host, SDHCI_CAPABILITIES_1) & SDHCI_USE_SDR50_TUNING))
+		return 0;
+
+	if (opcode == MMC_CMD_SEND_TUNING_BLOCK_HS200 && mmc->bus_width == 8)
+		blksz = 128;
+	else
+		blksz = 64;
+
+	flags = SDHCI_CMD_RESP_SHORT | SDHCI_CMD_CRC | SDHCI_CMD_INDEX |
+		SDHCI_CMD_DATA;
+
+	ctrl2 = sdhci_readw(host, SDHCI_HOST_CONTROL2);
+	ctrl2 &= ~SDHCI_CTRL_TUNED_CLK;
+	ctrl2 |= SDHCI_CTRL_EXEC_TUNING;
+	sdhci_writew(host, ctrl2, SDHCI_HOST_CONTROL2);
+
+	for (i = 0; i < SDHCI_MAX_TUNING_LOOP; i++) {
+		sdhci_writel(host, SDHCI_INT_ALL_MASK, SDHCI_INT_STATUS);
+		sdhci_writew(host, SDHCI_MAKE_BLKSZ(SDHCI_DEFAULT_BOUNDARY_ARG,
+				blksz), SDHCI_BLOCK_SIZE);
+		sdhci_writew(host, SDHCI_TRNS_READ, SDHCI_TRANSFER_MODE);
+		sdhci_writel(host, 0, SDHCI_ARGUMENT);
+		sdhci_writew(host, SDHCI_MAKE_CMD(opcode, flags), SDHCI_COMMAND);
+
+		/* Wait max 150 ms per block */
+		timeout = 150;
+		while (!(sdhci_readl(host, SDHCI_INT_STATUS) &
+			 SDHCI_INT_DATA_AVAIL)) {
+			if (timeout == 0)
+				break;
+			timeout--;
+			udelay(1000);
+		}
+
+		ctrl2 = sdhci_readw(host, SDHCI_HOST_CONTROL2);
+		if (!timeout || !(ctrl2 & SDHCI_CTRL_EXEC_TUNING))
+			break;
+	}
+
+	sdhci_writel(host, SDHCI_INT_ALL_MASK, SDHCI_INT_STATUS);
+
+	if ((ctrl2 & SDHCI_CTRL_EXEC_TUNING) ||
+	    !(ctrl2 & SDHCI_CTRL_TUNED_CLK)) {
+		printf("%s: tuning failed\n", mmc->name);
+		ctrl2 &= ~(SDHCI_CTRL_EXEC_TUNING | SDHCI_CTRL_TUNED_CLK);
+		sdhci_writew(host, ctrl2, SDHCI_HOST_CONTROL2);
+		sdhci_reset(host, SDHCI_RESET_CMD);
+		sdhci_reset(host, SDHCI_RESET_DATA);
+		return -1;
+	}
+
+	return 0;
+}
+
 int sdhci_init(struct mmc *mmc)
 {
 	struct sdhci_host *host = (struct sdhci_host *)mmc->priv;
@@ -409,7 +584,7 @@ int sdhci_init(struct mmc *mmc)
 int add_sdhci(struct sdhci_host *host, u32 max_clk, u32 min_clk)
 {
 	struct mmc *mmc;
-	unsigned int caps;
+	unsigned int caps, caps1;
 
 	mmc = malloc(sizeof(struct mmc));
 	if (!mmc) {
@@ -425,6 +600,10 @@ int add_sdhci(struct sdhci_host *host, u32 max_clk, u32 min_clk)
 	mmc->set_ios = sdhci_set_ios;
 	mmc->init = sdhci_init;
 	mmc->getcd = NULL;
+	mmc->set_signal_voltage = NULL;
+	mmc->execute_tuning = NULL;
+	mmc->timing = MMC_TIMING_LEGACY;
+	mmc->signal_voltage = MMC_SIGNAL_VOLTAGE_330;
 
 	caps = sdhci_readl(host, SDHCI_CAPABILITIES);
 #ifdef CONFIG_MMC_SDMA
@@ -475,7 +654,30 @@ int add_sdhci(struct sdhci_host *host, u32 max_clk, u32 min_clk)
 	if (host->host_caps)
 		mmc->host_caps |= host->host_caps;
 
+	/*
+	 * The modes beyond high-speed need board support (1.8V I/O rail,
+	 * signal routing), so they are only used when the board asks for
+	 * them in host_caps, and only those the controller implements.
+	 */
+	if ((host->version & SDHCI_SPEC_VER_MASK) >= SDHCI_SPEC_300) {
+		caps1 = sdhci_readl(host, SDHCI_CAPABILITIES_1);
+		if (!(caps1 & SDHCI_SUPPORT_SDR50))
+			mmc->host_caps &= ~MMC_MODE_UHS_SDR50;
+		if (!(caps1 & SDHCI_SUPPORT_SDR104))
+			mmc->host_caps &= ~(MMC_MODE_UHS_SDR104 |
+					    MMC_MODE_HS200);
+		if (!(caps1 & SDHCI_SUPPORT_DDR50))
+			mmc->host_caps &= ~(MMC_MODE_UHS_DDR50 |
+					    MMC_MODE_DDR_52MHz);
+
+		mmc->set_signal_voltage = sdhci_set_signal_voltage;
+		mmc->execute_tuning = sdhci_execute_tuning;
+	} else
+		mmc->host_caps &= ~(MMC_MODE_UHS | MMC_MODE_HS200 |
+				    MMC_MODE_DDR_52MHz);
+
 	sdhci_reset(host, SDHCI_RESET_ALL);
+	host->clock = 0;
 	mmc_register(mmc);
 
 	return 0;
@@ -32,7 +32,7 @@
 
 DECLARE_GLOBAL_DATA_PTR;
 
-static void mmc_load_image_raw(struct mmc *mmc)
+static int mmc_load_image_raw(struct mmc *mmc, unsigned long sector)
 {
 	u32 image_size_sectors, err;
 	const struct image_header *header;
@@ -41,9 +41,7 @@ static void mmc_load_image_raw(struct mmc *mmc)
 						sizeof(struct image_header));
 
 	/* read image header to find the image size & load address */
-	err = mmc->block_dev.block_read(0,
-			CONFIG_SYS_MMCSD_RAW_MODE_U_BOOT_SECTOR, 1,
-			(void *)header);
+	err = mmc->block_dev.block_read(0, sector, 1, (void *)header);
 
 	if (err <= 0)
 		goto end;
@@ -55,19 +53,49 @@ static void mmc_load_image_raw(struct mmc *mmc)
 				mmc->read_bl_len;
 
 	/* Read the header too to avoid extra memcpy */
-	err = mmc->block_dev.block_read(0,
-			CONFIG_SYS_MMCSD_RAW_MODE_U_BOOT_SECTOR,
-			image_size_sectors, (void *)spl_image.load_addr);
+	err = mmc->block_dev.block_read(0, sector, image_size_sectors,
+					(void *)spl_image.load_addr);
 
 end:
 	if (err <= 0) {
 		printf("spl: mmc blk read err - %d\n", err);
-		hang();
+		return -1;
+	}
+
+	return 0;
+}
+
+#if defined(CONFIG_SPL_OS_BOOT) && defined(CONFIG_SYS_MMCSD_RAW_MODE_KERNEL_SECTOR)
+/*
+ * Falcon mode: load the parameter image saved by 'spl export' / 'spl save'
+ * and the kernel, so that SPL can start Linux directly. Returns non-zero
+ * if either is missing, in which case U-Boot is loaded instead.
+ */
+static int mmc_load_image_raw_os(struct mmc *mmc)
+{
+	int err;
+
+	err = mmc->block_dev.block_read(0,
+			CONFIG_SYS_MMCSD_RAW_MODE_ARGS_SECTOR,
+			CONFIG_SYS_MMCSD_RAW_MODE_ARGS_SECTORS,
+			(void *)CONFIG_SYS_SPL_ARGS_ADDR);
+	if (err <= 0 || spl_check_os_args((void *)CONFIG_SYS_SPL_ARGS_ADDR)) {
+		puts("spl: no kernel parameters in mmc\n");
+		return -1;
+	}
+
+	err = mmc_load_image_raw(mmc, CONFIG_SYS_MMCSD_RAW_MODE_KERNEL_SECTOR);
+	if (err || spl_image.os != IH_OS_LINUX) {
+		puts("spl: no kernel image in mmc\n");
+		return -1;
 	}
+
+	return 0;
 }
+#endif
 
 #ifdef CONFIG_SPL_FAT_SUPPORT
-static void mmc_load_image_fat(struct mmc *mmc)
+static int mmc_load_image_fat(struct mmc *mmc, const char *filename)
 {
 	s32 err;
 	struct image_header *header;
@@ -75,30 +103,48 @@ static void mmc_load_image_fat(struct mmc *mmc)
 	header = (struct image_header *)(CONFIG_SYS_TEXT_BASE -
 						sizeof(struct image_header));
 
-	err = fat_register_device(&mmc->block_dev,
-				CONFIG_SYS_MMC_SD_FAT_BOOT_PARTITION);
-	if (err) {
-		printf("spl: fat register err - %d\n", err);
-		hang();
-	}
-
-	err = file_fat_read(CONFIG_SPL_FAT_LOAD_PAYLOAD_NAME,
-				(u8 *)header, sizeof(struct image_header));
+	err = file_fat_read(filename, (u8 *)header,
+				sizeof(struct image_header));
 	if (err <= 0)
 		goto end;
 
 	spl_parse_image_header(header);
 
-	err = file_fat_read(CONFIG_SPL_FAT_LOAD_PAYLOAD_NAME,
-				(u8 *)spl_image.load_addr, 0);
+	err = file_fat_read(filename, (u8 *)spl_image.load_addr, 0);
 
 end:
 	if (err <= 0) {
 		printf("spl: error reading image %s, err - %d\n",
-			CONFIG_SPL_FAT_LOAD_PAYLOAD_NAME, err);
-		hang();
+			filename, err);
+		return -1;
 	}
+
+	return 0;
 }
+
+#if defined(CONFIG_SPL_OS_BOOT) && defined(CONFIG_SPL_FAT_LOAD_KERNEL_NAME)
+static int mmc_load_image_fat_os(struct mmc *mmc)
+{
+	int err;
+
+	err = file_fat_read(CONFIG_SPL_FAT_LOAD_ARGS_NAME,
+			    (void *)CONFIG_SYS_SPL_ARGS_ADDR, 0);
+	if (err <= 0 || spl_check_os_args((void *)CONFIG_SYS_SPL_ARGS_ADDR)) {
+		printf("spl: no kernel parameters in %s\n",
+			CONFIG_SPL_FAT_LOAD_ARGS_NAME);
+		return -1;
+	}
+
+	err = mmc_load_image_fat(mmc, CONFIG_SPL_FAT_LOAD_KERNEL_NAME);
+	if (err || spl_image.os != IH_OS_LINUX) {
+		printf("spl: no kernel image in %s\n",
+			CONFIG_SPL_FAT_LOAD_KERNEL_NAME);
+		return -1;
+	}
+
+	return 0;
+}
+#endif
 #endif
 
 void spl_mmc_load_image(void)
@@ -123,14 +169,34 @@ void spl_mmc_load_image(void)
 	boot_mode = spl_boot_mode();
 	if (boot_mode == MMCSD_MODE_RAW) {
 		debug("boot mode - RAW\n");
-		mmc_load_image_raw(mmc);
+#if defined(CONFIG_SPL_OS_BOOT) && defined(CONFIG_SYS_MMCSD_RAW_MODE_KERNEL_SECTOR)
+		if (!spl_start_uboot() && !mmc_load_image_raw_os(mmc))
+			return;
+#endif
+		err = mmc_load_image_raw(mmc,
+					 CONFIG_SYS_MMCSD_RAW_MODE_U_BOOT_SECTOR);
 #ifdef CONFIG_SPL_FAT_SUPPORT
 	} else if (boot_mode == MMCSD_MODE_FAT) {
 		debug("boot mode - FAT\n");
-		mmc_load_image_fat(mmc);
+
+		err = fat_register_device(&mmc->block_dev,
+					CONFIG_SYS_MMC_SD_FAT_BOOT_PARTITION);
+		if (err) {
+			printf("spl: fat register err - %d\n", err);
+			hang();
+		}
+
+#if defined(CONFIG_SPL_OS_BOOT) && defined(CONFIG_SPL_FAT_LOAD_KERNEL_NAME)
+		if (!spl_start_uboot() && !mmc_load_image_fat_os(mmc))
+			return;
+#endif
+		err = mmc_load_image_fat(mmc, CONFIG_SPL_FAT_LOAD_PAYLOAD_NAME);
 #endif
 	} else {
 		puts("spl: wrong MMC boot mode\n");
 		hang();
 	}
+
+	if (err)
+		hang();
 }
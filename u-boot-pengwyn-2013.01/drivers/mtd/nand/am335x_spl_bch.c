@@ -35,6 +35,21 @@ static struct nand_chip nand_chip;
 					CONFIG_SYS_NAND_ECCSIZE)
 #define ECCTOTAL	(ECCSTEPS * CONFIG_SYS_NAND_ECCBYTES)
 
+/* Chip supports ONFI READ CACHE SEQUENTIAL/END (31h/3Fh) */
+static int nand_cache_read;
+
+/*
+ * Bad block state of the first CONFIG_SYS_NAND_SPL_BBT_BLOCKS blocks, two
+ * bits per block, so that the header and image loads (and the kernel and
+ * its arguments in falcon mode) check each block's marker only once.
+ */
+#ifndef CONFIG_SYS_NAND_SPL_BBT_BLOCKS
+#define CONFIG_SYS_NAND_SPL_BBT_BLOCKS	1024
+#endif
+
+static u8 nand_bbt_known[CONFIG_SYS_NAND_SPL_BBT_BLOCKS / 8];
+static u8 nand_bbt_bad[CONFIG_SYS_NAND_SPL_BBT_BLOCKS / 8];
+
 
 /*
  * NAND command for large page NAND devices (2k)
@@ -59,7 +74,8 @@ static int nand_command(int block, int page, uint32_t offs,
 	/* Begin command latch cycle */
 	hwctrl(&mtd, cmd, NAND_CTRL_CLE | NAND_CTRL_CHANGE);
 
-	if (cmd == NAND_CMD_RESET) {
+	if (cmd == NAND_CMD_RESET || cmd == NAND_CMD_READCACHESEQ ||
+	    cmd == NAND_CMD_READCACHEEND) {
 		hwctrl(&mtd, NAND_CMD_NONE, NAND_NCE | NAND_CTRL_CHANGE);
 		while (!this->dev_ready(&mtd))
 			;
@@ -75,15 +91,18 @@ static int nand_command(int block, int page, uint32_t offs,
 	hwctrl(&mtd, offs & 0xff,
 		       NAND_CTRL_ALE | NAND_CTRL_CHANGE); /* A[7:0] */
 	hwctrl(&mtd, (offs >> 8) & 0xff, NAND_CTRL_ALE); /* A[11:9] */
-	/* Row address */
-	hwctrl(&mtd, (page_addr & 0xff), NAND_CTRL_ALE); /* A[19:12] */
-	hwctrl(&mtd, ((page_addr >> 8) & 0xff),
-		       NAND_CTRL_ALE); /* A[27:20] */
+	/* Row address; RNDOUT only takes the column */
+	if (cmd != NAND_CMD_RNDOUT) {
+		hwctrl(&mtd, (page_addr & 0xff),
+			       NAND_CTRL_ALE); /* A[19:12] */
+		hwctrl(&mtd, ((page_addr >> 8) & 0xff),
+			       NAND_CTRL_ALE); /* A[27:20] */
 #ifdef CONFIG_SYS_NAND_5_ADDR_CYCLE
-	/* One more address cycle for devices > 128MiB */
-	hwctrl(&mtd, (page_addr >> 16) & 0x0f,
-		       NAND_CTRL_ALE); /* A[31:28] */
+		/* One more address cycle for devices > 128MiB */
+		hwctrl(&mtd, (page_addr >> 16) & 0x0f,
+			       NAND_CTRL_ALE); /* A[31:28] */
 #endif
+	}
 	hwctrl(&mtd, NAND_CMD_NONE, NAND_NCE | NAND_CTRL_CHANGE);
 
 	if (cmd == NAND_CMD_READ0) {
@@ -127,7 +146,57 @@ static int nand_is_bad_block(int block)
 	return 0;
 }
 
-static int nand_read_page(int block, int page, void *dst)
+static int nand_block_is_bad(int block)
+{
+	int bad, i = block / 8;
+	u8 bit = 1 << (block % 8);
+
+	if (block >= CONFIG_SYS_NAND_SPL_BBT_BLOCKS)
+		return nand_is_bad_block(block);
+
+	if (nand_bbt_known[i] & bit)
+		return !!(nand_bbt_bad[i] & bit);
+
+	bad = nand_is_bad_block(block);
+	nand_bbt_known[i] |= bit;
+	if (bad)
+		nand_bbt_bad[i] |= bit;
+
+	return bad;
+}
+
+/*
+ * Check the ONFI parameter page for READ CACHE support.  Only the first
+ * ten bytes (signature, revision, features, optional commands) are read.
+ */
+static int nand_onfi_read_cache(void)
+{
+	struct nand_chip *this = mtd.priv;
+	u8 p[10];
+	int i;
+
+	this->cmd_ctrl(&mtd, NAND_CMD_PARAM, NAND_CTRL_CLE | NAND_CTRL_CHANGE);
+	this->cmd_ctrl(&mtd, 0, NAND_CTRL_ALE | NAND_CTRL_CHANGE);
+	this->cmd_ctrl(&mtd, NAND_CMD_NONE, NAND_NCE | NAND_CTRL_CHANGE);
+	while (!this->dev_ready(&mtd))
+		;
+
+	/* the parameter page is transferred on the lower 8 bits */
+	for (i = 0; i < sizeof(p); i++) {
+		if (this->options & NAND_BUSWIDTH_16)
+			p[i] = readw(this->IO_ADDR_R) & 0xff;
+		else
+			p[i] = readb(this->IO_ADDR_R);
+	}
+
+	if (p[0] != 'O' || p[1] != 'N' || p[2] != 'F' || p[3] != 'I')
+		return 0;
+
+	return !!((p[8] | (p[9] << 8)) & ONFI_OPT_CMD_READ_CACHE);
+}
+
+/* Read and correct the page currently held in the chip's page register */
+static int nand_read_page_data(int block, int page, void *dst)
 {
 	struct nand_chip *this = mtd.priv;
 	u_char ecc_calc[ECCTOTAL];
@@ -142,8 +211,6 @@ static int nand_read_page(int block, int page, void *dst)
 	uint8_t *oob = &oob_data[0] + nand_ecc_pos[0];
 	uint32_t oob_pos = eccsize * eccsteps + nand_ecc_pos[0];
 
-	nand_command(block, page, 0, NAND_CMD_READ0);
-
 	for (i = 0; eccsteps; eccsteps--, i += eccbytes, p += eccsize) {
 		this->ecc.hwctl(&mtd, NAND_ECC_READ);
 		nand_command(block, page, data_pos, NAND_CMD_RNDOUT);
@@ -178,37 +245,72 @@ static int nand_read_page(int block, int page, void *dst)
 	return 0;
 }
 
+/*
+ * Read 'count' consecutive pages of one block.  With READ CACHE the chip
+ * loads the next page into its data register while the current one is
+ * transferred and corrected, hiding tR for all but the first page.
+ */
+static void nand_read_pages(int block, int page, int count, void *dst)
+{
+	int i;
+
+	nand_command(block, page, 0, NAND_CMD_READ0);
+	if (!nand_cache_read || count < 2) {
+		for (i = 0; i < count; i++) {
+			if (i)
+				nand_command(block, page + i, 0,
+					     NAND_CMD_READ0);
+			nand_read_page_data(block, page + i, dst);
+			dst += CONFIG_SYS_NAND_PAGE_SIZE;
+		}
+		return;
+	}
+
+	for (i = 0; i < count; i++) {
+		nand_command(block, page + i, 0, i == count - 1 ?
+			     NAND_CMD_READCACHEEND : NAND_CMD_READCACHESEQ);
+		nand_read_page_data(block, page + i, dst);
+		dst += CONFIG_SYS_NAND_PAGE_SIZE;
+	}
+}
+
 int nand_spl_load_image(uint32_t offs, unsigned int size, void *dst)
 {
-	unsigned int block, lastblock;
+	unsigned int block, pages, count;
 	unsigned int page;
+#ifdef CONFIG_SPL_NAND_STATS
+	ulong start = get_timer(0), ms, kbps;
+#endif
 
 	/*
 	 * offs has to be aligned to a page address!
 	 */
 	block = offs / CONFIG_SYS_NAND_BLOCK_SIZE;
-	lastblock = (offs + size - 1) / CONFIG_SYS_NAND_BLOCK_SIZE;
 	page = (offs % CONFIG_SYS_NAND_BLOCK_SIZE) / CONFIG_SYS_NAND_PAGE_SIZE;
+	pages = DIV_ROUND_UP(size, CONFIG_SYS_NAND_PAGE_SIZE);
 
-	while (block <= lastblock) {
-		if (!nand_is_bad_block(block)) {
-			/*
-			 * Skip bad blocks
-			 */
-			while (page < CONFIG_SYS_NAND_PAGE_COUNT) {
-				nand_read_page(block, page, dst);
-				dst += CONFIG_SYS_NAND_PAGE_SIZE;
-				page++;
-			}
-
-			page = 0;
-		} else {
-			lastblock++;
+	while (pages) {
+		/*
+		 * Skip bad blocks
+		 */
+		if (!nand_block_is_bad(block)) {
+			count = min(pages, CONFIG_SYS_NAND_PAGE_COUNT - page);
+			nand_read_pages(block, page, count, dst);
+			dst += count * CONFIG_SYS_NAND_PAGE_SIZE;
+			pages -= count;
 		}
 
+		page = 0;
 		block++;
 	}
 
+#ifdef CONFIG_SPL_NAND_STATS
+	ms = get_timer(start);
+	kbps = ms ? size / ms : 0;	/* bytes per ms = kB/s */
+	printf("NAND: %u KiB in %lu ms, %lu.%lu MB/s\n", size >> 10, ms,
+	       kbps / 1000, (kbps % 1000) / 100);
+#endif
+
 	return 0;
 }
 
@@ -228,6 +330,8 @@ void nand_init(void)
 
 	/* NAND chip may require reset after power-on */
 	nand_command(0, 0, 0, NAND_CMD_RESET);
+
+	nand_cache_read = nand_onfi_read_cache();
 }
 
 /* Unselect after operation */
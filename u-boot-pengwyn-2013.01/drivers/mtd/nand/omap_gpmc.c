@@ -74,6 +74,81 @@ int omap_spl_dev_ready(struct mtd_info *mtd)
 }
 #endif
 
+#ifdef CONFIG_NAND_OMAP_GPMC_PREFETCH
+#define PREFETCH_TIMEOUT	100000
+
+/*
+ * omap_nand_read_buf_pref - read data through the GPMC prefetch engine
+ *
+ * The engine runs the NAND read cycles on its own and queues the data in
+ * a 64 byte FIFO, which is drained here with 32-bit accesses instead of a
+ * byte (or halfword) PIO read per bus cycle.  The hardware ECC engine
+ * sees the same bus cycles, so this works with BCH as well.
+ */
+static void omap_nand_read_buf_pref(struct mtd_info *mtd, uint8_t *buf,
+				    int len)
+{
+	struct nand_chip *chip = mtd->priv;
+	int tail = len & 3;
+	int count, avail, timeout;
+	u32 val;
+
+	len -= tail;
+	while (len > 0) {
+		/* engine busy, should not happen: fall back to PIO */
+		if (readl(&gpmc_cfg->prefetch_control))
+			break;
+
+		count = min(len, PREFETCH_COUNT_MAX);
+		writel(count, &gpmc_cfg->prefetch_config2);
+		writel((cs << PREFETCH_CONFIG1_CS_SHIFT) | PREFETCH_ENABLE |
+		       PREFETCH_FIFOTHRESHOLD(PREFETCH_FIFOTHRESHOLD_MAX),
+		       &gpmc_cfg->prefetch_config1);
+		writel(PREFETCH_START, &gpmc_cfg->prefetch_control);
+
+		len -= count;
+		timeout = PREFETCH_TIMEOUT;
+		while (count > 0) {
+			avail = PREFETCH_STATUS_FIFO_CNT(
+				readl(&gpmc_cfg->prefetch_status)) & ~3;
+			if (!avail) {
+				if (!--timeout) {
+					printf("%s: prefetch timeout\n",
+					       __func__);
+					break;
+				}
+				continue;
+			}
+			timeout = PREFETCH_TIMEOUT;
+			if (avail > count)
+				avail = count;
+			count -= avail;
+			if (((ulong)buf & 3) == 0) {
+				for (; avail; avail -= 4, buf += 4)
+					*(u32 *)buf = readl(chip->IO_ADDR_R);
+			} else {
+				for (; avail; avail -= 4, buf += 4) {
+					val = readl(chip->IO_ADDR_R);
+					memcpy(buf, &val, 4);
+				}
+			}
+		}
+
+		writel(0, &gpmc_cfg->prefetch_control);
+		writel(0, &gpmc_cfg->prefetch_config1);
+		if (count)
+			return;
+	}
+
+	/* unaligned tail, or what the engine could not take */
+	len += tail;
+	if (chip->options & NAND_BUSWIDTH_16)
+		nand_read_buf16(mtd, buf, len);
+	else
+		nand_read_buf(mtd, buf, len);
+}
+#endif
+
 /*
  * omap_hwecc_init - Initialize the Hardware ECC for NAND flash in
  *                   GPMC controller
@@ -416,6 +491,21 @@ static void omap_fix_errors_bch(struct mtd_info *mtd, uint8_t *data,
 	}
 }
 
+/*
+ * omap_bch_erased - true if the ECC bytes read for a step are all 0xff,
+ * i.e. the step belongs to an erased page and must not be corrected
+ */
+static int omap_bch_erased(struct nand_chip *chip, uint8_t *read_ecc)
+{
+	int i;
+
+	for (i = 0; i < chip->ecc.bytes; i++)
+		if (read_ecc[i] != 0xff)
+			return 0;
+
+	return 1;
+}
+
 /*
  * omap_correct_data_bch - Compares the ecc read from nand spare area
  * with ECC registers values and corrects one bit error if it has occured
@@ -435,14 +525,8 @@ static int omap_correct_data_bch(struct mtd_info *mtd, uint8_t *dat,
 	uint8_t syndrome[28];
 	uint32_t error_count = 0;
 	uint32_t error_loc[8];
-	uint32_t i, ecc_flag;
-
-	ecc_flag = 0;
-	for (i = 0; i < chip->ecc.bytes; i++)
-		if (read_ecc[i] != 0xff)
-			ecc_flag = 1;
 
-	if (!ecc_flag)
+	if (omap_bch_erased(chip, read_ecc))
 		return 0;
 
 	elm_reset();
@@ -545,58 +629,85 @@ static void omap_enable_ecc_bch(struct mtd_info *mtd, int32_t mode)
  * @buf:	buffer to store read data
  * @page:	page number to read
  *
+ * Up to ELM_MAX_POLY ECC steps are handled per batch: as soon as the
+ * syndrome of a step is known it is handed to its own ELM polynomial set,
+ * and the ELM decodes it while the following steps are read from the
+ * chip.  The error locations are collected and applied once the batch
+ * has been read.
  */
 static int omap_read_page_bch(struct mtd_info *mtd, struct nand_chip *chip,
 				uint8_t *buf, int page)
 {
+	struct nand_bch_priv *bch = chip->priv;
 	int i, eccsize = chip->ecc.size;
 	int eccbytes = chip->ecc.bytes;
 	int eccsteps = chip->ecc.steps;
-	uint8_t *p = buf;
 	uint8_t *ecc_calc = chip->buffers->ecccalc;
-	uint8_t *ecc_code = chip->buffers->ecccode;
-	uint32_t *eccpos = chip->ecc.layout->eccpos;
-	uint8_t *oob = chip->oob_poi;
-	uint32_t data_pos;
+	uint8_t *oob = chip->oob_poi + chip->ecc.layout->eccpos[0];
+	uint8_t syndrome[28];
+	uint32_t error_count;
+	uint32_t error_loc[8];
 	uint32_t oob_pos;
+	int step, batch, n, started;
 
-	data_pos = 0;
 	/* oob area start */
 	oob_pos = (eccsize * eccsteps) + chip->ecc.layout->eccpos[0];
-	oob += chip->ecc.layout->eccpos[0];
-
-	for (i = 0; eccsteps; eccsteps--, i += eccbytes, p += eccsize,
-				oob += eccbytes) {
-		chip->ecc.hwctl(mtd, NAND_ECC_READ);
-		/* read data */
-		chip->cmdfunc(mtd, NAND_CMD_RNDOUT, data_pos, page);
-		chip->read_buf(mtd, p, eccsize);
-
-		/* read respective ecc from oob area */
-		chip->cmdfunc(mtd, NAND_CMD_RNDOUT, oob_pos, page);
-		chip->read_buf(mtd, oob, eccbytes);
-		/* read syndrome */
-		chip->ecc.calculate(mtd, p, &ecc_calc[i]);
-
-		data_pos += eccsize;
-		oob_pos += eccbytes;
-	}
 
-	for (i = 0; i < chip->ecc.total; i++)
-		ecc_code[i] = chip->oob_poi[eccpos[i]];
+	elm_reset();
+	elm_config((enum bch_level)(bch->type));
+
+	for (batch = 0; batch < eccsteps; batch += ELM_MAX_POLY) {
+		n = min(eccsteps - batch, ELM_MAX_POLY);
+		started = 0;
 
-	eccsteps = chip->ecc.steps;
-	p = buf;
+		for (step = batch; step < batch + n; step++) {
+			i = step * eccbytes;
 
-	for (i = 0 ; eccsteps; eccsteps--, i += eccbytes, p += eccsize) {
-		int stat;
+			chip->ecc.hwctl(mtd, NAND_ECC_READ);
+			/* read data */
+			chip->cmdfunc(mtd, NAND_CMD_RNDOUT, step * eccsize,
+				      page);
+			chip->read_buf(mtd, buf + step * eccsize, eccsize);
 
-		stat = chip->ecc.correct(mtd, p, &ecc_code[i], &ecc_calc[i]);
-		if (stat < 0)
-			mtd->ecc_stats.failed++;
-		else
-			mtd->ecc_stats.corrected += stat;
+			/* read respective ecc from oob area */
+			chip->cmdfunc(mtd, NAND_CMD_RNDOUT, oob_pos + i, page);
+			chip->read_buf(mtd, oob + i, eccbytes);
+			/* read syndrome */
+			chip->ecc.calculate(mtd, buf + step * eccsize,
+					    &ecc_calc[i]);
+
+			if (omap_bch_erased(chip, oob + i))
+				continue;
+
+			/*
+			 * while reading ECC result we read it in big endian.
+			 * Hence while loading to ELM we have rotate to get
+			 * the right endian.
+			 */
+			omap_rotate_ecc_bch(mtd, &ecc_calc[i], syndrome);
+			elm_start_syndrome(syndrome, bch->nibbles,
+					   step - batch);
+			started |= 1 << (step - batch);
+		}
+
+		for (step = batch; step < batch + n; step++) {
+			if (!(started & (1 << (step - batch))))
+				continue;
+
+			if (elm_get_result(step - batch, &error_count,
+					   error_loc) != 0) {
+				printf("ECC: uncorrectable.\n");
+				mtd->ecc_stats.failed++;
+				continue;
+			}
+
+			/* correct bch error */
+			if (error_count > 0)
+				omap_fix_errors_bch(mtd, buf + step * eccsize,
+						    error_count, error_loc);
+		}
 	}
+
 	return 0;
 }
 #endif /* CONFIG_AM33XX */
@@ -765,11 +876,17 @@ int board_nand_init(struct nand_chip *nand)
 #endif
 #endif
 
+#ifdef CONFIG_NAND_OMAP_GPMC_PREFETCH
+	nand->read_buf = omap_nand_read_buf_pref;
+#endif
+
 #ifdef CONFIG_SPL_BUILD
+#ifndef CONFIG_NAND_OMAP_GPMC_PREFETCH
 	if (nand->options & NAND_BUSWIDTH_16)
 		nand->read_buf = nand_read_buf16;
 	else
 		nand->read_buf = nand_read_buf;
+#endif
 	nand->dev_ready = omap_spl_dev_ready;
 #endif
 
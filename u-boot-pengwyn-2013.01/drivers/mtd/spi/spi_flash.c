@@ -23,10 +23,10 @@ static void spi_flash_addr(u32 addr, u8 *cmd)
 	cmd[3] = addr >> 0;
 }
 
-static int spi_flash_read_write(struct spi_slave *spi,
-				const u8 *cmd, size_t cmd_len,
-				const u8 *data_out, u8 *data_in,
-				size_t data_len)
+static int spi_flash_xfer(struct spi_slave *spi,
+			  const u8 *cmd, size_t cmd_len,
+			  const u8 *data_out, u8 *data_in,
+			  size_t data_len, unsigned long data_flags)
 {
 	unsigned long flags = SPI_XFER_BEGIN;
 	int ret;
@@ -39,7 +39,8 @@ static int spi_flash_read_write(struct spi_slave *spi,
 		debug("SF: Failed to send command (%zu bytes): %d\n",
 				cmd_len, ret);
 	} else if (data_len != 0) {
-		ret = spi_xfer(spi, data_len * 8, data_out, data_in, SPI_XFER_END);
+		ret = spi_xfer(spi, data_len * 8, data_out, data_in,
+			       SPI_XFER_END | data_flags);
 		if (ret)
 			debug("SF: Failed to transfer %zu bytes of data: %d\n",
 					data_len, ret);
@@ -48,6 +49,15 @@ static int spi_flash_read_write(struct spi_slave *spi,
 	return ret;
 }
 
+static int spi_flash_read_write(struct spi_slave *spi,
+				const u8 *cmd, size_t cmd_len,
+				const u8 *data_out, u8 *data_in,
+				size_t data_len)
+{
+	return spi_flash_xfer(spi, cmd, cmd_len, data_out, data_in,
+			      data_len, 0);
+}
+
 int spi_flash_cmd(struct spi_slave *spi, u8 cmd, void *response, size_t len)
 {
 	return spi_flash_cmd_read(spi, &cmd, 1, response, len);
@@ -138,13 +148,25 @@ int spi_flash_read_common(struct spi_flash *flash, const u8 *cmd,
 int spi_flash_cmd_read_fast(struct spi_flash *flash, u32 offset,
 		size_t len, void *data)
 {
+	struct spi_slave *spi = flash->spi;
 	u8 cmd[5];
+	int ret;
 
-	cmd[0] = CMD_READ_ARRAY_FAST;
+	/* 0x0b and the dual/quad output reads share the 5 byte header */
+	cmd[0] = flash->read_cmd;
 	spi_flash_addr(offset, cmd);
 	cmd[4] = 0x00;
 
-	return spi_flash_read_common(flash, cmd, sizeof(cmd), data, len);
+	ret = spi_claim_bus(spi);
+	if (ret) {
+		debug("SF: unable to claim SPI bus\n");
+		return ret;
+	}
+	ret = spi_flash_xfer(spi, cmd, sizeof(cmd), NULL, data, len,
+			     flash->read_flags);
+	spi_release_bus(spi);
+
+	return ret;
 }
 
 int spi_flash_cmd_poll_bit(struct spi_flash *flash, unsigned long timeout,
@@ -335,6 +357,76 @@ static const struct {
 };
 #define IDCODE_LEN (IDCODE_CONT_LEN + IDCODE_PART_LEN)
 
+/*
+ * Parts that take the dual (0x3b) and/or quad (0x6b) output fast read,
+ * by manufacturer and memory type ID. SPI_FLASH_RD_QE marks parts that
+ * only answer 0x6b once the non-volatile QE bit in status register 2
+ * is set; it is checked at probe time but never programmed here.
+ */
+#define SPI_FLASH_RD_DUAL	(1 << 0)
+#define SPI_FLASH_RD_QUAD	(1 << 1)
+#define SPI_FLASH_RD_QE		(1 << 2)
+
+static const struct {
+	const u8 idcode;
+	const u8 type;
+	const u8 caps;
+} spi_flash_read_caps[] = {
+	/* Spansion S25FL129P, S25FL128S/256S */
+	{ 0x01, 0x20, SPI_FLASH_RD_DUAL | SPI_FLASH_RD_QUAD | SPI_FLASH_RD_QE },
+	/* Numonyx/Micron N25Q */
+	{ 0x20, 0xba, SPI_FLASH_RD_DUAL | SPI_FLASH_RD_QUAD },
+	{ 0x20, 0xbb, SPI_FLASH_RD_DUAL | SPI_FLASH_RD_QUAD },
+	/* Winbond W25X */
+	{ 0xef, 0x30, SPI_FLASH_RD_DUAL },
+	/* Winbond W25Q */
+	{ 0xef, 0x40, SPI_FLASH_RD_DUAL | SPI_FLASH_RD_QUAD | SPI_FLASH_RD_QE },
+};
+
+/* Single wire receive only, unless the controller says otherwise */
+__weak unsigned int spi_get_rx_modes(struct spi_slave *slave)
+{
+	return 0;
+}
+
+/*
+ * Pick the widest array read that the part, the board wiring (the
+ * SPI_RX_* bits in spi_mode) and the controller all support.
+ */
+static void spi_flash_setup_read(struct spi_flash *flash, const u8 *idp,
+				 unsigned int spi_mode)
+{
+	unsigned int rx_modes = spi_mode & spi_get_rx_modes(flash->spi);
+	u8 caps = 0, sr2;
+	int i;
+
+	flash->read_cmd = CMD_READ_ARRAY_FAST;
+	flash->read_flags = 0;
+
+	for (i = 0; i < ARRAY_SIZE(spi_flash_read_caps); i++)
+		if (spi_flash_read_caps[i].idcode == idp[0] &&
+		    spi_flash_read_caps[i].type == idp[1])
+			caps = spi_flash_read_caps[i].caps;
+
+	if ((caps & SPI_FLASH_RD_QUAD) && (rx_modes & SPI_RX_QUAD)) {
+		if (!(caps & SPI_FLASH_RD_QE) ||
+		    (!spi_flash_cmd(flash->spi, CMD_READ_STATUS2, &sr2, 1) &&
+		     (sr2 & STATUS2_QE))) {
+			flash->read_cmd = CMD_READ_QUAD_OUTPUT_FAST;
+			flash->read_flags = SPI_XFER_QUAD;
+			return;
+		}
+		debug("SF: QE bit clear, not using quad output read\n");
+	}
+
+	/* quad wiring has IO0/IO1 as well */
+	if ((caps & SPI_FLASH_RD_DUAL) &&
+	    (rx_modes & (SPI_RX_DUAL | SPI_RX_QUAD))) {
+		flash->read_cmd = CMD_READ_DUAL_OUTPUT_FAST;
+		flash->read_flags = SPI_XFER_DUAL;
+	}
+}
+
 struct spi_flash *spi_flash_probe(unsigned int bus, unsigned int cs,
 		unsigned int max_hz, unsigned int spi_mode)
 {
@@ -343,7 +435,9 @@ struct spi_flash *spi_flash_probe(unsigned int bus, unsigned int cs,
 	int ret, i, shift;
 	u8 idcode[IDCODE_LEN], *idp;
 
-	spi = spi_setup_slave(bus, cs, max_hz, spi_mode);
+	/* the SPI_RX_* wiring bits are only for spi_flash_setup_read() */
+	spi = spi_setup_slave(bus, cs, max_hz,
+			      spi_mode & ~(SPI_RX_DUAL | SPI_RX_QUAD));
 	if (!spi) {
 		printf("SF: Failed to set up slave\n");
 		return NULL;
@@ -385,6 +479,9 @@ struct spi_flash *spi_flash_probe(unsigned int bus, unsigned int cs,
 		goto err_manufacturer_probe;
 	}
 
+	spi_flash_setup_read(flash, idp, spi_mode);
+	debug("SF: Array read command %02x\n", flash->read_cmd);
+
 	printf("SF: Detected %s with page size ", flash->name);
 	print_size(flash->sector_size, ", total ");
 	print_size(flash->size, "\n");
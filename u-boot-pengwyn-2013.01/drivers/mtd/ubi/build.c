@@ -453,36 +453,48 @@ static void uif_close(struct ubi_device *ubi)
  * This function returns zero in case of success and a negative error code in
  * case of failure.
  *
- * Note, currently this is the only method to attach UBI devices. Hopefully in
- * the future we'll have more scalable attaching methods and avoid full media
- * scanning. But even in this case scanning will be needed as a fall-back
- * attaching method if there are some on-flash table corruptions.
+ * With CONFIG_MTD_UBI_FASTMAP a fastmap written by Linux is tried first, full
+ * media scanning is still the fall-back if there is no usable fastmap.
  */
 static int attach_by_scanning(struct ubi_device *ubi)
 {
 	int err;
 	struct ubi_scan_info *si;
+	unsigned long start = get_timer(0);
 
+#ifdef CONFIG_MTD_UBI_FASTMAP
+	si = ubi_scan_fastmap(ubi);
+	if (!si)
+		si = ubi_scan(ubi);
+#else
 	si = ubi_scan(ubi);
+#endif
 	if (IS_ERR(si))
 		return PTR_ERR(si);
+	ubi->scan_ms = get_timer(start);
 
 	ubi->bad_peb_count = si->bad_peb_count;
 	ubi->good_peb_count = ubi->peb_count - ubi->bad_peb_count;
 	ubi->max_ec = si->max_ec;
 	ubi->mean_ec = si->mean_ec;
 
+	start = get_timer(0);
 	err = ubi_read_volume_table(ubi, si);
 	if (err)
 		goto out_si;
+	ubi->vtbl_ms = get_timer(start);
 
+	start = get_timer(0);
 	err = ubi_eba_init_scan(ubi, si);
 	if (err)
 		goto out_wl;
+	ubi->eba_ms = get_timer(start);
 
+	start = get_timer(0);
 	err = ubi_wl_init_scan(ubi, si);
 	if (err)
 		goto out_vtbl;
+	ubi->wl_ms = get_timer(start);
 
 	ubi_scan_destroy_si(si);
 	return 0;
@@ -864,6 +876,9 @@ out_free:
 	vfree(ubi->peb_buf2);
 #ifdef CONFIG_MTD_UBI_DEBUG
 	vfree(ubi->dbg_peb_buf);
+#endif
+#ifdef CONFIG_MTD_UBI_FASTMAP
+	kfree(ubi->fm_state);
 #endif
 	kfree(ubi);
 	return err;
@@ -927,6 +942,9 @@ int ubi_detach_mtd_dev(int ubi_num, int anyway)
 	vfree(ubi->peb_buf2);
 #ifdef CONFIG_MTD_UBI_DEBUG
 	vfree(ubi->dbg_peb_buf);
+#endif
+#ifdef CONFIG_MTD_UBI_FASTMAP
+	kfree(ubi->fm_state);
 #endif
 	ubi_msg("mtd%d is detached from ubi%d", ubi->mtd->index, ubi->ubi_num);
 	kfree(ubi);
@@ -0,0 +1,625 @@
+/*
+ * UBI fastmap attaching
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * Linux can keep a snapshot of the UBI attach information, the fastmap, in a
+ * few PEBs near the start of the device. Attaching from it only needs the
+ * fastmap itself plus the headers of the PEBs in the two pools Linux may have
+ * handed out since the fastmap was written, instead of the headers of every
+ * PEB on the device.
+ *
+ * The fastmap is only read here, never written. Linux does not look beyond
+ * the pools when attaching from a fastmap, so before U-Boot changes any other
+ * PEB the fastmap anchor is erased (see ubi_fastmap_check_write()) and Linux
+ * falls back to scanning on its next attach.
+ */
+
+#include <ubi_uboot.h>
+#include "ubi.h"
+
+/* The fastmap is unusable, attach by scanning instead */
+#define UBI_BAD_FASTMAP 1
+
+/* What the fastmap says about a PEB, one entry per PEB */
+enum {
+	FM_PEB_UNKNOWN = 0,
+	FM_PEB_FREE,
+	FM_PEB_USED,
+	FM_PEB_SCRUB,
+	FM_PEB_ERASE,
+	FM_PEB_POOL,
+	FM_PEB_FASTMAP,
+	FM_PEB_MAPPED,
+};
+
+static int fm_add_to_list(struct list_head *list, int pnum, int ec)
+{
+	struct ubi_scan_leb *seb;
+
+	seb = kzalloc(sizeof(struct ubi_scan_leb), GFP_KERNEL);
+	if (!seb)
+		return -ENOMEM;
+
+	seb->pnum = pnum;
+	seb->ec = ec;
+	list_add_tail(&seb->u.list, list);
+	return 0;
+}
+
+/*
+ * Add a volume as described by its fastmap volume header. Static volumes keep
+ * used_ebs and the size of the last LEB, dynamic ones get zeroes just like
+ * their VID headers carry, so that pool PEBs added later by
+ * ubi_scan_add_used() pass validate_vid_hdr().
+ */
+static struct ubi_scan_volume *fm_add_volume(struct ubi_scan_info *si,
+					     const struct ubi_fm_volhdr *fmvh)
+{
+	struct ubi_scan_volume *sv;
+	struct rb_node **p = &si->volumes.rb_node, *parent = NULL;
+	int vol_id = be32_to_cpu(fmvh->vol_id);
+
+	while (*p) {
+		parent = *p;
+		sv = rb_entry(parent, struct ubi_scan_volume, rb);
+
+		/* Each volume may only be listed once */
+		if (vol_id == sv->vol_id)
+			return NULL;
+
+		if (vol_id > sv->vol_id)
+			p = &(*p)->rb_left;
+		else
+			p = &(*p)->rb_right;
+	}
+
+	sv = kzalloc(sizeof(struct ubi_scan_volume), GFP_KERNEL);
+	if (!sv)
+		return ERR_PTR(-ENOMEM);
+
+	sv->vol_id = vol_id;
+	sv->root = RB_ROOT;
+	sv->vol_type = fmvh->vol_type;
+	sv->data_pad = be32_to_cpu(fmvh->data_pad);
+	if (vol_id == UBI_LAYOUT_VOLUME_ID)
+		sv->compat = UBI_LAYOUT_VOLUME_COMPAT;
+	if (sv->vol_type == UBI_STATIC_VOLUME) {
+		sv->used_ebs = be32_to_cpu(fmvh->used_ebs);
+		sv->last_data_size = be32_to_cpu(fmvh->last_eb_bytes);
+	}
+	if (vol_id > si->highest_vol_id)
+		si->highest_vol_id = vol_id;
+
+	rb_link_node(&sv->rb, parent, p);
+	rb_insert_color(&sv->rb, &si->volumes);
+	si->vols_found += 1;
+	dbg_bld("added volume %d from fastmap", vol_id);
+	return sv;
+}
+
+static int fm_add_leb(struct ubi_scan_volume *sv, int lnum, int pnum, int ec,
+		      int scrub)
+{
+	struct ubi_scan_leb *seb, *tmp;
+	struct rb_node **p = &sv->root.rb_node, *parent = NULL;
+
+	while (*p) {
+		parent = *p;
+		tmp = rb_entry(parent, struct ubi_scan_leb, u.rb);
+		if (lnum < tmp->lnum)
+			p = &(*p)->rb_left;
+		else
+			p = &(*p)->rb_right;
+	}
+
+	seb = kzalloc(sizeof(struct ubi_scan_leb), GFP_KERNEL);
+	if (!seb)
+		return -ENOMEM;
+
+	/*
+	 * The sequence number stays zero, any copy of this LEB found in the
+	 * pools was written after the fastmap and is therefore newer.
+	 */
+	seb->pnum = pnum;
+	seb->lnum = lnum;
+	seb->ec = ec;
+	seb->scrub = scrub;
+
+	if (sv->highest_lnum <= lnum)
+		sv->highest_lnum = lnum;
+	sv->leb_count += 1;
+	rb_link_node(&seb->u.rb, parent, p);
+	rb_insert_color(&seb->u.rb, &sv->root);
+	return 0;
+}
+
+/*
+ * Look for the fastmap anchor, the super block PEB with the highest sequence
+ * number within the first %UBI_FM_MAX_START PEBs. Only the VID headers are
+ * read, unreadable PEBs are simply skipped. Returns the PEB number or -1.
+ */
+static int fm_find_anchor(struct ubi_device *ubi, struct ubi_vid_hdr *vh)
+{
+	unsigned long long sqnum, max_sqnum = 0;
+	int pnum, err, anchor = -1;
+
+	for (pnum = 0; pnum < UBI_FM_MAX_START && pnum < ubi->peb_count;
+	     pnum++) {
+		if (ubi_io_is_bad(ubi, pnum))
+			continue;
+
+		err = ubi_io_read_vid_hdr(ubi, pnum, vh, 0);
+		if (err && err != UBI_IO_BITFLIPS)
+			continue;
+		if (be32_to_cpu(vh->vol_id) != UBI_FM_SB_VOLUME_ID)
+			continue;
+
+		sqnum = be64_to_cpu(vh->sqnum);
+		if (anchor < 0 || sqnum > max_sqnum) {
+			max_sqnum = sqnum;
+			anchor = pnum;
+		}
+	}
+
+	return anchor;
+}
+
+/*
+ * Scan one PEB of a fastmap pool. Its contents may have changed in any way
+ * since the fastmap was written, as long as it still belongs to a known
+ * volume.
+ */
+static int fm_scan_pool_peb(struct ubi_device *ubi, struct ubi_scan_info *si,
+			    int pnum, int *ec, struct ubi_ec_hdr *ech,
+			    struct ubi_vid_hdr *vh)
+{
+	int err, bitflips = 0;
+
+	err = ubi_io_is_bad(ubi, pnum);
+	if (err)
+		return err < 0 ? err : UBI_BAD_FASTMAP;
+
+	err = ubi_io_read_ec_hdr(ubi, pnum, ech, 0);
+	if (err == UBI_IO_BITFLIPS)
+		bitflips = 1;
+	else if (err)
+		return UBI_BAD_FASTMAP;
+
+	*ec = be64_to_cpu(ech->ec);
+	if (*ec < 0 || *ec > UBI_MAX_ERASECOUNTER)
+		return UBI_BAD_FASTMAP;
+
+	err = ubi_io_read_vid_hdr(ubi, pnum, vh, 0);
+	if (err == UBI_IO_PEB_FREE)
+		return fm_add_to_list(&si->free, pnum, *ec);
+	if (err == UBI_IO_BITFLIPS)
+		bitflips = 1;
+	else if (err)
+		return UBI_BAD_FASTMAP;
+
+	if (!ubi_scan_find_sv(si, be32_to_cpu(vh->vol_id)))
+		return UBI_BAD_FASTMAP;
+
+	return ubi_scan_add_used(ubi, si, pnum, *ec, vh, bitflips);
+}
+
+/*
+ * Build the scanning information from the fastmap data in @fm. @state and
+ * @ecs already describe the fastmap PEBs. Returns zero, %UBI_BAD_FASTMAP if
+ * the fastmap does not describe this device or a negative error code.
+ */
+static int fm_attach(struct ubi_device *ubi, struct ubi_scan_info *si,
+		     void *fm, int fm_size, unsigned char *state, int *ecs,
+		     struct ubi_ec_hdr *ech, struct ubi_vid_hdr *vh)
+{
+	static const unsigned char list_state[] = {
+		FM_PEB_FREE, FM_PEB_USED, FM_PEB_SCRUB, FM_PEB_ERASE,
+	};
+	struct ubi_fm_hdr *fmhdr;
+	struct ubi_fm_scan_pool *fmpl[2];
+	struct ubi_fm_ec *fmec;
+	struct ubi_fm_volhdr *fmvh;
+	struct ubi_fm_eba *fmeba;
+	struct ubi_scan_volume *sv;
+	int count[ARRAY_SIZE(list_state)];
+	int i, j, n, pnum, ec, vol_count, err = 0;
+	int pos = sizeof(struct ubi_fm_sb);
+
+	fmhdr = fm + pos;
+	pos += sizeof(struct ubi_fm_hdr);
+	if (pos > fm_size || be32_to_cpu(fmhdr->magic) != UBI_FM_HDR_MAGIC)
+		return UBI_BAD_FASTMAP;
+
+	for (i = 0; i < 2; i++) {
+		fmpl[i] = fm + pos;
+		pos += sizeof(struct ubi_fm_scan_pool);
+		if (pos > fm_size ||
+		    be32_to_cpu(fmpl[i]->magic) != UBI_FM_POOL_MAGIC ||
+		    be16_to_cpu(fmpl[i]->size) > UBI_FM_MAX_POOL_SIZE)
+			return UBI_BAD_FASTMAP;
+	}
+
+	count[0] = be32_to_cpu(fmhdr->free_peb_count);
+	count[1] = be32_to_cpu(fmhdr->used_peb_count);
+	count[2] = be32_to_cpu(fmhdr->scrub_peb_count);
+	count[3] = be32_to_cpu(fmhdr->erase_peb_count);
+	vol_count = be32_to_cpu(fmhdr->vol_count);
+	if (vol_count < 0 || vol_count > UBI_MAX_VOLUMES + UBI_INT_VOL_COUNT)
+		return UBI_BAD_FASTMAP;
+
+	/* The free, used, scrub and erase lists, in this order */
+	for (i = 0; i < ARRAY_SIZE(list_state); i++) {
+		if (count[i] < 0 || count[i] > ubi->peb_count)
+			return UBI_BAD_FASTMAP;
+
+		for (j = 0; j < count[i]; j++) {
+			fmec = fm + pos;
+			pos += sizeof(struct ubi_fm_ec);
+			if (pos > fm_size)
+				return UBI_BAD_FASTMAP;
+
+			pnum = be32_to_cpu(fmec->pnum);
+			ec = be32_to_cpu(fmec->ec);
+			if (pnum < 0 || pnum >= ubi->peb_count || state[pnum] ||
+			    ec < 0 || ec > UBI_MAX_ERASECOUNTER)
+				return UBI_BAD_FASTMAP;
+
+			state[pnum] = list_state[i];
+			ecs[pnum] = ec;
+		}
+	}
+
+	/*
+	 * Pool PEBs may also show up in the free or used lists, the pool scan
+	 * below has the final word on them.
+	 */
+	for (i = 0; i < 2; i++) {
+		for (j = 0; j < be16_to_cpu(fmpl[i]->size); j++) {
+			pnum = be32_to_cpu(fmpl[i]->pebs[j]);
+			if (pnum < 0 || pnum >= ubi->peb_count ||
+			    state[pnum] == FM_PEB_ERASE ||
+			    state[pnum] == FM_PEB_POOL ||
+			    state[pnum] == FM_PEB_FASTMAP)
+				return UBI_BAD_FASTMAP;
+
+			state[pnum] = FM_PEB_POOL;
+		}
+	}
+
+	/* One volume header and EBA table per volume */
+	for (i = 0; i < vol_count; i++) {
+		fmvh = fm + pos;
+		pos += sizeof(struct ubi_fm_volhdr);
+		if (pos > fm_size ||
+		    be32_to_cpu(fmvh->magic) != UBI_FM_VHDR_MAGIC ||
+		    (fmvh->vol_type != UBI_DYNAMIC_VOLUME &&
+		     fmvh->vol_type != UBI_STATIC_VOLUME))
+			return UBI_BAD_FASTMAP;
+
+		sv = fm_add_volume(si, fmvh);
+		if (!sv)
+			return UBI_BAD_FASTMAP;
+		if (IS_ERR(sv))
+			return PTR_ERR(sv);
+
+		fmeba = fm + pos;
+		pos += sizeof(struct ubi_fm_eba);
+		if (pos > fm_size ||
+		    be32_to_cpu(fmeba->magic) != UBI_FM_EBA_MAGIC)
+			return UBI_BAD_FASTMAP;
+
+		n = be32_to_cpu(fmeba->reserved_pebs);
+		if (n < 0 || n > ubi->peb_count)
+			return UBI_BAD_FASTMAP;
+		pos += n * sizeof(__be32);
+		if (pos > fm_size)
+			return UBI_BAD_FASTMAP;
+
+		for (j = 0; j < n; j++) {
+			pnum = be32_to_cpu(fmeba->pnum[j]);
+			if (pnum < 0)
+				continue;
+			if (pnum >= ubi->peb_count)
+				return UBI_BAD_FASTMAP;
+
+			switch (state[pnum]) {
+			case FM_PEB_USED:
+			case FM_PEB_SCRUB:
+				err = fm_add_leb(sv, j, pnum, ecs[pnum],
+						 state[pnum] == FM_PEB_SCRUB);
+				if (err)
+					return err;
+				state[pnum] = FM_PEB_MAPPED;
+				break;
+			case FM_PEB_POOL:
+				/* Whatever it holds now is found by the pool scan */
+				break;
+			default:
+				return UBI_BAD_FASTMAP;
+			}
+		}
+	}
+
+	for (i = 0; i < 2; i++) {
+		for (j = 0; j < be16_to_cpu(fmpl[i]->size); j++) {
+			pnum = be32_to_cpu(fmpl[i]->pebs[j]);
+			err = fm_scan_pool_peb(ubi, si, pnum, &ecs[pnum], ech,
+					       vh);
+			if (err)
+				return err;
+		}
+	}
+
+	/*
+	 * Every good PEB has to be accounted for by now, otherwise the fastmap
+	 * is older than the data on the flash.
+	 */
+	for (pnum = 0; pnum < ubi->peb_count; pnum++) {
+		err = 0;
+		switch (state[pnum]) {
+		case FM_PEB_UNKNOWN:
+			err = ubi_io_is_bad(ubi, pnum);
+			if (err < 0)
+				return err;
+			if (!err) {
+				dbg_bld("PEB %d is not in the fastmap", pnum);
+				return UBI_BAD_FASTMAP;
+			}
+			si->bad_peb_count += 1;
+			continue;
+		case FM_PEB_USED:
+		case FM_PEB_SCRUB:
+			dbg_bld("used PEB %d is not mapped", pnum);
+			return UBI_BAD_FASTMAP;
+		case FM_PEB_FREE:
+			err = fm_add_to_list(&si->free, pnum, ecs[pnum]);
+			break;
+		case FM_PEB_ERASE:
+			err = fm_add_to_list(&si->erase, pnum, ecs[pnum]);
+			break;
+		case FM_PEB_FASTMAP:
+			/*
+			 * Keep the fastmap PEBs away from wear-leveling just
+			 * like the PEBs of "preserve" internal volumes.
+			 */
+			err = fm_add_to_list(&si->alien, pnum, ecs[pnum]);
+			si->alien_peb_count += 1;
+			break;
+		}
+		if (err)
+			return err;
+
+		si->ec_sum += ecs[pnum];
+		si->ec_count += 1;
+		if (ecs[pnum] > si->max_ec)
+			si->max_ec = ecs[pnum];
+		if (ecs[pnum] < si->min_ec)
+			si->min_ec = ecs[pnum];
+	}
+
+	return 0;
+}
+
+/**
+ * ubi_scan_fastmap - build scanning information from a fastmap.
+ * @ubi: UBI device description object
+ *
+ * This function returns the scanning information in case of success, %NULL
+ * if there is no usable fastmap and the device has to be scanned, and an
+ * error pointer in case of failure.
+ */
+struct ubi_scan_info *ubi_scan_fastmap(struct ubi_device *ubi)
+{
+	struct ubi_scan_info *si;
+	struct ubi_ec_hdr *ech = NULL;
+	struct ubi_vid_hdr *vh = NULL;
+	struct ubi_fm_sb *fmsb = NULL;
+	unsigned char *state = NULL;
+	int *ecs = NULL;
+	void *fm = NULL;
+	int i, err, pnum, anchor = -1, used_blocks, fm_size;
+	unsigned long long sqnum;
+	uint32_t crc;
+
+	ubi->fm_attached = 0;
+	ubi->fm_anchor = -1;
+
+	si = kzalloc(sizeof(struct ubi_scan_info), GFP_KERNEL);
+	if (!si)
+		return ERR_PTR(-ENOMEM);
+
+	INIT_LIST_HEAD(&si->corr);
+	INIT_LIST_HEAD(&si->free);
+	INIT_LIST_HEAD(&si->erase);
+	INIT_LIST_HEAD(&si->alien);
+	si->volumes = RB_ROOT;
+	si->min_ec = UBI_MAX_ERASECOUNTER;
+
+	err = -ENOMEM;
+	ech = kzalloc(ubi->ec_hdr_alsize, GFP_KERNEL);
+	vh = ubi_zalloc_vid_hdr(ubi, GFP_KERNEL);
+	fmsb = kmalloc(sizeof(struct ubi_fm_sb), GFP_KERNEL);
+	state = kzalloc(ubi->peb_count, GFP_KERNEL);
+	ecs = kmalloc(ubi->peb_count * sizeof(int), GFP_KERNEL);
+	if (!ech || !vh || !fmsb || !state || !ecs)
+		goto out;
+
+	err = UBI_BAD_FASTMAP;
+	anchor = fm_find_anchor(ubi, vh);
+	if (anchor < 0) {
+		dbg_bld("no fastmap found");
+		goto out;
+	}
+
+	err = ubi_io_read(ubi, fmsb, anchor, ubi->leb_start,
+			  sizeof(struct ubi_fm_sb));
+	if (err && err != UBI_IO_BITFLIPS)
+		goto bad;
+	used_blocks = be32_to_cpu(fmsb->used_blocks);
+	if (be32_to_cpu(fmsb->magic) != UBI_FM_SB_MAGIC ||
+	    fmsb->version != UBI_FM_FMT_VERSION ||
+	    used_blocks < 1 || used_blocks > UBI_FM_MAX_BLOCKS)
+		goto bad;
+
+	fm_size = ubi->leb_size * used_blocks;
+	fm = vmalloc(fm_size);
+	if (!fm) {
+		err = -ENOMEM;
+		goto out;
+	}
+
+	si->max_sqnum = be64_to_cpu(fmsb->sqnum);
+	for (i = 0; i < used_blocks; i++) {
+		pnum = be32_to_cpu(fmsb->block_loc[i]);
+		if (pnum < 0 || pnum >= ubi->peb_count || state[pnum] ||
+		    (i == 0 && pnum != anchor))
+			goto bad;
+
+		err = ubi_io_read_ec_hdr(ubi, pnum, ech, 0);
+		if (err && err != UBI_IO_BITFLIPS)
+			goto bad;
+		ecs[pnum] = be64_to_cpu(ech->ec);
+		if (ecs[pnum] < 0 || ecs[pnum] > UBI_MAX_ERASECOUNTER)
+			goto bad;
+
+		err = ubi_io_read_vid_hdr(ubi, pnum, vh, 0);
+		if (err && err != UBI_IO_BITFLIPS)
+			goto bad;
+		if (be32_to_cpu(vh->vol_id) != (i ? UBI_FM_DATA_VOLUME_ID :
+						   UBI_FM_SB_VOLUME_ID))
+			goto bad;
+		sqnum = be64_to_cpu(vh->sqnum);
+		if (sqnum > si->max_sqnum)
+			si->max_sqnum = sqnum;
+
+		err = ubi_io_read(ubi, fm + i * ubi->leb_size, pnum,
+				  ubi->leb_start, ubi->leb_size);
+		if (err && err != UBI_IO_BITFLIPS)
+			goto bad;
+
+		state[pnum] = FM_PEB_FASTMAP;
+	}
+
+	/* The CRC covers all fastmap blocks with the CRC field zeroed */
+	crc = be32_to_cpu(((struct ubi_fm_sb *)fm)->data_crc);
+	((struct ubi_fm_sb *)fm)->data_crc = 0;
+	if (crc32(UBI_CRC32_INIT, fm, fm_size) != crc) {
+		dbg_bld("bad fastmap data CRC");
+		goto bad;
+	}
+
+	err = fm_attach(ubi, si, fm, fm_size, state, ecs, ech, vh);
+	if (err)
+		goto out;
+
+	if (si->ec_count) {
+		do_div(si->ec_sum, si->ec_count);
+		si->mean_ec = si->ec_sum;
+	}
+
+	ubi->fm_attached = 1;
+	ubi->fm_anchor = anchor;
+	ubi->fm_anchor_ec = ecs[anchor];
+	ubi->fm_state = state;
+	state = NULL;
+	ubi_msg("attaching from fastmap at PEB %d", anchor);
+	goto out;
+
+bad:
+	err = UBI_BAD_FASTMAP;
+out:
+	vfree(fm);
+	kfree(ecs);
+	kfree(state);
+	kfree(fmsb);
+	if (vh)
+		ubi_free_vid_hdr(ubi, vh);
+	kfree(ech);
+	if (err) {
+		ubi_scan_destroy_si(si);
+		if (err < 0)
+			return ERR_PTR(err);
+		if (anchor >= 0)
+			ubi_warn("fastmap at PEB %d is unusable, scanning",
+				 anchor);
+		return NULL;
+	}
+	return si;
+}
+
+/**
+ * ubi_fastmap_check_write - invalidate the fastmap before a PEB changes.
+ * @ubi: UBI device description object
+ * @pnum: physical eraseblock about to be written or erased
+ * @hdr_only: if @pnum is erased or only its EC header is written
+ *
+ * Linux trusts the fastmap for every PEB outside of the pools. PEBs on the
+ * fastmap erase list may also be erased and get a new EC header, Linux erases
+ * them again anyway. Before anything else is changed the fastmap anchor is
+ * erased, after which Linux attaches by scanning and deletes the remaining
+ * fastmap PEBs itself. Returns zero if @pnum may be changed and a negative
+ * error code otherwise, in which case the device is switched to read-only
+ * mode.
+ */
+int ubi_fastmap_check_write(struct ubi_device *ubi, int pnum, int hdr_only)
+{
+	struct ubi_ec_hdr *ech;
+	int err, anchor = ubi->fm_anchor;
+
+	if (anchor < 0)
+		return 0;
+	if (ubi->fm_state[pnum] == FM_PEB_POOL ||
+	    (ubi->fm_state[pnum] == FM_PEB_ERASE && hdr_only))
+		return 0;
+
+	ech = kzalloc(ubi->ec_hdr_alsize, GFP_KERNEL);
+	if (!ech)
+		return -ENOMEM;
+
+	ubi_msg("invalidating fastmap at PEB %d before changing PEB %d",
+		anchor, pnum);
+
+	/* Also keeps the erase and EC header write below from coming back */
+	ubi->fm_anchor = -1;
+	err = ubi_io_sync_erase(ubi, anchor, 0);
+	if (err < 0) {
+		/*
+		 * The fastmap may still be valid, nothing must be written.
+		 * Do not pass %-EIO on, it would get @pnum marked bad.
+		 */
+		ubi_err("cannot erase fastmap anchor, error %d", err);
+		ubi_ro_mode(ubi);
+		kfree(ech);
+		return -EROFS;
+	}
+
+	ech->ec = cpu_to_be64(ubi->fm_anchor_ec + 1);
+	err = ubi_io_write_ec_hdr(ubi, anchor, ech);
+	if (err)
+		ubi_warn("cannot write EC header to PEB %d, error %d",
+			 anchor, err);
+
+	kfree(ubi->fm_state);
+	ubi->fm_state = NULL;
+	kfree(ech);
+	return 0;
+}
@@ -236,6 +236,13 @@ int ubi_io_write(struct ubi_device *ubi, const void *buf, int pnum, int offset,
 		return -EROFS;
 	}
 
+#ifdef CONFIG_MTD_UBI_FASTMAP
+	err = ubi_fastmap_check_write(ubi, pnum,
+				      offset < ubi->vid_hdr_aloffset);
+	if (err)
+		return err;
+#endif
+
 	/* The below has to be compiled out if paranoid checks are disabled */
 
 	err = paranoid_check_not_bad(ubi, pnum);
@@ -486,6 +493,12 @@ int ubi_io_sync_erase(struct ubi_device *ubi, int pnum, int torture)
 		return -EROFS;
 	}
 
+#ifdef CONFIG_MTD_UBI_FASTMAP
+	err = ubi_fastmap_check_write(ubi, pnum, 1);
+	if (err)
+		return err;
+#endif
+
 	if (torture) {
 		ret = torture_peb(ubi, pnum);
 		if (ret < 0)
@@ -996,6 +1009,73 @@ int ubi_io_read_vid_hdr(struct ubi_device *ubi, int pnum,
 	return read_err ? UBI_IO_BITFLIPS : 0;
 }
 
+/**
+ * ubi_io_read_hdrs - read both headers of a physical eraseblock at once.
+ * @ubi: UBI device description object
+ * @pnum: physical eraseblock number to read from
+ * @buf: buffer of @ubi->vid_hdr_aloffset + @ubi->vid_hdr_alsize bytes
+ * @ec_hdr: the erase counter header is stored here
+ * @vid_hdr: the volume identifier header is stored here
+ *
+ * This is a fast path for scanning. Both headers are fetched with a single
+ * flash read, which is one NAND page when the VID header shares a sub-page
+ * aligned page with the EC header and a single multi-page read otherwise,
+ * instead of separate reads in 'ubi_io_read_ec_hdr()' and
+ * 'ubi_io_read_vid_hdr()'.
+ *
+ * This function returns zero if both headers are intact and
+ * %UBI_IO_PEB_FREE if the EC header is intact and there is no VID header.
+ * Anything suspicious, like bit-flips, read errors, bad magic or CRC,
+ * results in %-EAGAIN. The caller then has to read the headers with
+ * 'ubi_io_read_ec_hdr()' and 'ubi_io_read_vid_hdr()', which sort such
+ * physical eraseblocks out and report real errors.
+ */
+int ubi_io_read_hdrs(struct ubi_device *ubi, int pnum, void *buf,
+		     struct ubi_ec_hdr *ec_hdr, struct ubi_vid_hdr *vid_hdr)
+{
+	int err;
+	struct ubi_ec_hdr *ech = buf;
+	struct ubi_vid_hdr *vh = buf + ubi->vid_hdr_offset;
+
+	dbg_io("read EC and VID headers from PEB %d", pnum);
+	ubi_assert(pnum >= 0 && pnum < ubi->peb_count);
+
+	err = ubi_io_read(ubi, buf, pnum, 0,
+			  ubi->vid_hdr_aloffset + ubi->vid_hdr_alsize);
+	if (err)
+		return -EAGAIN;
+
+	if (be32_to_cpu(ech->magic) != UBI_EC_HDR_MAGIC ||
+	    be32_to_cpu(ech->hdr_crc) !=
+			crc32(UBI_CRC32_INIT, ech, UBI_EC_HDR_SIZE_CRC) ||
+	    validate_ec_hdr(ubi, ech))
+		return -EAGAIN;
+	memcpy(ec_hdr, ech, UBI_EC_HDR_SIZE);
+
+	if (be32_to_cpu(vh->magic) != UBI_VID_HDR_MAGIC) {
+		if (!check_pattern(vh, 0xFF, UBI_VID_HDR_SIZE))
+			return -EAGAIN;
+
+		/*
+		 * The below is just a paranoid check, it has to be compiled
+		 * out if paranoid checks are disabled.
+		 */
+		err = paranoid_check_all_ff(ubi, pnum, ubi->leb_start,
+					    ubi->leb_size);
+		if (err)
+			return -EAGAIN;
+		return UBI_IO_PEB_FREE;
+	}
+
+	if (be32_to_cpu(vh->hdr_crc) !=
+			crc32(UBI_CRC32_INIT, vh, UBI_VID_HDR_SIZE_CRC) ||
+	    validate_vid_hdr(ubi, vh))
+		return -EAGAIN;
+	memcpy(vid_hdr, vh, UBI_VID_HDR_SIZE);
+
+	return 0;
+}
+
 /**
  * ubi_io_write_vid_hdr - write a volume identifier header.
  * @ubi: UBI device description object
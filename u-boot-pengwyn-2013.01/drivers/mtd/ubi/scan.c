@@ -58,6 +58,7 @@ static int paranoid_check_si(struct ubi_device *ubi, struct ubi_scan_info *si);
 /* Temporary variables used during scanning */
 static struct ubi_ec_hdr *ech;
 static struct ubi_vid_hdr *vidh;
+static void *hdrs_buf;
 
 /**
  * add_to_list - add physical eraseblock to a list.
@@ -758,7 +759,7 @@ struct ubi_scan_leb *ubi_scan_get_free_peb(struct ubi_device *ubi,
 static int process_eb(struct ubi_device *ubi, struct ubi_scan_info *si, int pnum)
 {
 	long long uninitialized_var(ec);
-	int err, bitflips = 0, vol_id, ec_corr = 0;
+	int err, hdrs, bitflips = 0, vol_id, ec_corr = 0;
 
 	dbg_bld("scan PEB %d", pnum);
 
@@ -775,7 +776,18 @@ static int process_eb(struct ubi_device *ubi, struct ubi_scan_info *si, int pnum
 		return 0;
 	}
 
-	err = ubi_io_read_ec_hdr(ubi, pnum, ech, 0);
+	/*
+	 * Most PEBs have intact headers, so try to read both at once and only
+	 * look at them one by one if something is odd.
+	 */
+	hdrs = ubi_io_read_hdrs(ubi, pnum, hdrs_buf, ech, vidh);
+	if (hdrs == -EAGAIN) {
+		ubi->scan_slow_pebs += 1;
+		err = ubi_io_read_ec_hdr(ubi, pnum, ech, 0);
+	} else {
+		ubi->scan_fast_pebs += 1;
+		err = 0;
+	}
 	if (err < 0)
 		return err;
 	else if (err == UBI_IO_BITFLIPS)
@@ -821,7 +833,10 @@ static int process_eb(struct ubi_device *ubi, struct ubi_scan_info *si, int pnum
 
 	/* OK, we've done with the EC header, let's look at the VID header */
 
-	err = ubi_io_read_vid_hdr(ubi, pnum, vidh, 0);
+	if (hdrs == -EAGAIN)
+		err = ubi_io_read_vid_hdr(ubi, pnum, vidh, 0);
+	else
+		err = hdrs;
 	if (err < 0)
 		return err;
 	else if (err == UBI_IO_BITFLIPS)
@@ -931,6 +946,12 @@ struct ubi_scan_info *ubi_scan(struct ubi_device *ubi)
 	if (!vidh)
 		goto out_ech;
 
+	hdrs_buf = kmalloc(ubi->vid_hdr_aloffset + ubi->vid_hdr_alsize,
+			   GFP_KERNEL);
+	if (!hdrs_buf)
+		goto out_vidh;
+
+	ubi->scan_fast_pebs = ubi->scan_slow_pebs = 0;
 	for (pnum = 0; pnum < ubi->peb_count; pnum++) {
 		cond_resched();
 
@@ -981,12 +1002,14 @@ struct ubi_scan_info *ubi_scan(struct ubi_device *ubi)
 		goto out_vidh;
 	}
 
+	kfree(hdrs_buf);
 	ubi_free_vid_hdr(ubi, vidh);
 	kfree(ech);
 
 	return si;
 
 out_vidh:
+	kfree(hdrs_buf);
 	ubi_free_vid_hdr(ubi, vidh);
 out_ech:
 	kfree(ech);
@@ -162,4 +162,8 @@ int ubi_scan_erase_peb(struct ubi_device *ubi, const struct ubi_scan_info *si,
 struct ubi_scan_info *ubi_scan(struct ubi_device *ubi);
 void ubi_scan_destroy_si(struct ubi_scan_info *si);
 
+#ifdef CONFIG_MTD_UBI_FASTMAP
+struct ubi_scan_info *ubi_scan_fastmap(struct ubi_device *ubi);
+#endif
+
 #endif /* !__UBI_SCAN_H__ */
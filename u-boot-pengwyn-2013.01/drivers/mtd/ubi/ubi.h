@@ -342,6 +342,18 @@ struct ubi_wl_entry;
  * @buf_mutex: proptects @peb_buf1 and @peb_buf2
  * @dbg_peb_buf: buffer of PEB size used for debugging
  * @dbg_buf_mutex: proptects @dbg_peb_buf
+ *
+ * @scan_fast_pebs: PEBs whose headers were read at once while scanning
+ * @scan_slow_pebs: PEBs whose headers had to be read one by one
+ * @scan_ms: time taken by scanning or fastmap attaching, in milliseconds
+ * @vtbl_ms: time taken by reading the volume table
+ * @eba_ms: time taken by EBA unit initialization
+ * @wl_ms: time taken by WL unit initialization
+ *
+ * @fm_attached: if the device was attached from a fastmap
+ * @fm_anchor: fastmap anchor PEB the device was attached from, %-1 if none
+ * @fm_anchor_ec: erase counter of @fm_anchor
+ * @fm_state: what the fastmap says about each PEB
  */
 struct ubi_device {
 	struct cdev cdev;
@@ -424,6 +436,19 @@ struct ubi_device {
 	void *dbg_peb_buf;
 	struct mutex dbg_buf_mutex;
 #endif
+
+	int scan_fast_pebs;
+	int scan_slow_pebs;
+	unsigned long scan_ms;
+	unsigned long vtbl_ms;
+	unsigned long eba_ms;
+	unsigned long wl_ms;
+#ifdef CONFIG_MTD_UBI_FASTMAP
+	int fm_attached;
+	int fm_anchor;
+	int fm_anchor_ec;
+	unsigned char *fm_state;
+#endif
 };
 
 extern struct kmem_cache *ubi_wl_entry_slab;
@@ -518,6 +543,13 @@ int ubi_io_read_vid_hdr(struct ubi_device *ubi, int pnum,
 			struct ubi_vid_hdr *vid_hdr, int verbose);
 int ubi_io_write_vid_hdr(struct ubi_device *ubi, int pnum,
 			 struct ubi_vid_hdr *vid_hdr);
+int ubi_io_read_hdrs(struct ubi_device *ubi, int pnum, void *buf,
+		     struct ubi_ec_hdr *ec_hdr, struct ubi_vid_hdr *vid_hdr);
+
+/* fastmap.c */
+#ifdef CONFIG_MTD_UBI_FASTMAP
+int ubi_fastmap_check_write(struct ubi_device *ubi, int pnum, int hdr_only);
+#endif
 
 /* build.c */
 int ubi_attach_mtd_dev(struct mtd_info *mtd, int ubi_num, int vid_hdr_offset);
@@ -28,7 +28,8 @@
 #define BITMASK(bits)		(BIT(bits) - 1)
 #define PHY_REG_MASK		0x1f
 #define PHY_ID_MASK		0x1f
-#define NUM_DESCS		(PKTBUFSRX * 2)
+#define CPSW_TX_BUFS		8
+#define NUM_DESCS		(PKTBUFSRX + CPSW_TX_BUFS)
 #define PKT_MIN			60
 #define PKT_MAX			(1500 + 14 + 4 + 4)
 #define CLEAR_BIT		1
@@ -57,6 +58,9 @@
 #define CPDMA_DESC_EOP		BIT(30)
 #define CPDMA_DESC_OWNER	BIT(29)
 #define CPDMA_DESC_EOQ		BIT(28)
+#define CPDMA_DESC_OVERRUN	BIT(22)
+#define CPDMA_DESC_PKT_ERR	(BIT(21) | BIT(20))
+#define CPDMA_DESC_LEN_MASK	0x7ff
 
 /*
  * This timeout definition is a worst-case ultra defensive measure against
@@ -66,6 +70,18 @@
 #define MDIO_TIMEOUT            100 /* msecs */
 #define CPDMA_TIMEOUT		100 /* msecs */
 
+/*
+ * Reading the PHYs costs several MDIO round trips, so the link state is
+ * only refreshed this often while packets are flowing.
+ */
+#define CPSW_LINK_POLL_MS	1000
+
+/* Offsets into the statistics block at hw_stats_reg_ofs */
+#define CPSW_STAT_RXCRCERRORS	0x10
+#define CPSW_STAT_RXSOFOVERRUNS	0x84
+#define CPSW_STAT_RXMOFOVERRUNS	0x88
+#define CPSW_STAT_RXDMAOVERRUNS	0x8c
+
 struct cpsw_mdio_regs {
 	u32	version;
 	u32	control;
@@ -210,6 +226,18 @@ struct cpdma_chan {
 	for (slave = (priv)->slaves; slave != (priv)->slaves + \
 				(priv)->data.slaves; slave++)
 
+struct cpsw_stats {
+	ulong	rx_packets;
+	ulong	rx_batches;	/* polls that found at least one frame */
+	ulong	rx_max_batch;	/* most frames reaped by a single poll */
+	ulong	rx_ring_empty;	/* DMA ran out of receive descriptors */
+	ulong	rx_errors;	/* frames flagged bad in the descriptor */
+	ulong	rx_drops;	/* frames dropped by the switch (overruns) */
+	ulong	rx_crc_errors;
+	ulong	tx_packets;
+	ulong	tx_ring_full;	/* sends that had to wait for a buffer */
+};
+
 struct cpsw_priv {
 	struct eth_device		*dev;
 	struct cpsw_platform_data	data;
@@ -219,11 +247,20 @@ struct cpsw_priv {
 	void				*dma_regs;
 	struct cpsw_host_regs		*host_port_regs;
 	void				*ale_regs;
+	void				*hw_stats;
 
 	struct cpdma_desc		*descs;
 	struct cpdma_desc		*desc_free;
 	struct cpdma_chan		rx_chan, tx_chan;
 
+	void				*tx_bufs;
+	int				tx_next, tx_pending;
+
+	int				link;
+	ulong				link_check;
+
+	struct cpsw_stats		stats;
+
 	struct cpsw_slave		*slaves;
 	struct phy_device		*phydev;
 	struct mii_dev			*bus;
@@ -602,6 +639,16 @@ static int cpsw_update_link(struct cpsw_priv *priv)
 	return link;
 }
 
+static int cpsw_check_link(struct cpsw_priv *priv)
+{
+	if (get_timer(priv->link_check) >= CPSW_LINK_POLL_MS) {
+		priv->link = cpsw_update_link(priv);
+		priv->link_check = get_timer(0);
+	}
+
+	return priv->link;
+}
+
 static inline u32  cpsw_get_slave_port(struct cpsw_priv *priv, u32 slave_num)
 {
 	if (priv->host_port == 0)
@@ -650,8 +697,8 @@ static void cpdma_desc_free(struct cpsw_priv *priv, struct cpdma_desc *desc)
 	}
 }
 
-static int cpdma_submit(struct cpsw_priv *priv, struct cpdma_chan *chan,
-			void *buffer, int len)
+static int cpdma_queue(struct cpsw_priv *priv, struct cpdma_chan *chan,
+		       void *buffer, int len)
 {
 	struct cpdma_desc *desc, *prev;
 	u32 mode;
@@ -690,42 +737,91 @@ static int cpdma_submit(struct cpsw_priv *priv, struct cpdma_chan *chan,
 		chan_write(chan, hdp, desc);
 
 done:
-	if (chan->rxfree)
-		chan_write(chan, rxfree, 1);
 	return 0;
 }
 
-static int cpdma_process(struct cpsw_priv *priv, struct cpdma_chan *chan,
-			 void **buffer, int *len)
+static int cpdma_submit(struct cpsw_priv *priv, struct cpdma_chan *chan,
+			void *buffer, int len)
 {
-	struct cpdma_desc *desc = chan->head;
-	u32 status;
-
-	if (!desc)
-		return -ENOENT;
+	int ret;
 
-	status = desc_read(desc, hw_mode);
+	ret = cpdma_queue(priv, chan, buffer, len);
+	if (ret == 0 && chan->rxfree)
+		chan_write(chan, rxfree, 1);
+	return ret;
+}
 
-	if (len)
-		*len = status & 0x7ff;
+/*
+ * Take up to 'max' completed descriptors off the head of a channel and
+ * acknowledge them with a single completion pointer write.  Returns the
+ * number reaped; their buffers and hw_mode words are stored in
+ * 'buffer' and 'status'.
+ */
+static int cpdma_reap(struct cpsw_priv *priv, struct cpdma_chan *chan,
+		      void **buffer, u32 *status, int max)
+{
+	struct cpdma_desc *desc, *last = NULL;
+	u32 mode;
+	int n = 0;
 
-	if (buffer)
-		*buffer = desc_read_ptr(desc, sw_buffer);
+	while (n < max && (desc = chan->head) != NULL) {
+		mode = desc_read(desc, hw_mode);
 
-	if (status & CPDMA_DESC_OWNER) {
-		if (chan_read(chan, hdp) == 0) {
-			if (desc_read(desc, hw_mode) & CPDMA_DESC_OWNER)
-				chan_write(chan, hdp, desc);
+		if (mode & CPDMA_DESC_OWNER) {
+			if (chan_read(chan, hdp) == 0) {
+				if (desc_read(desc, hw_mode) & CPDMA_DESC_OWNER)
+					chan_write(chan, hdp, desc);
+			}
+			break;
 		}
 
-		return -EBUSY;
+		buffer[n] = desc_read_ptr(desc, sw_buffer);
+		status[n] = mode;
+		n++;
+
+		chan->head = desc_read_ptr(desc, hw_next);
+		cpdma_desc_free(priv, desc);
+		last = desc;
 	}
 
-	chan->head = desc_read_ptr(desc, hw_next);
-	chan_write(chan, cp, desc);
+	if (last)
+		chan_write(chan, cp, last);
 
-	cpdma_desc_free(priv, desc);
-	return 0;
+	return n;
+}
+
+static void cpsw_tx_reap(struct cpsw_priv *priv)
+{
+	void *buffer[CPSW_TX_BUFS];
+	u32 status[CPSW_TX_BUFS];
+
+	priv->tx_pending -= cpdma_reap(priv, &priv->tx_chan, buffer, status,
+				       CPSW_TX_BUFS);
+}
+
+/* Fold the switch's drop counters into ours; they are write-to-decrement */
+static void cpsw_update_hw_stats(struct cpsw_priv *priv)
+{
+	u32 val;
+
+	if (!priv->hw_stats)
+		return;
+
+	val = __raw_readl(priv->hw_stats + CPSW_STAT_RXCRCERRORS);
+	__raw_writel(val, priv->hw_stats + CPSW_STAT_RXCRCERRORS);
+	priv->stats.rx_crc_errors += val;
+
+	val = __raw_readl(priv->hw_stats + CPSW_STAT_RXSOFOVERRUNS);
+	__raw_writel(val, priv->hw_stats + CPSW_STAT_RXSOFOVERRUNS);
+	priv->stats.rx_drops += val;
+
+	val = __raw_readl(priv->hw_stats + CPSW_STAT_RXMOFOVERRUNS);
+	__raw_writel(val, priv->hw_stats + CPSW_STAT_RXMOFOVERRUNS);
+	priv->stats.rx_drops += val;
+
+	val = __raw_readl(priv->hw_stats + CPSW_STAT_RXDMAOVERRUNS);
+	__raw_writel(val, priv->hw_stats + CPSW_STAT_RXDMAOVERRUNS);
+	priv->stats.rx_drops += val;
 }
 
 static int cpsw_init(struct eth_device *dev, bd_t *bis)
@@ -749,8 +845,8 @@ static int cpsw_init(struct eth_device *dev, bd_t *bis)
 	/* disable priority elevation and enable statistics on all ports */
 	__raw_writel(0, &priv->regs->ptype);
 
-	/* enable statistics collection only on the host port */
-	__raw_writel(BIT(priv->host_port), &priv->regs->stat_port_en);
+	/* enable statistics collection on the host and slave ports */
+	__raw_writel(BITMASK(priv->data.slaves + 1), &priv->regs->stat_port_en);
 
 	cpsw_ale_port_state(priv, priv->host_port, ALE_PORT_STATE_FORWARD);
 
@@ -761,7 +857,8 @@ static int cpsw_init(struct eth_device *dev, bd_t *bis)
 	for_each_slave(slave, priv)
 		cpsw_slave_init(slave, priv);
 
-	cpsw_update_link(priv);
+	priv->link = cpsw_update_link(priv);
+	priv->link_check = get_timer(0);
 
 	/* init descriptor pool */
 	for (i = 0; i < NUM_DESCS; i++) {
@@ -769,6 +866,8 @@ static int cpsw_init(struct eth_device *dev, bd_t *bis)
 			   (i == (NUM_DESCS - 1)) ? 0 : &priv->descs[i+1]);
 	}
 	priv->desc_free = &priv->descs[0];
+	priv->tx_next = 0;
+	priv->tx_pending = 0;
 
 	/* initialize channels */
 	if (priv->data.version == CPSW_CTRL_VERSION_2) {
@@ -828,13 +927,14 @@ static int cpsw_init(struct eth_device *dev, bd_t *bis)
 
 	/* submit rx descs */
 	for (i = 0; i < PKTBUFSRX; i++) {
-		ret = cpdma_submit(priv, &priv->rx_chan, NetRxPackets[i],
-				   PKTSIZE);
+		ret = cpdma_queue(priv, &priv->rx_chan, NetRxPackets[i],
+				  PKTSIZE);
 		if (ret < 0) {
 			printf("error %d submitting rx desc\n", ret);
 			break;
 		}
 	}
+	chan_write(&priv->rx_chan, rxfree, i);
 
 	return 0;
 }
@@ -846,6 +946,9 @@ static void cpsw_halt(struct eth_device *dev)
 	writel(0, priv->dma_regs + CPDMA_TXCONTROL);
 	writel(0, priv->dma_regs + CPDMA_RXCONTROL);
 
+	/* the counters do not survive the reset below */
+	cpsw_update_hw_stats(priv);
+
 	/* soft reset the controller and initialize priv */
 	setbit_and_wait_for_clear32(&priv->regs->soft_reset);
 
@@ -859,42 +962,88 @@ static int cpsw_send(struct eth_device *dev, void *packet, int length)
 {
 	struct cpsw_priv	*priv = dev->priv;
 	void *buffer;
-	int len;
-	int timeout = CPDMA_TIMEOUT;
+	ulong start;
+	int ret;
 
-	if (!cpsw_update_link(priv))
+	if (!cpsw_check_link(priv))
 		return -EIO;
 
-	flush_dcache_range((unsigned long)packet,
-			   (unsigned long)packet + length);
-
-	/* first reap completed packets */
-	while (timeout-- &&
-		(cpdma_process(priv, &priv->tx_chan, &buffer, &len) >= 0))
-		;
-
-	if (timeout == -1) {
-		printf("cpdma_process timeout\n");
-		return -ETIMEDOUT;
+	/* reap what has completed since the last send */
+	cpsw_tx_reap(priv);
+
+	if (priv->tx_pending == CPSW_TX_BUFS) {
+		priv->stats.tx_ring_full++;
+		start = get_timer(0);
+		do {
+			if (get_timer(start) > CPDMA_TIMEOUT) {
+				printf("cpdma_process timeout\n");
+				return -ETIMEDOUT;
+			}
+			cpsw_tx_reap(priv);
+		} while (priv->tx_pending == CPSW_TX_BUFS);
 	}
 
-	return cpdma_submit(priv, &priv->tx_chan, packet, length);
+	/*
+	 * Copy the frame so the caller may reuse 'packet' right away; the
+	 * buffers complete in order, so the next one in line is free.
+	 */
+	buffer = priv->tx_bufs + priv->tx_next * PKTSIZE_ALIGN;
+	memcpy(buffer, packet, length);
+	flush_dcache_range((unsigned long)buffer,
+			   (unsigned long)buffer +
+			   ALIGN(length, ARCH_DMA_MINALIGN));
+
+	ret = cpdma_submit(priv, &priv->tx_chan, buffer, length);
+	if (ret < 0)
+		return ret;
+
+	priv->tx_next = (priv->tx_next + 1) % CPSW_TX_BUFS;
+	priv->tx_pending++;
+	priv->stats.tx_packets++;
+	return 0;
 }
 
 static int cpsw_recv(struct eth_device *dev)
 {
 	struct cpsw_priv	*priv = dev->priv;
-	void *buffer;
-	int len;
-
-	cpsw_update_link(priv);
+	void *buffer[PKTBUFSRX];
+	u32 status[PKTBUFSRX];
+	int i, n, ret, queued = 0;
+
+	cpsw_check_link(priv);
+
+	n = cpdma_reap(priv, &priv->rx_chan, buffer, status, PKTBUFSRX);
+	if (!n)
+		return 0;
+
+	priv->stats.rx_batches++;
+	if ((ulong)n > priv->stats.rx_max_batch)
+		priv->stats.rx_max_batch = n;
+
+	for (i = 0; i < n; i++) {
+		/* EOQ: no descriptor followed, the DMA stopped receiving */
+		if (status[i] & CPDMA_DESC_EOQ)
+			priv->stats.rx_ring_empty++;
+
+		if (status[i] & (CPDMA_DESC_OVERRUN | CPDMA_DESC_PKT_ERR)) {
+			priv->stats.rx_errors++;
+		} else {
+			invalidate_dcache_range((unsigned long)buffer[i],
+						(unsigned long)buffer[i] +
+						PKTSIZE_ALIGN);
+			priv->stats.rx_packets++;
+			NetReceive(buffer[i], status[i] & CPDMA_DESC_LEN_MASK);
+		}
 
-	while (cpdma_process(priv, &priv->rx_chan, &buffer, &len) >= 0) {
-		invalidate_dcache_range((unsigned long)buffer,
-					(unsigned long)buffer + PKTSIZE_ALIGN);
-		NetReceive(buffer, len);
-		cpdma_submit(priv, &priv->rx_chan, buffer, PKTSIZE);
+		/* give the buffer straight back, keeping the ring full */
+		ret = cpdma_queue(priv, &priv->rx_chan, buffer[i], PKTSIZE);
+		if (ret < 0) {
+			printf("error %d resubmitting rx desc\n", ret);
+			continue;
+		}
+		queued++;
 	}
+	chan_write(&priv->rx_chan, rxfree, queued);
 
 	return 0;
 }
@@ -958,12 +1107,23 @@ int cpsw_register(struct cpsw_platform_data *data)
 		return -ENOMEM;
 	}
 
+	priv->tx_bufs = memalign(ARCH_DMA_MINALIGN,
+				 CPSW_TX_BUFS * PKTSIZE_ALIGN);
+	if (!priv->tx_bufs) {
+		free(priv->slaves);
+		free(dev);
+		free(priv);
+		return -ENOMEM;
+	}
+
 	priv->descs		= (void *)CPDMA_RAM_ADDR;
 	priv->host_port		= data->host_port_num;
 	priv->regs		= regs;
 	priv->host_port_regs	= regs + data->host_port_reg_ofs;
 	priv->dma_regs		= regs + data->cpdma_reg_ofs;
 	priv->ale_regs		= regs + data->ale_reg_ofs;
+	if (data->hw_stats_reg_ofs)
+		priv->hw_stats	= regs + data->hw_stats_reg_ofs;
 
 	int idx = 0;
 
@@ -989,3 +1149,55 @@ int cpsw_register(struct cpsw_platform_data *data)
 
 	return 1;
 }
+
+#ifdef CONFIG_CMD_CPSW
+static void cpsw_print_stats(struct eth_device *dev)
+{
+	struct cpsw_priv *priv = dev->priv;
+	struct cpsw_stats *st = &priv->stats;
+
+	cpsw_update_hw_stats(priv);
+
+	printf("%s:\n"
+	       "    rx packets: %lu\n"
+	       "    rx batches: %lu (max %lu frames)\n"
+	       "    rx ring empty: %lu\n"
+	       "    rx errors: %lu\n"
+	       "    rx drops: %lu\n"
+	       "    rx crc errors: %lu\n"
+	       "    tx packets: %lu\n"
+	       "    tx ring full: %lu\n",
+	       dev->name, st->rx_packets, st->rx_batches, st->rx_max_batch,
+	       st->rx_ring_empty, st->rx_errors, st->rx_drops,
+	       st->rx_crc_errors, st->tx_packets, st->tx_ring_full);
+}
+
+static int do_cpsw(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
+{
+	struct eth_device *dev;
+	int i, found = 0;
+
+	if (argc != 2 || strcmp(argv[1], "stats"))
+		return CMD_RET_USAGE;
+
+	for (i = 0; (dev = eth_get_dev_by_index(i)) != NULL; i++) {
+		if (dev->init != cpsw_init)
+			continue;
+		cpsw_print_stats(dev);
+		found++;
+	}
+
+	if (!found) {
+		puts("no cpsw interface\n");
+		return 1;
+	}
+
+	return 0;
+}
+
+U_BOOT_CMD(
+	cpsw, 2, 0, do_cpsw,
+	"CPSW ethernet diagnostics",
+	"stats - show receive/transmit ring counters and drops"
+);
+#endif
@@ -38,7 +38,7 @@
 #include "omap3_spi.h"
 
 #define WORD_LEN	8
-#define SPI_WAIT_TIMEOUT 3000000;
+#define SPI_WAIT_TIMEOUT 3000000
 
 static void spi_reset(struct omap3_spi_slave *ds)
 {
@@ -269,47 +269,97 @@ int omap3_spi_write(struct spi_slave *slave, unsigned int len, const u8 *txp,
 	return 0;
 }
 
+/*
+ * Receive through the channel FIFO with turbo mode on, so the bus keeps
+ * clocking while earlier bytes wait to be picked up instead of pausing
+ * after every byte. WCNT stops the channel after exactly len bytes; it
+ * and the FIFO enable may only change while the channel is disabled,
+ * chip select stays asserted through FORCE meanwhile.
+ */
 int omap3_spi_read(struct spi_slave *slave, unsigned int len, u8 *rxp,
 		   unsigned long flags)
 {
 	struct omap3_spi_slave *ds = to_omap3_spi(slave);
-	int i;
+	struct mcspi_channel *chan = &ds->regs->channel[ds->slave.cs];
+	unsigned int i, n, chunk, stat;
 	int timeout = SPI_WAIT_TIMEOUT;
-	int chconf = readl(&ds->regs->channel[ds->slave.cs].chconf);
-
-	if (flags & SPI_XFER_BEGIN)
-		writel(OMAP3_MCSPI_CHCTRL_EN,
-		       &ds->regs->channel[ds->slave.cs].chctrl);
+	int chconf = readl(&chan->chconf);
 
 	chconf &= ~OMAP3_MCSPI_CHCONF_TRM_MASK;
 	chconf |= OMAP3_MCSPI_CHCONF_TRM_RX_ONLY;
 	chconf |= OMAP3_MCSPI_CHCONF_FORCE;
-	writel(chconf, &ds->regs->channel[ds->slave.cs].chconf);
 
-	writel(0, &ds->regs->channel[ds->slave.cs].tx);
+	/*
+	 * A command written without SPI_XFER_END may still be shifting
+	 * out; disabling the channel now would cut off its last bytes.
+	 */
+	if (readl(&chan->chctrl) & OMAP3_MCSPI_CHCTRL_EN) {
+		while (!(readl(&chan->chstat) & OMAP3_MCSPI_CHSTAT_TXS)) {
+			if (--timeout <= 0)
+				goto drain_timeout;
+		}
+		while (!(readl(&chan->chstat) & OMAP3_MCSPI_CHSTAT_EOT)) {
+			if (--timeout <= 0)
+				goto drain_timeout;
+		}
+		timeout = SPI_WAIT_TIMEOUT;
+	}
 
-	for (i = 0; i < len; i++) {
-		/* Wait till RX register contains data (RXS == 1) */
-		while (!(readl(&ds->regs->channel[ds->slave.cs].chstat) &
-			 OMAP3_MCSPI_CHSTAT_RXS)) {
-			if (--timeout <= 0) {
-				printf("SPI RXS timed out, status=0x%08x\n",
-				       readl(&ds->regs->channel[ds->slave.cs].chstat));
-				return -1;
+	while (len) {
+		chunk = min(len, OMAP3_MCSPI_MAX_WCNT);
+
+		writel(0, &chan->chctrl);
+		writel(chconf | OMAP3_MCSPI_CHCONF_FFER |
+		       OMAP3_MCSPI_CHCONF_TURBO, &chan->chconf);
+		writel(chunk << OMAP3_MCSPI_XFERLEVEL_WCNT_SHIFT,
+		       &ds->regs->xferlevel);
+		writel(OMAP3_MCSPI_CHCTRL_EN, &chan->chctrl);
+
+		/* RX only mode still needs a dummy word in TX to start */
+		writel(0, &chan->tx);
+
+		for (i = 0; i < chunk; ) {
+			stat = readl(&chan->chstat);
+			if (stat & OMAP3_MCSPI_CHSTAT_RXFFF) {
+				/* full FIFO: drain it without polling */
+				for (n = 0; n < OMAP3_MCSPI_FIFO_DEPTH; n++)
+					*rxp++ = readl(&chan->rx);
+				i += OMAP3_MCSPI_FIFO_DEPTH;
+			} else if (!(stat & OMAP3_MCSPI_CHSTAT_RXFFE)) {
+				*rxp++ = readl(&chan->rx);
+				i++;
+			} else {
+				if (--timeout <= 0) {
+					printf("SPI RXS timed out, status=0x%08x\n",
+					       stat);
+					writel(0, &chan->chctrl);
+					writel(0, &ds->regs->xferlevel);
+					return -1;
+				}
+				continue;
 			}
+			timeout = SPI_WAIT_TIMEOUT;
 		}
-		/* Read the data */
-		rxp[i] = readl(&ds->regs->channel[ds->slave.cs].rx);
+		len -= chunk;
 	}
 
+	/* back to plain register mode for the other transfer paths */
+	writel(0, &chan->chctrl);
+	writel(0, &ds->regs->xferlevel);
+
 	if (flags & SPI_XFER_END) {
 		chconf &= ~OMAP3_MCSPI_CHCONF_FORCE;
-		writel(chconf, &ds->regs->channel[ds->slave.cs].chconf);
-
-		writel(0, &ds->regs->channel[ds->slave.cs].chctrl);
+		writel(chconf, &chan->chconf);
+	} else {
+		writel(chconf, &chan->chconf);
+		writel(OMAP3_MCSPI_CHCTRL_EN, &chan->chctrl);
 	}
 
 	return 0;
+
+drain_timeout:
+	printf("SPI EOT timed out, status=0x%08x\n", readl(&chan->chstat));
+	return -1;
 }
 
 /*McSPI Transmit Receive Mode*/
@@ -42,6 +42,10 @@
 
 #define OMAP3_MCSPI_MAX_FREQ	48000000
 
+/* RX FIFO depth in words when only receive uses it (WL <= 8 bits) */
+#define OMAP3_MCSPI_FIFO_DEPTH	64
+#define OMAP3_MCSPI_MAX_WCNT	0xffff
+
 /* OMAP3 McSPI registers */
 struct mcspi_channel {
 	unsigned int chconf;		/* 0x2C, 0x40, 0x54, 0x68 */
@@ -64,6 +68,7 @@ struct mcspi {
 					/* channel1: 0x40 - 0x50, bus 0 & 1 */
 					/* channel2: 0x54 - 0x64, bus 0 & 1 */
 					/* channel3: 0x68 - 0x78, bus 0 */
+	unsigned int xferlevel;		/* 0x7C */
 };
 
 /* per-register bitmasks */
@@ -93,15 +98,21 @@ struct mcspi {
 #define OMAP3_MCSPI_CHCONF_IS		(1 << 18)
 #define OMAP3_MCSPI_CHCONF_TURBO	(1 << 19)
 #define OMAP3_MCSPI_CHCONF_FORCE	(1 << 20)
+#define OMAP3_MCSPI_CHCONF_FFEW		(1 << 27)
+#define OMAP3_MCSPI_CHCONF_FFER		(1 << 28)
 
 #define OMAP3_MCSPI_CHSTAT_RXS		(1 << 0)
 #define OMAP3_MCSPI_CHSTAT_TXS		(1 << 1)
 #define OMAP3_MCSPI_CHSTAT_EOT		(1 << 2)
+#define OMAP3_MCSPI_CHSTAT_RXFFE	(1 << 5)
+#define OMAP3_MCSPI_CHSTAT_RXFFF	(1 << 6)
 
 #define OMAP3_MCSPI_CHCTRL_EN		(1 << 0)
 
 #define OMAP3_MCSPI_WAKEUPENABLE_WKEN	(1 << 0)
 
+#define OMAP3_MCSPI_XFERLEVEL_WCNT_SHIFT	16
+
 struct omap3_spi_slave {
 	struct spi_slave slave;
 	struct mcspi *regs;
@@ -923,6 +923,16 @@ submit_bulk_msg(struct usb_device *dev, unsigned long pipe, void *buffer,
 	return ehci_submit_async(dev, pipe, buffer, length, NULL);
 }
 
+int usb_get_max_xfer_size(struct usb_device *dev, size_t *size)
+{
+	/*
+	 * qTDs are allocated per transfer, so any length fits as long as
+	 * there is enough free heap space left.
+	 */
+	*size = ~(size_t)0;
+	return 0;
+}
+
 int
 submit_control_msg(struct usb_device *dev, unsigned long pipe, void *buffer,
 		   int length, struct devrequest *setup)
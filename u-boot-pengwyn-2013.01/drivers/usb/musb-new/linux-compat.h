@@ -109,6 +109,25 @@ typedef unsigned long dmaaddr_t;
 
 #define msleep(a)	udelay(a * 1000)
 
+/*
+ * Streaming DMA mappings.  U-Boot runs with a flat mapping, so the bus
+ * address of a buffer is its virtual address; the DMA glue maintains
+ * the data cache itself when it programs a transfer.
+ */
+#ifndef __ASM_ARM_DMA_MAPPING_H
+enum dma_data_direction {
+	DMA_BIDIRECTIONAL	= 0,
+	DMA_TO_DEVICE		= 1,
+	DMA_FROM_DEVICE		= 2,
+};
+#endif
+
+#define dma_map_single(dev, ptr, size, dir)	\
+	((dma_addr_t)(unsigned long)(ptr))
+#define dma_unmap_single(dev, addr, size, dir) do {} while (0)
+#define dma_sync_single_for_device(dev, addr, size, dir) do {} while (0)
+#define dma_sync_single_for_cpu(dev, addr, size, dir) do {} while (0)
+
 /*
  * Map U-Boot config options to Linux ones
  */
@@ -1992,7 +1992,11 @@ musb_init_controller(struct musb_hdrc_platform_data *plat, struct device *dev,
 	pm_runtime_get_sync(musb->controller);
 
 #ifndef CONFIG_MUSB_PIO_ONLY
+#ifndef __UBOOT__
 	if (use_dma && dev->dma_mask) {
+#else
+	if (use_dma) {
+#endif
 		struct dma_controller	*c;
 
 		c = dma_controller_create(musb, musb->mregs);
@@ -0,0 +1,691 @@
+/*
+ * CPPI 4.1 DMA support for the AM335x USB subsystem
+ *
+ * Both MUSB instances share one CPPI 4.1 DMA engine with 30 TX and 30 RX
+ * channels (15 per instance, one per endpoint), a scheduler and a queue
+ * manager.  Transfers are described by host descriptors taken from a pool
+ * that is set up once when the first controller is created; each channel
+ * owns exactly one descriptor, so at most one descriptor per channel is
+ * ever queued.  Completions are reaped by polling the completion queues
+ * from the glue layer's isr, which U-Boot calls in a loop anyway.
+ *
+ * TX transfers longer than one packet use the generic RNDIS mode of the
+ * USB wrapper so that a whole buffer moves in one descriptor.  RX always
+ * uses transparent mode with one packet per descriptor as required by
+ * AM335x advisory 1.0.13; the next packet is queued (and, in host mode,
+ * requested) from the completion path until the buffer is full or a
+ * short packet arrives.
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+#define __UBOOT__
+#include <common.h>
+#include <malloc.h>
+#include <asm/io.h>
+#include <asm/arch/hardware.h>
+#include "linux-compat.h"
+
+#include "musb_core.h"
+
+#define CPPI41_NUM_EPS		15	/* channels per MUSB instance */
+#define CPPI41_NUM_CHANNELS	(2 * CPPI41_NUM_EPS)
+
+/*
+ * Descriptor pool: one descriptor per channel and direction plus the
+ * teardown descriptor, rounded up to the power of two the queue manager
+ * wants.  Descriptors are padded to a cache line so that maintaining one
+ * never touches a neighbour the DMA engine may be writing.
+ */
+#define CPPI41_NUM_DESCS	64
+#define CPPI41_NUM_DESCS_SHIFT	6
+#define CPPI41_DESC_SIZE	64
+#define CPPI41_DESC_SIZE_SHIFT	6
+#define CPPI41_TD_DESC		(2 * CPPI41_NUM_CHANNELS)
+
+/* DMA controller */
+#define DMA_TDFDQ		0x04
+#define DMA_TXGCR(ch)		(0x800 + (ch) * 0x20)
+#define DMA_RXGCR(ch)		(0x808 + (ch) * 0x20)
+#define DMA_RXHPCRA0(ch)	(0x80c + (ch) * 0x20)
+
+#define GCR_CHAN_ENABLE		(1 << 31)
+#define GCR_TEARDOWN		(1 << 30)
+#define GCR_STARV_RETRY		(1 << 24)
+#define GCR_DESC_TYPE_HOST	(1 << 14)
+
+/* DMA scheduler */
+#define SCHED_CTRL		0x00
+#define SCHED_CTRL_EN		(1 << 31)
+#define SCHED_WORD(x)		(0x800 + (x) * 4)
+#define SCHED_ENTRY(n, ch)	((ch) << ((n) * 8))
+#define SCHED_ENTRY_IS_RX(n)	(1 << ((n) * 8 + 7))
+
+/* Queue manager */
+#define QMGR_LRAM0_BASE		0x80
+#define QMGR_LRAM_SIZE		0x84
+#define QMGR_LRAM1_BASE		0x88
+#define QMGR_MEMBASE(r)		(0x1000 + (r) * 0x10)
+#define QMGR_MEMCTRL(r)		(0x1004 + (r) * 0x10)
+#define QMGR_QUEUE_D(q)		(0x200c + (q) * 0x10)
+
+#define QMGR_MEMCTRL_IDX_SHIFT	16
+#define QMGR_MEMCTRL_DESC_SHIFT	8
+#define QMGR_DESC_ADDR_MASK	(~0x1f)
+/* number of descriptor bytes, beyond 24, the DMA engine should fetch */
+#define QMGR_DESC_HINT		((32 - 24) / 4)
+
+/* queue numbers */
+#define QUEUE_TD_FREE		31
+#define QUEUE_TD_COMPLETE	0
+#define QUEUE_TX_SUBMIT(ch)	(32 + 2 * (ch))
+#define QUEUE_TX_COMPLETE(ch)	((ch) < CPPI41_NUM_EPS ? 93 + (ch) : \
+				 125 + (ch) - CPPI41_NUM_EPS)
+#define QUEUE_RX_SUBMIT(ch)	(1 + (ch))
+#define QUEUE_RX_COMPLETE(ch)	((ch) < CPPI41_NUM_EPS ? 109 + (ch) : \
+				 141 + (ch) - CPPI41_NUM_EPS)
+
+/* Host descriptor fields */
+#define DESC_TYPE_SHIFT		27
+#define DESC_TYPE_HOST		0x10
+#define DESC_TYPE_TEARDOWN	0x13
+#define DESC_LEN_MASK		0x3fffff
+#define DESC_PD2_PKT_TYPE_USB	(5 << 26)
+#define DESC_PD2_ZERO_LENGTH	(1 << 19)
+#define DESC_PD6_BUF_VALID	(1 << 31)
+
+/* USB wrapper DMA registers, relative to the instance's ctrl_base */
+#define USB_TX_MODE		0x70
+#define USB_RX_MODE		0x74
+#define USB_GENRNDISEP(ep)	(0x80 + ((ep) - 1) * 4)
+#define USB_AUTOREQ		0xd0
+#define USB_TDOWN		0xd8
+
+#define EP_MODE_TRANSPARENT	0
+#define EP_MODE_GEN_RNDIS	3
+#define EP_MODE_SHIFT(ep)	(((ep) - 1) * 2)
+
+/*
+ * The generic RNDIS size register is 16 bits wide; keep TX transfers to
+ * whole high speed packets below that.  RX is moved a packet at a time.
+ */
+#define CPPI41_TX_MAX_LEN	0xfe00
+#define CPPI41_RX_MAX_LEN	DESC_LEN_MASK
+
+#define CPPI41_TEARDOWN_TIMEOUT	1000	/* us */
+
+struct cppi41_desc {
+	u32	pd0;	/* type, packet length */
+	u32	pd1;
+	u32	pd2;	/* packet type, flags, completion queue */
+	u32	pd3;	/* buffer length */
+	u32	pd4;	/* buffer address */
+	u32	pd5;
+	u32	pd6;	/* original buffer length */
+	u32	pd7;	/* original buffer address */
+	u32	pad[(CPPI41_DESC_SIZE - 32) / 4];
+};
+
+struct cppi41_dma_controller;
+
+struct cppi41_channel {
+	struct dma_channel	channel;
+	struct cppi41_dma_controller *controller;
+	struct musb_hw_ep	*hw_ep;
+	struct cppi41_desc	*desc;
+	u8			ch_num;		/* CPPI channel, 0..29 */
+	u8			port_num;	/* endpoint number */
+	u8			is_tx;
+	u8			allocated;
+	u16			q_submit;
+	u16			q_complete;
+	u16			packet_sz;
+	dma_addr_t		buf_addr;
+	u32			total_len;
+	u32			prog_len;
+	u32			transferred;
+};
+
+struct cppi41_dma_controller {
+	struct dma_controller	controller;
+	struct musb		*musb;
+	void __iomem		*ctrl_base;
+	u32			tx_mode;
+	struct cppi41_channel	tx_channel[CPPI41_NUM_EPS];
+	struct cppi41_channel	rx_channel[CPPI41_NUM_EPS];
+};
+
+/* State shared by both MUSB instances */
+static struct cppi41_desc *cppi41_descs;
+static u32 *cppi41_lram;
+static int cppi41_users;
+
+static void __iomem *const cppi41_dma = (void *)AM335X_USB_CPPI41_DMA_BASE;
+static void __iomem *const cppi41_sched = (void *)AM335X_USB_CPPI41_SCHED_BASE;
+static void __iomem *const cppi41_qmgr = (void *)AM335X_USB_CPPI41_QMGR_BASE;
+
+static void cppi41_flush(const void *p, size_t len)
+{
+	unsigned long start = (unsigned long)p & ~(ARCH_DMA_MINALIGN - 1);
+
+	flush_dcache_range(start, ALIGN((unsigned long)p + len,
+					ARCH_DMA_MINALIGN));
+}
+
+static void cppi41_invalidate(const void *p, size_t len)
+{
+	invalidate_dcache_range((unsigned long)p,
+				(unsigned long)p + len);
+}
+
+static void cppi41_push(u16 queue, struct cppi41_desc *desc)
+{
+	writel(QMGR_DESC_HINT | (u32)desc, cppi41_qmgr + QMGR_QUEUE_D(queue));
+}
+
+static struct cppi41_desc *cppi41_pop(u16 queue)
+{
+	u32 addr = readl(cppi41_qmgr + QMGR_QUEUE_D(queue));
+
+	return (struct cppi41_desc *)(addr & QMGR_DESC_ADDR_MASK);
+}
+
+static void cppi41_drain(u16 queue)
+{
+	while (cppi41_pop(queue))
+		;
+}
+
+static int cppi41_init(void)
+{
+	u32 reg;
+	int ch;
+
+	if (cppi41_users++)
+		return 0;
+
+	cppi41_descs = memalign(ARCH_DMA_MINALIGN,
+				CPPI41_NUM_DESCS * CPPI41_DESC_SIZE);
+	cppi41_lram = memalign(ARCH_DMA_MINALIGN, CPPI41_NUM_DESCS * 4);
+	if (!cppi41_descs || !cppi41_lram) {
+		free(cppi41_descs);
+		free(cppi41_lram);
+		cppi41_descs = NULL;
+		cppi41_lram = NULL;
+		cppi41_users = 0;
+		return -ENOMEM;
+	}
+	memset(cppi41_descs, 0, CPPI41_NUM_DESCS * CPPI41_DESC_SIZE);
+	memset(cppi41_lram, 0, CPPI41_NUM_DESCS * 4);
+	cppi41_flush(cppi41_descs, CPPI41_NUM_DESCS * CPPI41_DESC_SIZE);
+	cppi41_flush(cppi41_lram, CPPI41_NUM_DESCS * 4);
+
+	/* linking RAM and a single descriptor region holding the pool */
+	writel((u32)cppi41_lram, cppi41_qmgr + QMGR_LRAM0_BASE);
+	writel(CPPI41_NUM_DESCS, cppi41_qmgr + QMGR_LRAM_SIZE);
+	writel(0, cppi41_qmgr + QMGR_LRAM1_BASE);
+
+	reg = (0 << QMGR_MEMCTRL_IDX_SHIFT) |
+	      ((CPPI41_DESC_SIZE_SHIFT - 5) << QMGR_MEMCTRL_DESC_SHIFT) |
+	      (CPPI41_NUM_DESCS_SHIFT - 5);
+	writel((u32)cppi41_descs, cppi41_qmgr + QMGR_MEMBASE(0));
+	writel(reg, cppi41_qmgr + QMGR_MEMCTRL(0));
+
+	writel(QUEUE_TD_FREE, cppi41_dma + DMA_TDFDQ);
+	cppi41_drain(QUEUE_TD_FREE);
+	cppi41_drain(QUEUE_TD_COMPLETE);
+
+	/* give every TX and RX channel one slot per scheduler round */
+	writel(0, cppi41_sched + SCHED_CTRL);
+	for (ch = 0; ch < CPPI41_NUM_CHANNELS; ch += 2) {
+		reg = SCHED_ENTRY(0, ch) |
+		      SCHED_ENTRY(1, ch) | SCHED_ENTRY_IS_RX(1) |
+		      SCHED_ENTRY(2, ch + 1) |
+		      SCHED_ENTRY(3, ch + 1) | SCHED_ENTRY_IS_RX(3);
+		writel(reg, cppi41_sched + SCHED_WORD(ch / 2));
+	}
+	writel((CPPI41_NUM_CHANNELS * 2 - 1) | SCHED_CTRL_EN,
+	       cppi41_sched + SCHED_CTRL);
+
+	return 0;
+}
+
+static void cppi41_exit(void)
+{
+	if (--cppi41_users)
+		return;
+
+	writel(0, cppi41_sched + SCHED_CTRL);
+	free(cppi41_descs);
+	free(cppi41_lram);
+	cppi41_descs = NULL;
+	cppi41_lram = NULL;
+}
+
+static void __iomem *cppi41_gcr(struct cppi41_channel *c)
+{
+	return cppi41_dma + (c->is_tx ? DMA_TXGCR(c->ch_num) :
+				       DMA_RXGCR(c->ch_num));
+}
+
+static u32 cppi41_gcr_enable(struct cppi41_channel *c)
+{
+	if (c->is_tx)
+		return GCR_CHAN_ENABLE;
+
+	return GCR_CHAN_ENABLE | GCR_STARV_RETRY | GCR_DESC_TYPE_HOST |
+	       c->q_complete;
+}
+
+static void cppi41_set_tx_mode(struct cppi41_channel *c, u32 mode)
+{
+	struct cppi41_dma_controller *controller = c->controller;
+	u32 reg = controller->tx_mode;
+
+	reg &= ~(3 << EP_MODE_SHIFT(c->port_num));
+	reg |= mode << EP_MODE_SHIFT(c->port_num);
+	if (reg != controller->tx_mode) {
+		controller->tx_mode = reg;
+		writel(reg, controller->ctrl_base + USB_TX_MODE);
+	}
+}
+
+static void cppi41_queue(struct cppi41_channel *c, dma_addr_t addr, u32 len)
+{
+	struct cppi41_desc *d = c->desc;
+
+	d->pd0 = (DESC_TYPE_HOST << DESC_TYPE_SHIFT) | len;
+	d->pd1 = 0;
+	d->pd2 = DESC_PD2_PKT_TYPE_USB | c->q_complete;
+	d->pd3 = len;
+	d->pd4 = addr;
+	d->pd5 = 0;
+	d->pd6 = DESC_PD6_BUF_VALID | len;
+	d->pd7 = addr;
+	cppi41_flush(d, sizeof(*d));
+
+	c->prog_len = len;
+	writel(cppi41_gcr_enable(c), cppi41_gcr(c));
+	cppi41_push(c->q_submit, d);
+}
+
+static int cppi41_dma_start(struct dma_controller *c)
+{
+	struct cppi41_dma_controller *controller =
+		container_of(c, struct cppi41_dma_controller, controller);
+
+	controller->tx_mode = 0;
+	writel(0, controller->ctrl_base + USB_TX_MODE);
+	writel(0, controller->ctrl_base + USB_RX_MODE);
+	writel(0, controller->ctrl_base + USB_AUTOREQ);
+
+	return 0;
+}
+
+static int cppi41_dma_channel_abort(struct dma_channel *channel);
+
+static int cppi41_dma_stop(struct dma_controller *c)
+{
+	struct cppi41_dma_controller *controller =
+		container_of(c, struct cppi41_dma_controller, controller);
+	int i;
+
+	for (i = 0; i < CPPI41_NUM_EPS; i++) {
+		cppi41_dma_channel_abort(&controller->tx_channel[i].channel);
+		cppi41_dma_channel_abort(&controller->rx_channel[i].channel);
+	}
+
+	return 0;
+}
+
+static struct dma_channel *
+cppi41_dma_channel_alloc(struct dma_controller *c, struct musb_hw_ep *hw_ep,
+			 u8 is_tx)
+{
+	struct cppi41_dma_controller *controller =
+		container_of(c, struct cppi41_dma_controller, controller);
+	struct cppi41_channel *cppi41_channel;
+	u8 ch_num = hw_ep->epnum - 1;
+
+	/* endpoint 0 is always driven by PIO */
+	if (ch_num >= CPPI41_NUM_EPS)
+		return NULL;
+
+	if (is_tx)
+		cppi41_channel = &controller->tx_channel[ch_num];
+	else
+		cppi41_channel = &controller->rx_channel[ch_num];
+
+	if (cppi41_channel->allocated)
+		return NULL;
+
+	cppi41_channel->allocated = 1;
+	cppi41_channel->hw_ep = hw_ep;
+	cppi41_channel->channel.status = MUSB_DMA_STATUS_FREE;
+	cppi41_channel->channel.actual_len = 0;
+
+	return &cppi41_channel->channel;
+}
+
+static void cppi41_dma_channel_release(struct dma_channel *channel)
+{
+	struct cppi41_channel *cppi41_channel = channel->private_data;
+
+	if (cppi41_channel->allocated) {
+		cppi41_channel->allocated = 0;
+		channel->status = MUSB_DMA_STATUS_UNKNOWN;
+	}
+}
+
+static int cppi41_dma_channel_program(struct dma_channel *channel,
+				      u16 packet_sz, u8 mode,
+				      dma_addr_t dma_addr, u32 len)
+{
+	struct cppi41_channel *c = channel->private_data;
+	void __iomem *ctrl_base = c->controller->ctrl_base;
+
+	if (!len || !packet_sz)
+		return false;
+
+	if (c->is_tx) {
+		/* a terminating ZLP is left to PIO */
+		if (mode && !(len % packet_sz))
+			return false;
+		if (len > channel->max_len)
+			len = channel->max_len;
+
+		cppi41_flush((void *)dma_addr, len);
+		if (len > packet_sz) {
+			writel(len, ctrl_base + USB_GENRNDISEP(c->port_num));
+			cppi41_set_tx_mode(c, EP_MODE_GEN_RNDIS);
+		} else {
+			cppi41_set_tx_mode(c, EP_MODE_TRANSPARENT);
+		}
+	} else {
+		/* RX buffers are invalidated, so they must own whole lines */
+		if ((dma_addr | len) & (ARCH_DMA_MINALIGN - 1))
+			return false;
+
+		cppi41_invalidate((void *)dma_addr, len);
+	}
+
+	c->buf_addr = dma_addr;
+	c->total_len = len;
+	c->transferred = 0;
+	c->packet_sz = packet_sz;
+	channel->actual_len = 0;
+	channel->status = MUSB_DMA_STATUS_BUSY;
+
+	cppi41_queue(c, dma_addr, c->is_tx ? len : min(len, (u32)packet_sz));
+
+	return true;
+}
+
+static void cppi41_teardown(struct cppi41_channel *c)
+{
+	struct cppi41_desc *td = &cppi41_descs[CPPI41_TD_DESC];
+	void __iomem *ctrl_base = c->controller->ctrl_base;
+	u32 tdbit = 1 << c->port_num;
+	struct cppi41_desc *d;
+	int td_seen = 0, desc_seen = 0;
+	int timeout = CPPI41_TEARDOWN_TIMEOUT;
+
+	if (c->is_tx)
+		tdbit <<= 16;
+
+	td->pd0 = DESC_TYPE_TEARDOWN << DESC_TYPE_SHIFT;
+	cppi41_flush(td, sizeof(*td));
+	cppi41_push(QUEUE_TD_FREE, td);
+
+	writel(cppi41_gcr_enable(c) | GCR_TEARDOWN, cppi41_gcr(c));
+
+	/*
+	 * The transfer descriptor comes back before the teardown
+	 * descriptor; a busy TX channel needs its teardown bit poked
+	 * until it lets go.
+	 */
+	while (!td_seen && timeout--) {
+		if (c->is_tx)
+			writel(tdbit, ctrl_base + USB_TDOWN);
+
+		d = cppi41_pop(QUEUE_TD_COMPLETE);
+		if (!d)
+			d = cppi41_pop(c->q_complete);
+		if (d == td)
+			td_seen = 1;
+		else if (d == c->desc)
+			desc_seen = 1;
+		else
+			udelay(1);
+	}
+
+	if (!td_seen)
+		printf("musb: CPPI 4.1 channel %d teardown timed out\n",
+		       c->ch_num);
+
+	if (!desc_seen) {
+		cppi41_drain(c->q_submit);
+		cppi41_drain(c->q_complete);
+	}
+
+	writel(0, cppi41_gcr(c));
+}
+
+static int cppi41_dma_channel_abort(struct dma_channel *channel)
+{
+	struct cppi41_channel *c = channel->private_data;
+	void __iomem *ctrl_base = c->controller->ctrl_base;
+	void __iomem *epio = c->hw_ep ? c->hw_ep->regs : NULL;
+	u16 csr;
+
+	if (!epio || channel->status == MUSB_DMA_STATUS_FREE ||
+	    channel->status == MUSB_DMA_STATUS_UNKNOWN)
+		return 0;
+
+	if (c->is_tx) {
+		csr = musb_readw(epio, MUSB_TXCSR);
+		if (csr & MUSB_TXCSR_TXPKTRDY) {
+			csr |= MUSB_TXCSR_FLUSHFIFO;
+			musb_writew(epio, MUSB_TXCSR, csr);
+			musb_writew(epio, MUSB_TXCSR, csr);
+		}
+	} else {
+		csr = musb_readw(epio, MUSB_RXCSR);
+		csr &= ~(MUSB_RXCSR_H_REQPKT | MUSB_RXCSR_DMAENAB);
+		musb_writew(epio, MUSB_RXCSR, csr);
+		/* let the DMA pipeline drain */
+		udelay(50);
+		csr = musb_readw(epio, MUSB_RXCSR);
+		if (csr & MUSB_RXCSR_RXPKTRDY) {
+			csr |= MUSB_RXCSR_FLUSHFIFO;
+			musb_writew(epio, MUSB_RXCSR, csr);
+			musb_writew(epio, MUSB_RXCSR, csr);
+		}
+	}
+
+	cppi41_teardown(c);
+
+	if (c->is_tx) {
+		writel(1 << (c->port_num + 16), ctrl_base + USB_TDOWN);
+		csr = musb_readw(epio, MUSB_TXCSR);
+		if (csr & MUSB_TXCSR_TXPKTRDY) {
+			csr |= MUSB_TXCSR_FLUSHFIFO;
+			musb_writew(epio, MUSB_TXCSR, csr);
+		}
+	}
+
+	channel->actual_len = c->transferred;
+	channel->status = MUSB_DMA_STATUS_FREE;
+
+	return 0;
+}
+
+static void cppi41_complete(struct cppi41_channel *c, u32 len)
+{
+	struct cppi41_dma_controller *controller = c->controller;
+	struct musb *musb = controller->musb;
+	void __iomem *epio = c->hw_ep->regs;
+	u32 next;
+	u16 csr;
+
+	c->transferred += len;
+
+	/* RX: a full packet with room left, fetch the next one */
+	if (!c->is_tx && len == c->prog_len &&
+	    c->transferred < c->total_len) {
+		next = min(c->total_len - c->transferred, (u32)c->packet_sz);
+		cppi41_queue(c, c->buf_addr + c->transferred, next);
+
+		if (musb_readb(musb->mregs, MUSB_DEVCTL) & MUSB_DEVCTL_HM) {
+			musb_ep_select(musb->mregs, c->port_num);
+			csr = musb_readw(epio, MUSB_RXCSR);
+			csr |= MUSB_RXCSR_H_REQPKT | MUSB_RXCSR_H_WZC_BITS;
+			musb_writew(epio, MUSB_RXCSR, csr);
+		}
+		return;
+	}
+
+	if (!c->is_tx)
+		cppi41_invalidate((void *)c->buf_addr, c->total_len);
+
+	c->channel.actual_len = c->transferred;
+	c->channel.status = MUSB_DMA_STATUS_FREE;
+	musb_dma_completion(musb, c->port_num, c->is_tx);
+}
+
+static void cppi41_poll_channel(struct cppi41_channel *c)
+{
+	struct cppi41_desc *d;
+	u32 len;
+
+	if (c->channel.status != MUSB_DMA_STATUS_BUSY)
+		return;
+
+	d = cppi41_pop(c->q_complete);
+	if (!d)
+		return;
+
+	if (d != c->desc) {
+		printf("musb: CPPI 4.1 stray descriptor %p on queue %d\n",
+		       d, c->q_complete);
+		return;
+	}
+
+	cppi41_invalidate(d, sizeof(*d));
+	if (d->pd2 & DESC_PD2_ZERO_LENGTH)
+		len = 0;
+	else
+		len = d->pd0 & DESC_LEN_MASK;
+
+	cppi41_complete(c, len);
+}
+
+void cppi41_dma_poll(struct dma_controller *c)
+{
+	struct cppi41_dma_controller *controller =
+		container_of(c, struct cppi41_dma_controller, controller);
+	int i;
+
+	for (i = 0; i < CPPI41_NUM_EPS; i++) {
+		cppi41_poll_channel(&controller->tx_channel[i]);
+		cppi41_poll_channel(&controller->rx_channel[i]);
+	}
+}
+
+static void cppi41_channel_init(struct cppi41_dma_controller *controller,
+				struct cppi41_channel *c, int ch_num, int is_tx)
+{
+	c->controller = controller;
+	c->ch_num = ch_num;
+	c->port_num = ch_num % CPPI41_NUM_EPS + 1;
+	c->is_tx = is_tx;
+	c->desc = &cppi41_descs[2 * ch_num + is_tx];
+	c->channel.private_data = c;
+	c->channel.status = MUSB_DMA_STATUS_UNKNOWN;
+
+	if (is_tx) {
+		c->q_submit = QUEUE_TX_SUBMIT(ch_num);
+		c->q_complete = QUEUE_TX_COMPLETE(ch_num);
+		c->channel.max_len = CPPI41_TX_MAX_LEN;
+	} else {
+		c->q_submit = QUEUE_RX_SUBMIT(ch_num);
+		c->q_complete = QUEUE_RX_COMPLETE(ch_num);
+		c->channel.max_len = CPPI41_RX_MAX_LEN;
+		/* RX pulls its buffer descriptors from the submit queue */
+		writel(c->q_submit | c->q_submit << 16,
+		       cppi41_dma + DMA_RXHPCRA0(ch_num));
+	}
+
+	/* stale state from an earlier boot stage must not complete here */
+	writel(0, cppi41_gcr(c));
+	cppi41_drain(c->q_submit);
+	cppi41_drain(c->q_complete);
+}
+
+struct dma_controller *__init
+dma_controller_create(struct musb *musb, void __iomem *base)
+{
+	struct cppi41_dma_controller *controller;
+	int first_ch, i;
+
+	if (musb->ctrl_base == (void *)AM335X_USB0_OTG_BASE)
+		first_ch = 0;
+	else if (musb->ctrl_base == (void *)AM335X_USB1_OTG_BASE)
+		first_ch = CPPI41_NUM_EPS;
+	else
+		return NULL;
+
+	controller = kzalloc(sizeof(*controller), GFP_KERNEL);
+	if (!controller)
+		return NULL;
+
+	if (cppi41_init()) {
+		kfree(controller);
+		return NULL;
+	}
+
+	controller->musb = musb;
+	controller->ctrl_base = musb->ctrl_base;
+
+	for (i = 0; i < CPPI41_NUM_EPS; i++) {
+		cppi41_channel_init(controller, &controller->tx_channel[i],
+				    first_ch + i, 1);
+		cppi41_channel_init(controller, &controller->rx_channel[i],
+				    first_ch + i, 0);
+	}
+
+	controller->controller.start = cppi41_dma_start;
+	controller->controller.stop = cppi41_dma_stop;
+	controller->controller.channel_alloc = cppi41_dma_channel_alloc;
+	controller->controller.channel_release = cppi41_dma_channel_release;
+	controller->controller.channel_program = cppi41_dma_channel_program;
+	controller->controller.channel_abort = cppi41_dma_channel_abort;
+
+	return &controller->controller;
+}
+
+void dma_controller_destroy(struct dma_controller *c)
+{
+	struct cppi41_dma_controller *controller =
+		container_of(c, struct cppi41_dma_controller, controller);
+
+	cppi41_dma_stop(c);
+	kfree(controller);
+	cppi41_exit();
+}
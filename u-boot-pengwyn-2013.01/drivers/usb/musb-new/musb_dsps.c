@@ -404,6 +404,12 @@ static irqreturn_t dsps_interrupt(int irq, void *hci)
 	if (ret == IRQ_HANDLED || epintr || usbintr)
 		dsps_writel(reg_base, wrp->eoi, 1);
 
+#ifdef CONFIG_USB_TI_CPPI41_DMA
+	/* DMA completions are polled, the CPPI 4.1 interrupt is not used */
+	if (musb->dma_controller)
+		cppi41_dma_poll(musb->dma_controller);
+#endif
+
 #ifndef __UBOOT__
 	/* Poll for ID change */
 	if (is_otg_enabled(musb) && musb->xceiv->state == OTG_STATE_B_IDLE)
@@ -111,6 +111,18 @@ int submit_int_msg(struct usb_device *dev, unsigned long pipe,
 	return submit_urb(&hcd, urb);
 }
 
+/*
+ * A bulk URB of any length is moved packet by packet (or by the DMA engine)
+ * but polled to completion within MUSB_HOST_TIMEOUT; stay well inside it.
+ */
+#define MUSB_MAX_XFER_SIZE	(1024 * 1024)
+
+int usb_get_max_xfer_size(struct usb_device *dev, size_t *size)
+{
+	*size = MUSB_MAX_XFER_SIZE;
+	return 0;
+}
+
 int usb_lowlevel_init(void)
 {
 	u8 power;
@@ -80,10 +80,9 @@ int ext4fs_devread(int sector, int byte_offset, int byte_len, char *buf)
 
 	if (byte_offset != 0) {
 		/* read first part which isn't aligned with start of sector */
-		if (ext4fs_block_dev_desc->
-		    block_read(ext4fs_block_dev_desc->dev,
-				part_info->start + sector, 1,
-				(unsigned long *) sec_buf) != 1) {
+		if (blk_dread(ext4fs_block_dev_desc,
+			      part_info->start + sector, 1,
+			      (unsigned long *) sec_buf) != 1) {
 			printf(" ** ext2fs_devread() read error **\n");
 			return 0;
 		}
@@ -104,18 +103,18 @@ int ext4fs_devread(int sector, int byte_offset, int byte_len, char *buf)
 		ALLOC_CACHE_ALIGN_BUFFER(u8, p, SECTOR_SIZE);
 
 		block_len = SECTOR_SIZE;
-		ext4fs_block_dev_desc->block_read(ext4fs_block_dev_desc->dev,
-						  part_info->start + sector,
-						  1, (unsigned long *)p);
+		blk_dread(ext4fs_block_dev_desc,
+			  part_info->start + sector,
+			  1, (unsigned long *)p);
 		memcpy(buf, p, byte_len);
 		return 1;
 	}
 
-	if (ext4fs_block_dev_desc->block_read(ext4fs_block_dev_desc->dev,
-					       part_info->start + sector,
-					       block_len / SECTOR_SIZE,
-					       (unsigned long *) buf) !=
-					       block_len / SECTOR_SIZE) {
+	if (blk_dread(ext4fs_block_dev_desc,
+		      part_info->start + sector,
+		      block_len / SECTOR_SIZE,
+		      (unsigned long *) buf) !=
+		      block_len / SECTOR_SIZE) {
 		printf(" ** %s read error - block\n", __func__);
 		return 0;
 	}
@@ -126,10 +125,9 @@ int ext4fs_devread(int sector, int byte_offset, int byte_len, char *buf)
 
 	if (byte_len != 0) {
 		/* read rest of data which are not in whole sector */
-		if (ext4fs_block_dev_desc->
-		    block_read(ext4fs_block_dev_desc->dev,
-				part_info->start + sector, 1,
-				(unsigned long *) sec_buf) != 1) {
+		if (blk_dread(ext4fs_block_dev_desc,
+			      part_info->start + sector, 1,
+			      (unsigned long *) sec_buf) != 1) {
 			printf("* %s read error - last part\n", __func__);
 			return 0;
 		}
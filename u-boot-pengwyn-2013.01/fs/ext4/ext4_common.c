@@ -56,6 +56,46 @@ int ext4fs_indir3_blkno = -1;
 struct ext2_inode *g_parent_inode;
 static int symlinknest;
 
+/*
+ * Extent index and leaf blocks by physical block number, and the runs
+ * of the last extent mapped file.  Both are dropped on ext4fs_close()
+ * and whenever the filesystem is written.
+ */
+#ifndef CONFIG_EXT4_EXTENT_CACHE_SIZE
+#define CONFIG_EXT4_EXTENT_CACHE_SIZE	8
+#endif
+
+struct ext4_extent_node {
+	unsigned long long block;	/* 0 if the slot is free */
+	unsigned long age;
+	char *buf;
+};
+
+static struct ext4_extent_node ext4fs_ext_nodes[CONFIG_EXT4_EXTENT_CACHE_SIZE];
+static unsigned long ext4fs_ext_age;
+
+static struct ext4_extent_run *ext4fs_runs;
+static int ext4fs_nr_runs;
+static int ext4fs_max_runs;
+static int ext4fs_runs_valid;
+static char ext4fs_runs_root[sizeof(((struct ext2_inode *)0)->b)];
+
+static void ext4fs_extent_cache_invalidate(void)
+{
+	int i;
+
+	for (i = 0; i < CONFIG_EXT4_EXTENT_CACHE_SIZE; i++) {
+		free(ext4fs_ext_nodes[i].buf);
+		ext4fs_ext_nodes[i].buf = NULL;
+		ext4fs_ext_nodes[i].block = 0;
+	}
+	free(ext4fs_runs);
+	ext4fs_runs = NULL;
+	ext4fs_nr_runs = 0;
+	ext4fs_max_runs = 0;
+	ext4fs_runs_valid = 0;
+}
+
 #if defined(CONFIG_CMD_EXT4_WRITE)
 uint32_t ext4fs_div_roundup(uint32_t size, uint32_t n)
 {
@@ -82,6 +122,8 @@ void put_ext4(uint64_t off, void *buf, uint32_t size)
 	if (fs->dev_desc == NULL)
 		return;
 
+	ext4fs_extent_cache_invalidate();
+
 	if ((startblock + (size / SECTOR_SIZE)) >
 	    (part_offset + fs->total_sect)) {
 		printf("part_offset is %lu\n", part_offset);
@@ -92,28 +134,28 @@ void put_ext4(uint64_t off, void *buf, uint32_t size)
 
 	if (remainder) {
 		if (fs->dev_desc->block_read) {
-			fs->dev_desc->block_read(fs->dev_desc->dev,
-						 startblock, 1, sec_buf);
+			blk_dread(fs->dev_desc,
+				  startblock, 1, sec_buf);
 			temp_ptr = sec_buf;
 			memcpy((temp_ptr + remainder),
 			       (unsigned char *)buf, size);
-			fs->dev_desc->block_write(fs->dev_desc->dev,
-						  startblock, 1, sec_buf);
+			blk_dwrite(fs->dev_desc,
+				   startblock, 1, sec_buf);
 		}
 	} else {
 		if (size / SECTOR_SIZE != 0) {
-			fs->dev_desc->block_write(fs->dev_desc->dev,
-						  startblock,
-						  size / SECTOR_SIZE,
-						  (unsigned long *)buf);
+			blk_dwrite(fs->dev_desc,
+				   startblock,
+				   size / SECTOR_SIZE,
+				   (unsigned long *)buf);
 		} else {
-			fs->dev_desc->block_read(fs->dev_desc->dev,
-						 startblock, 1, sec_buf);
+			blk_dread(fs->dev_desc,
+				  startblock, 1, sec_buf);
 			temp_ptr = sec_buf;
 			memcpy(temp_ptr, buf, size);
-			fs->dev_desc->block_write(fs->dev_desc->dev,
-						  startblock, 1,
-						  (unsigned long *)sec_buf);
+			blk_dwrite(fs->dev_desc,
+				   startblock, 1,
+				   (unsigned long *)sec_buf);
 		}
 	}
 }
@@ -1410,14 +1452,46 @@ void ext4fs_allocate_blocks(struct ext2_inode *file_inode,
 
 #endif
 
+/* Read an extent tree block through the extent node cache */
+static struct ext4_extent_header *ext4fs_read_extent_node
+	(unsigned long long block, int log2_blksz)
+{
+	struct ext4_extent_node *node, *victim = NULL;
+	int blksz = EXT2_BLOCK_SIZE(ext4fs_root);
+	int i;
+
+	for (i = 0; i < CONFIG_EXT4_EXTENT_CACHE_SIZE; i++) {
+		node = &ext4fs_ext_nodes[i];
+		if (node->block == block) {
+			node->age = ++ext4fs_ext_age;
+			return (struct ext4_extent_header *)node->buf;
+		}
+		if (!victim || !node->block ||
+		    (victim->block && node->age < victim->age))
+			victim = node;
+	}
+
+	if (!victim->buf) {
+		victim->buf = zalloc(blksz);
+		if (!victim->buf)
+			return NULL;
+	}
+
+	victim->block = 0;
+	if (!ext4fs_devread(block << log2_blksz, 0, blksz, victim->buf))
+		return NULL;
+	victim->block = block;
+	victim->age = ++ext4fs_ext_age;
+
+	return (struct ext4_extent_header *)victim->buf;
+}
+
 static struct ext4_extent_header *ext4fs_get_extent_block
-	(struct ext2_data *data, char *buf,
-		struct ext4_extent_header *ext_block,
+	(struct ext2_data *data, struct ext4_extent_header *ext_block,
 		uint32_t fileblock, int log2_blksz)
 {
 	struct ext4_extent_idx *index;
 	unsigned long long block;
-	struct ext_filesystem *fs = get_fs();
 	int i;
 
 	while (1) {
@@ -1433,7 +1507,7 @@ static struct ext4_extent_header *ext4fs_get_extent_block
 			i++;
 			if (i >= le32_to_cpu(ext_block->eh_entries))
 				break;
-		} while (fileblock > le32_to_cpu(index[i].ei_block));
+		} while (fileblock >= le32_to_cpu(index[i].ei_block));
 
 		if (--i < 0)
 			return 0;
@@ -1441,11 +1515,146 @@ static struct ext4_extent_header *ext4fs_get_extent_block
 		block = le32_to_cpu(index[i].ei_leaf_hi);
 		block = (block << 32) + le32_to_cpu(index[i].ei_leaf_lo);
 
-		if (ext4fs_devread(block << log2_blksz, 0, fs->blksz, buf))
-			ext_block = (struct ext4_extent_header *)buf;
-		else
+		ext_block = ext4fs_read_extent_node(block, log2_blksz);
+		if (!ext_block)
+			return 0;
+	}
+}
+
+static int ext4fs_add_run(uint32_t lblk, uint32_t len,
+			  unsigned long long pblk, int unwritten)
+{
+	struct ext4_extent_run *run;
+
+	if (ext4fs_nr_runs) {
+		run = &ext4fs_runs[ext4fs_nr_runs - 1];
+		if (run->lblk + run->len == lblk &&
+		    run->unwritten == unwritten &&
+		    (unwritten || run->pblk + run->len == pblk)) {
+			run->len += len;
 			return 0;
+		}
+	}
+
+	if (ext4fs_nr_runs == ext4fs_max_runs) {
+		int n = ext4fs_max_runs ? ext4fs_max_runs * 2 : 16;
+
+		run = realloc(ext4fs_runs, n * sizeof(*run));
+		if (!run)
+			return -ENOMEM;
+		ext4fs_runs = run;
+		ext4fs_max_runs = n;
+	}
+
+	run = &ext4fs_runs[ext4fs_nr_runs++];
+	run->lblk = lblk;
+	run->len = len;
+	run->pblk = pblk;
+	run->unwritten = unwritten;
+
+	return 0;
+}
+
+/*
+ * Append the extents below 'ext_block' to the run list.  'block' is the
+ * physical block holding 'ext_block', 0 for the root in the inode.
+ */
+static int ext4fs_map_extent_node(struct ext4_extent_header *ext_block,
+				  unsigned long long block, int log2_blksz,
+				  int level)
+{
+	int i, entries, ret;
+
+	if (le16_to_cpu(ext_block->eh_magic) != EXT4_EXT_MAGIC ||
+	    level > EXT4_EXT_MAX_DEPTH)
+		return -EINVAL;
+
+	entries = le16_to_cpu(ext_block->eh_entries);
+
+	if (ext_block->eh_depth == 0) {
+		struct ext4_extent *extent;
+
+		extent = (struct ext4_extent *)(ext_block + 1);
+		for (i = 0; i < entries; i++, extent++) {
+			unsigned long long start;
+			uint32_t len = le16_to_cpu(extent->ee_len);
+			int unwritten = 0;
+
+			if (len > EXT_INIT_MAX_LEN) {
+				len -= EXT_INIT_MAX_LEN;
+				unwritten = 1;
+			}
+			start = le16_to_cpu(extent->ee_start_hi);
+			start = (start << 32) +
+				le32_to_cpu(extent->ee_start_lo);
+
+			ret = ext4fs_add_run(le32_to_cpu(extent->ee_block),
+					     len, start, unwritten);
+			if (ret)
+				return ret;
+		}
+		return 0;
 	}
+
+	for (i = 0; i < entries; i++) {
+		struct ext4_extent_idx *index;
+		unsigned long long child;
+		struct ext4_extent_header *child_block;
+
+		index = (struct ext4_extent_idx *)(ext_block + 1) + i;
+		child = le16_to_cpu(index->ei_leaf_hi);
+		child = (child << 32) + le32_to_cpu(index->ei_leaf_lo);
+
+		child_block = ext4fs_read_extent_node(child, log2_blksz);
+		if (!child_block)
+			return -EIO;
+		ret = ext4fs_map_extent_node(child_block, child, log2_blksz,
+					     level + 1);
+		if (ret)
+			return ret;
+
+		/* the walk below may have recycled this block's cache slot */
+		if (block) {
+			ext_block = ext4fs_read_extent_node(block, log2_blksz);
+			if (!ext_block)
+				return -EIO;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Map an extent based file to its runs of physically contiguous blocks,
+ * sorted by logical block.  Blocks not covered by a run are holes.
+ * Return the number of runs or a negative error.
+ */
+int ext4fs_get_extent_runs(struct ext2_inode *inode,
+			   struct ext4_extent_run **runs)
+{
+	int ret;
+
+	if (ext4fs_runs_valid &&
+	    !memcmp(ext4fs_runs_root, &inode->b, sizeof(ext4fs_runs_root))) {
+		*runs = ext4fs_runs;
+		return ext4fs_nr_runs;
+	}
+
+	ext4fs_runs_valid = 0;
+	ext4fs_nr_runs = 0;
+	ret = ext4fs_map_extent_node((struct ext4_extent_header *)
+				     inode->b.blocks.dir_blocks, 0,
+				     LOG2_EXT2_BLOCK_SIZE(ext4fs_root), 0);
+	if (ret) {
+		printf("invalid extent block\n");
+		return ret;
+	}
+
+	memcpy(ext4fs_runs_root, &inode->b, sizeof(ext4fs_runs_root));
+	ext4fs_runs_valid = 1;
+	*runs = ext4fs_runs;
+
+	return ext4fs_nr_runs;
 }
 
 static int ext4fs_blockgroup
@@ -1511,20 +1720,16 @@ long int read_allocated_block(struct ext2_inode *inode, int fileblock)
 	blksz = EXT2_BLOCK_SIZE(ext4fs_root);
 	log2_blksz = LOG2_EXT2_BLOCK_SIZE(ext4fs_root);
 	if (le32_to_cpu(inode->flags) & EXT4_EXTENTS_FL) {
-		char *buf = zalloc(blksz);
-		if (!buf)
-			return -ENOMEM;
 		struct ext4_extent_header *ext_block;
 		struct ext4_extent *extent;
 		int i = -1;
-		ext_block = ext4fs_get_extent_block(ext4fs_root, buf,
+		ext_block = ext4fs_get_extent_block(ext4fs_root,
 						    (struct ext4_extent_header
 						     *)inode->b.
 						    blocks.dir_blocks,
 						    fileblock, log2_blksz);
 		if (!ext_block) {
 			printf("invalid extent block\n");
-			free(buf);
 			return -EINVAL;
 		}
 
@@ -1537,20 +1742,16 @@ long int read_allocated_block(struct ext2_inode *inode, int fileblock)
 		} while (fileblock >= le32_to_cpu(extent[i].ee_block));
 		if (--i >= 0) {
 			fileblock -= le32_to_cpu(extent[i].ee_block);
-			if (fileblock >= le32_to_cpu(extent[i].ee_len)) {
-				free(buf);
+			if (fileblock >= le32_to_cpu(extent[i].ee_len))
 				return 0;
-			}
 
 			start = le32_to_cpu(extent[i].ee_start_hi);
 			start = (start << 32) +
 					le32_to_cpu(extent[i].ee_start_lo);
-			free(buf);
 			return fileblock + start;
 		}
 
 		printf("Extent Error\n");
-		free(buf);
 		return -1;
 	}
 
@@ -1840,6 +2041,7 @@ long int read_allocated_block(struct ext2_inode *inode, int fileblock)
 
 void ext4fs_close(void)
 {
+	ext4fs_extent_cache_invalidate();
 	if ((ext4fs_file != NULL) && (ext4fs_root != NULL)) {
 		ext4fs_free_node(ext4fs_file, &ext4fs_root->diropen);
 		ext4fs_file = NULL;
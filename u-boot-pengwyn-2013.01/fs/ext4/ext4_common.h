@@ -55,6 +55,17 @@
 #define SUPERBLOCK_SIZE	1024
 #define F_FILE			1
 
+#define EXT_INIT_MAX_LEN	(1 << 15)	/* longer extents are unwritten */
+#define EXT4_EXT_MAX_DEPTH	5
+
+/* Run of logically and physically contiguous blocks of a file */
+struct ext4_extent_run {
+	uint32_t lblk;			/* first logical block */
+	uint32_t len;			/* number of blocks */
+	unsigned long long pblk;	/* first physical block */
+	int unwritten;			/* allocated, reads as zeroes */
+};
+
 static inline void *zalloc(size_t size)
 {
 	void *p = memalign(ARCH_DMA_MINALIGN, size);
@@ -70,6 +81,8 @@ int ext4fs_find_file(const char *path, struct ext2fs_node *rootnode,
 			struct ext2fs_node **foundnode, int expecttype);
 int ext4fs_iterate_dir(struct ext2fs_node *dir, char *name,
 			struct ext2fs_node **fnode, int *ftype);
+int ext4fs_get_extent_runs(struct ext2_inode *inode,
+			   struct ext4_extent_run **runs);
 
 #if defined(CONFIG_CMD_EXT4_WRITE)
 uint32_t ext4fs_div_roundup(uint32_t size, uint32_t n);
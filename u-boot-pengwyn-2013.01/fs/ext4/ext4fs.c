@@ -56,6 +56,76 @@ void ext4fs_free_node(struct ext2fs_node *node, struct ext2fs_node *currroot)
 		free(node);
 }
 
+/*
+ * Read an extent mapped file one run at a time, so that every run of
+ * contiguous blocks is a single device read however long it is.
+ */
+static int ext4fs_read_extents(struct ext2fs_node *node, int pos,
+			       unsigned int len, char *buf)
+{
+	struct ext4_extent_run *runs;
+	int log2blocksize = LOG2_EXT2_BLOCK_SIZE(node->data);
+	int log2bytes = log2blocksize + DISK_SECTOR_BITS;
+	unsigned long long off = pos;
+	unsigned long long end = off + len;
+	int nr_runs, lo, hi;
+
+	nr_runs = ext4fs_get_extent_runs(&node->inode, &runs);
+	if (nr_runs < 0)
+		return -1;
+
+	/* first run ending after 'pos' */
+	lo = 0;
+	hi = nr_runs;
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+
+		if (((unsigned long long)runs[mid].lblk + runs[mid].len) <<
+		    log2bytes <= off)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	while (off < end) {
+		unsigned long long run_start, run_end;
+		unsigned int n;
+
+		if (lo == nr_runs) {
+			memset(buf, 0, end - off);
+			break;
+		}
+
+		run_start = (unsigned long long)runs[lo].lblk << log2bytes;
+		run_end = ((unsigned long long)runs[lo].lblk + runs[lo].len) <<
+			  log2bytes;
+
+		if (off < run_start) {
+			/* hole */
+			n = min(run_start, end) - off;
+			memset(buf, 0, n);
+		} else {
+			n = min(run_end, end) - off;
+			if (runs[lo].unwritten) {
+				memset(buf, 0, n);
+			} else {
+				unsigned long long blk = runs[lo].pblk +
+					((off - run_start) >> log2bytes);
+				int skip = off & ((1 << log2bytes) - 1);
+
+				if (ext4fs_devread(blk << log2blocksize, skip,
+						   n, buf) == 0)
+					return -1;
+			}
+			lo++;
+		}
+		buf += n;
+		off += n;
+	}
+
+	return len;
+}
+
 /*
  * Taken from openmoko-kernel mailing list: By Andy green
  * Optimized read file API : collects and defers contiguous sector
@@ -81,6 +151,9 @@ int ext4fs_read_file(struct ext2fs_node *node, int pos,
 	if (len > filesize)
 		len = filesize;
 
+	if (le32_to_cpu(node->inode.flags) & EXT4_EXTENTS_FL)
+		return ext4fs_read_extents(node, pos, len, buf);
+
 	blockcnt = ((len + pos) + blocksize - 1) / blocksize;
 
 	for (i = pos / blocksize; i < blockcnt; i++) {
@@ -887,6 +960,9 @@ void ext4fs_deinit(void)
 	free(fs->sb);
 	fs->sb = NULL;
 
+	if (blkcache_flush(fs->dev_desc))
+		printf("Error: flushing block cache\n");
+
 	if (fs->blk_bmaps) {
 		for (i = 0; i < fs->no_blkgrp; i++) {
 			free(fs->blk_bmaps[i]);
@@ -58,10 +58,81 @@ static int disk_read(__u32 block, __u32 nr_blocks, void *buf)
 	if (!cur_dev || !cur_dev->block_read)
 		return -1;
 
-	return cur_dev->block_read(cur_dev->dev,
+	return blk_dread(cur_dev,
 			cur_part_info.start + block, nr_blocks, buf);
 }
 
+/*
+ * Decoded cluster chains, see get_chain().  They stay valid for as long
+ * as the same partition is registered and the medium is unchanged.
+ */
+#ifndef CONFIG_FAT_CHAIN_CACHE_SIZE
+#define CONFIG_FAT_CHAIN_CACHE_SIZE	4
+#endif
+
+static struct fat_chain fat_chains[CONFIG_FAT_CHAIN_CACHE_SIZE];
+static unsigned long fat_chain_age;
+
+static block_dev_desc_t *cache_dev;
+static ulong cache_part_start;
+#if defined(CONFIG_PARTITIONS) && !defined(CONFIG_SPL_BUILD)
+static unsigned long cache_media_gen;
+#endif
+
+/* Directory name indexes, see fat_lookup() */
+#ifndef CONFIG_SPL_BUILD
+#ifndef CONFIG_FAT_DIR_CACHE_SIZE
+#define CONFIG_FAT_DIR_CACHE_SIZE	4
+#endif
+
+static struct fat_dir_index fat_dirs[CONFIG_FAT_DIR_CACHE_SIZE];
+static unsigned long fat_dir_age;
+
+static void fat_dir_drop(struct fat_dir_index *di)
+{
+	int i;
+
+	free(di->dents);
+	free(di->names);
+	free(di->pool);
+	memset(di, 0, sizeof(*di));
+	for (i = 0; i < FAT_DIR_HASH_SIZE; i++)
+		di->buckets[i] = -1;
+}
+#endif
+
+static void fat_chain_drop(struct fat_chain *chain)
+{
+	free(chain->extents);
+	memset(chain, 0, sizeof(*chain));
+}
+
+static void fat_invalidate_caches(void)
+{
+	int i;
+
+	for (i = 0; i < CONFIG_FAT_CHAIN_CACHE_SIZE; i++)
+		fat_chain_drop(&fat_chains[i]);
+#ifndef CONFIG_SPL_BUILD
+	for (i = 0; i < CONFIG_FAT_DIR_CACHE_SIZE; i++)
+		fat_dir_drop(&fat_dirs[i]);
+#endif
+}
+
+/* Drop cached metadata unless the same, unchanged partition is mounted */
+static void fat_check_caches(void)
+{
+#if defined(CONFIG_PARTITIONS) && !defined(CONFIG_SPL_BUILD)
+	if (cur_dev == cache_dev && cur_part_info.start == cache_part_start &&
+	    blk_media_gen == cache_media_gen)
+		return;
+	cache_media_gen = blk_media_gen;
+#endif
+	fat_invalidate_caches();
+	cache_dev = cur_dev;
+	cache_part_start = cur_part_info.start;
+}
+
 int fat_register_device(block_dev_desc_t * dev_desc, int part_no)
 {
 	ALLOC_CACHE_ALIGN_BUFFER(unsigned char, buffer, dev_desc->blksz);
@@ -113,10 +184,11 @@ int fat_register_device(block_dev_desc_t * dev_desc, int part_no)
 	}
 
 	/* Check for FAT12/FAT16/FAT32 filesystem */
-	if (!memcmp(buffer + DOS_FS_TYPE_OFFSET, "FAT", 3))
-		return 0;
-	if (!memcmp(buffer + DOS_FS32_TYPE_OFFSET, "FAT32", 5))
+	if (!memcmp(buffer + DOS_FS_TYPE_OFFSET, "FAT", 3) ||
+	    !memcmp(buffer + DOS_FS32_TYPE_OFFSET, "FAT32", 5)) {
+		fat_check_caches();
 		return 0;
+	}
 
 	cur_dev = NULL;
 	return -1;
@@ -327,6 +399,84 @@ get_cluster(fsdata *mydata, __u32 clustnum, __u8 *buffer, unsigned long size)
 	return 0;
 }
 
+/*
+ * Resolve the cluster chain starting at 'startclust' into runs of
+ * contiguous clusters, following it for at most 'nclust' clusters.
+ * Chains are cached by start cluster until fat_invalidate_caches().
+ * Return the chain, which may be shorter than 'nclust' if the FAT ends
+ * it early, or NULL if out of memory.
+ */
+static struct fat_chain *
+get_chain(fsdata *mydata, __u32 startclust, __u32 nclust)
+{
+	struct fat_chain *chain, *victim = NULL;
+	struct fat_extent *ext;
+	__u32 clust;
+	int i;
+
+	for (i = 0; i < CONFIG_FAT_CHAIN_CACHE_SIZE; i++) {
+		chain = &fat_chains[i];
+		if (chain->startclust == startclust) {
+			if (chain->clusters >= nclust) {
+				chain->age = ++fat_chain_age;
+				return chain;
+			}
+			victim = chain;
+			break;
+		}
+		if (!victim || chain->age < victim->age)
+			victim = chain;
+	}
+
+	chain = victim;
+	fat_chain_drop(chain);
+
+	clust = startclust;
+	while (chain->clusters < nclust) {
+		if (CHECK_CLUST(clust, mydata->fatsize)) {
+			debug("curclust: 0x%x\n", clust);
+			debug("Invalid FAT entry\n");
+			break;
+		}
+
+		ext = chain->nr_extents ?
+			&chain->extents[chain->nr_extents - 1] : NULL;
+		if (ext && ext->start + ext->count == clust) {
+			ext->count++;
+		} else {
+			if (chain->nr_extents == chain->max_extents) {
+				int max = chain->max_extents ?
+					chain->max_extents * 2 : 8;
+
+				ext = realloc(chain->extents,
+					      max * sizeof(*ext));
+				if (!ext) {
+					fat_chain_drop(chain);
+					return NULL;
+				}
+				chain->extents = ext;
+				chain->max_extents = max;
+			}
+			ext = &chain->extents[chain->nr_extents++];
+			ext->start = clust;
+			ext->count = 1;
+		}
+
+		if (++chain->clusters < nclust)
+			clust = get_fatent(mydata, clust);
+	}
+
+	debug("chain at %u: %u clusters in %d runs\n", startclust,
+	      chain->clusters, chain->nr_extents);
+
+	/* Only complete chains are worth remembering */
+	if (chain->clusters >= nclust)
+		chain->startclust = startclust;
+	chain->age = ++fat_chain_age;
+
+	return chain;
+}
+
 /*
  * Read at most 'maxsize' bytes from 'pos' in the file associated with 'dentptr'
  * into 'buffer'.
@@ -341,9 +491,10 @@ get_contents(fsdata *mydata, dir_entry *dentptr, unsigned long pos,
 {
 	unsigned long filesize = FAT2CPU32(dentptr->size), gotsize = 0;
 	unsigned int bytesperclust = mydata->clust_size * mydata->sect_size;
-	__u32 curclust = START(dentptr);
-	__u32 endclust, newclust;
-	unsigned long actsize;
+	struct fat_chain *chain;
+	unsigned long actsize, remaining;
+	__u32 clust, count;
+	int i;
 
 	debug("Filesize: %ld bytes\n", filesize);
 
@@ -357,92 +508,68 @@ get_contents(fsdata *mydata, dir_entry *dentptr, unsigned long pos,
 
 	debug("%ld bytes\n", filesize);
 
-	actsize = bytesperclust;
-
-	/* go to cluster at pos */
-	while (actsize <= pos) {
-		curclust = get_fatent(mydata, curclust);
-		if (CHECK_CLUST(curclust, mydata->fatsize)) {
-			debug("curclust: 0x%x\n", curclust);
-			debug("Invalid FAT entry\n");
-			return gotsize;
-		}
-		actsize += bytesperclust;
+	chain = get_chain(mydata, START(dentptr),
+			  DIV_ROUND_UP(filesize, bytesperclust));
+	if (!chain) {
+		printf("Error: allocating memory\n");
+		return -1;
 	}
 
-	/* actsize > pos */
-	actsize -= bytesperclust;
-	filesize -= actsize;
-	pos -= actsize;
+	remaining = filesize - pos;
 
-	/* align to beginning of next cluster if any */
-	if (pos) {
-		actsize = min(filesize, bytesperclust);
-		if (get_cluster(mydata, curclust, get_contents_vfatname_block,
-				(int)actsize) != 0) {
-			printf("Error reading cluster\n");
-			return -1;
-		}
-		filesize -= actsize;
-		actsize -= pos;
-		memcpy(buffer, get_contents_vfatname_block + pos, actsize);
-		gotsize += actsize;
-		if (!filesize)
-			return gotsize;
-		buffer += actsize;
+	for (i = 0; i < chain->nr_extents && remaining; i++) {
+		clust = chain->extents[i].start;
+		count = chain->extents[i].count;
 
-		curclust = get_fatent(mydata, curclust);
-		if (CHECK_CLUST(curclust, mydata->fatsize)) {
-			debug("curclust: 0x%x\n", curclust);
-			debug("Invalid FAT entry\n");
-			return gotsize;
+		/* go to cluster at pos */
+		if (pos / bytesperclust >= count) {
+			pos -= count * bytesperclust;
+			continue;
 		}
-	}
-
-	actsize = bytesperclust;
-	endclust = curclust;
-
-	do {
-		/* search for consecutive clusters */
-		while (actsize < filesize) {
-			newclust = get_fatent(mydata, endclust);
-			if ((newclust - 1) != endclust)
-				goto getit;
-			if (CHECK_CLUST(newclust, mydata->fatsize)) {
-				debug("curclust: 0x%x\n", newclust);
-				debug("Invalid FAT entry\n");
-				return gotsize;
+		clust += pos / bytesperclust;
+		count -= pos / bytesperclust;
+		pos %= bytesperclust;
+
+		/* align to beginning of next cluster if any */
+		if (pos) {
+			actsize = min(remaining + pos,
+				      (unsigned long)bytesperclust);
+			if (get_cluster(mydata, clust,
+					get_contents_vfatname_block,
+					actsize) != 0) {
+				printf("Error reading cluster\n");
+				return -1;
 			}
-			endclust = newclust;
-			actsize += bytesperclust;
+			actsize -= pos;
+			memcpy(buffer, get_contents_vfatname_block + pos,
+			       actsize);
+			gotsize += actsize;
+			buffer += actsize;
+			remaining -= actsize;
+			pos = 0;
+			clust++;
+			if (!--count || !remaining)
+				continue;
 		}
 
-		/* get remaining bytes */
-		actsize = filesize;
-		if (get_cluster(mydata, curclust, buffer, (int)actsize) != 0) {
+		/* read the rest of the run straight into the buffer */
+		if (remaining / bytesperclust < count)
+			actsize = remaining;
+		else
+			actsize = count * bytesperclust;
+		if (get_cluster(mydata, clust, buffer, actsize) != 0) {
 			printf("Error reading cluster\n");
 			return -1;
 		}
 		gotsize += actsize;
-		return gotsize;
-getit:
-		if (get_cluster(mydata, curclust, buffer, (int)actsize) != 0) {
-			printf("Error reading cluster\n");
-			return -1;
-		}
-		gotsize += (int)actsize;
-		filesize -= actsize;
 		buffer += actsize;
+		remaining -= actsize;
+	}
 
-		curclust = get_fatent(mydata, endclust);
-		if (CHECK_CLUST(curclust, mydata->fatsize)) {
-			debug("curclust: 0x%x\n", curclust);
-			printf("Invalid FAT entry\n");
-			return gotsize;
-		}
-		actsize = bytesperclust;
-		endclust = curclust;
-	} while (1);
+	if (remaining)
+		printf("Invalid FAT entry\n");
+
+	return gotsize;
 }
 
 #ifdef CONFIG_SUPPORT_VFAT
@@ -746,6 +873,256 @@ static dir_entry *get_dentfromdir(fsdata *mydata, int startsect,
 	return NULL;
 }
 
+#ifndef CONFIG_SPL_BUILD
+/*
+ * Directory lookup index.  The first lookup in a directory reads it
+ * once and hashes the lowercase short and long name of every entry;
+ * later lookups in that directory, also from subsequent fatload/fatls
+ * commands, no longer touch the medium.
+ */
+static int fat_grow(void **array, int *max, int nr, size_t size)
+{
+	void *p;
+	int n;
+
+	if (nr < *max)
+		return 0;
+
+	n = *max ? *max * 2 : 32;
+	p = realloc(*array, n * size);
+	if (!p)
+		return -1;
+
+	*array = p;
+	*max = n;
+	return 0;
+}
+
+static __u32 fat_name_hash(const char *name)
+{
+	__u32 hash = 0;
+
+	while (*name)
+		hash = hash * 31 + (unsigned char)*name++;
+
+	return hash;
+}
+
+static int fat_dir_add_name(struct fat_dir_index *di, const char *name,
+			    int dent)
+{
+	struct fat_dir_name *n;
+	int len = strlen(name) + 1;
+	int bucket;
+
+	if (len == 1)
+		return 0;
+
+	if (fat_grow((void **)&di->names, &di->max_names, di->nr_names,
+		     sizeof(*n)))
+		return -1;
+
+	while (di->pool_len + len > di->pool_size) {
+		int size = di->pool_size ? di->pool_size * 2 : 1024;
+		char *p = realloc(di->pool, size);
+
+		if (!p)
+			return -1;
+		di->pool = p;
+		di->pool_size = size;
+	}
+	memcpy(di->pool + di->pool_len, name, len);
+
+	n = &di->names[di->nr_names];
+	n->hash = fat_name_hash(name);
+	n->name = di->pool_len;
+	n->dent = dent;
+
+	bucket = n->hash % FAT_DIR_HASH_SIZE;
+	n->next = di->buckets[bucket];
+	di->buckets[bucket] = di->nr_names++;
+	di->pool_len += len;
+
+	return 0;
+}
+
+static int fat_dir_add(struct fat_dir_index *di, dir_entry *dent,
+		       const char *s_name, const char *l_name)
+{
+	if (fat_grow((void **)&di->dents, &di->max_dents, di->nr_dents,
+		     sizeof(dir_entry)))
+		return -1;
+
+	memcpy(&di->dents[di->nr_dents], dent, sizeof(dir_entry));
+	if (fat_dir_add_name(di, s_name, di->nr_dents))
+		return -1;
+	if (strcmp(s_name, l_name) &&
+	    fat_dir_add_name(di, l_name, di->nr_dents))
+		return -1;
+	di->nr_dents++;
+
+	return 0;
+}
+
+/*
+ * Add the entries of one directory block to the index.
+ * Return 1 at the end of the directory, 0 to go on, -1 on error.
+ */
+static int fat_dir_scan(fsdata *mydata, struct fat_dir_index *di,
+			int curclust, __u8 *block, int nr_dents,
+			__u16 *prevcksum)
+{
+	dir_entry *dentptr = (dir_entry *)block;
+	int i;
+
+	for (i = 0; i < nr_dents; i++, dentptr++) {
+		char s_name[14], l_name[VFAT_MAXLEN_BYTES];
+
+		if (dentptr->name[0] == DELETED_FLAG)
+			continue;
+		if (dentptr->attr & ATTR_VOLUME) {
+#ifdef CONFIG_SUPPORT_VFAT
+			__u16 cksum = ((dir_slot *)dentptr)->alias_checksum;
+
+			if ((dentptr->attr & ATTR_VFAT) != ATTR_VFAT ||
+			    !(dentptr->name[0] & LAST_LONG_ENTRY_MASK))
+				continue;
+			/* overwrites the slot with the real entry */
+			if (get_vfatname(mydata, curclust, block, dentptr,
+					 l_name))
+				continue;
+			*prevcksum = cksum;
+
+			get_name(dentptr, s_name);
+			if (fat_dir_add(di, dentptr, s_name, l_name))
+				return -1;
+#endif
+			continue;
+		}
+		if (dentptr->name[0] == 0)
+			return 1;
+#ifdef CONFIG_SUPPORT_VFAT
+		/* already indexed together with its long name */
+		if (mkcksum(dentptr->name) == *prevcksum) {
+			*prevcksum = 0xffff;
+			continue;
+		}
+#endif
+		get_name(dentptr, s_name);
+		if (fat_dir_add(di, dentptr, s_name, ""))
+			return -1;
+	}
+
+	return 0;
+}
+
+static int fat_dir_build(fsdata *mydata, struct fat_dir_index *di,
+			 __u32 root_cluster)
+{
+	__u16 prevcksum = 0xffff;
+	__u32 curclust;
+	int ret = 0;
+
+	if (di->clust == 0 && mydata->fatsize != 32) {
+		/* FAT12/16 root directory, a fixed run of sectors */
+		int rootdir_size = mydata->data_begin - mydata->rootdir_sect +
+				   mydata->clust_size * 2;
+		int sect;
+
+		for (sect = 0; sect < rootdir_size && !ret;
+		     sect += PREFETCH_BLOCKS) {
+			int n = min(rootdir_size - sect, PREFETCH_BLOCKS);
+
+			if (disk_read(mydata->rootdir_sect + sect,
+				      PREFETCH_BLOCKS,
+				      get_dentfromdir_block) < 0)
+				return -1;
+			ret = fat_dir_scan(mydata, di, 0,
+					   get_dentfromdir_block,
+					   n * DIRENTSPERBLOCK, &prevcksum);
+		}
+		return ret < 0 ? -1 : 0;
+	}
+
+	curclust = di->clust ? di->clust : root_cluster;
+	while (!ret) {
+		if (get_cluster(mydata, curclust, get_dentfromdir_block,
+				mydata->clust_size * mydata->sect_size) != 0) {
+			debug("Error: reading directory block\n");
+			return -1;
+		}
+		ret = fat_dir_scan(mydata, di, curclust,
+				   get_dentfromdir_block, DIRENTSPERCLUST,
+				   &prevcksum);
+		if (ret)
+			break;
+
+		curclust = get_fatent(mydata, curclust);
+		if (CHECK_CLUST(curclust, mydata->fatsize))
+			break;
+	}
+
+	return ret < 0 ? -1 : 0;
+}
+
+/*
+ * Look up 'filename' (lowercase) in the directory starting at cluster
+ * 'clust', 0 being the root directory, and copy its entry to 'retdent'.
+ * Return 1 if found, 0 if not, -1 if the directory could not be indexed.
+ */
+static int fat_lookup(fsdata *mydata, __u32 clust, __u32 root_cluster,
+		      const char *filename, dir_entry *retdent)
+{
+	struct fat_dir_index *di = NULL, *victim = NULL;
+	struct fat_dir_name *n;
+	__u32 hash;
+	int i, best = -1;
+
+	for (i = 0; i < CONFIG_FAT_DIR_CACHE_SIZE; i++) {
+		if (fat_dirs[i].valid && fat_dirs[i].clust == clust) {
+			di = &fat_dirs[i];
+			break;
+		}
+		if (!victim || !fat_dirs[i].valid ||
+		    (victim->valid && fat_dirs[i].age < victim->age))
+			victim = &fat_dirs[i];
+	}
+
+	if (!di) {
+		di = victim;
+		fat_dir_drop(di);
+		di->clust = clust;
+		if (fat_dir_build(mydata, di, root_cluster)) {
+			fat_dir_drop(di);
+			return -1;
+		}
+		di->valid = 1;
+	}
+	di->age = ++fat_dir_age;
+
+	hash = fat_name_hash(filename);
+	for (i = di->buckets[hash % FAT_DIR_HASH_SIZE]; i >= 0; i = n->next) {
+		n = &di->names[i];
+		if (n->hash == hash && !strcmp(di->pool + n->name, filename) &&
+		    (best < 0 || n->dent < best))
+			best = n->dent;
+	}
+
+	if (best < 0)
+		return 0;
+
+	memcpy(retdent, &di->dents[best], sizeof(dir_entry));
+	return 1;
+}
+#else
+static inline int fat_lookup(fsdata *mydata, __u32 clust,
+			     __u32 root_cluster, const char *filename,
+			     dir_entry *retdent)
+{
+	return -1;
+}
+#endif
+
 /*
  * Read boot sector and volume info from a FAT filesystem
  */
@@ -830,6 +1207,7 @@ do_fat_read_at(const char *filename, unsigned long pos, void *buffer,
 	fsdata datablock;
 	fsdata *mydata = &datablock;
 	dir_entry *dentptr = NULL;
+	dir_entry dent;
 	__u16 prevcksum = 0xffff;
 	char *subname = "";
 	__u32 cursect;
@@ -924,6 +1302,20 @@ do_fat_read_at(const char *filename, unsigned long pos, void *buffer,
 		isdir = 1;
 	}
 
+	if (dols != LS_ROOT) {
+		int found = fat_lookup(mydata, 0, root_cluster, fnamecopy,
+				       &dent);
+
+		if (found == 0)
+			goto exit;
+		if (found > 0) {
+			dentptr = &dent;
+			if (isdir && !(dentptr->attr & ATTR_DIR))
+				goto exit;
+			goto rootdir_done;
+		}
+	}
+
 	j = 0;
 	while (1) {
 		int i;
@@ -1126,8 +1518,8 @@ rootdir_done:
 	while (isdir) {
 		int startsect = mydata->data_begin
 			+ START(dentptr) * mydata->clust_size;
-		dir_entry dent;
 		char *nextname = NULL;
+		int found;
 
 		dent = *dentptr;
 		dentptr = &dent;
@@ -1150,8 +1542,14 @@ rootdir_done:
 			}
 		}
 
-		if (get_dentfromdir(mydata, startsect, subname, dentptr,
-				     isdir ? 0 : dols) == NULL) {
+		found = -1;
+		if (isdir || !dols)
+			found = fat_lookup(mydata, START(dentptr), root_cluster,
+					   subname, dentptr);
+		if (found == 0)
+			goto exit;
+		if (found < 0 && get_dentfromdir(mydata, startsect, subname,
+						 dentptr, isdir ? 0 : dols) == NULL) {
 			if (dols && !isdir)
 				ret = 0;
 			goto exit;
@@ -52,7 +52,7 @@ static int disk_write(__u32 block, __u32 nr_blocks, void *buf)
 		return -1;
 	}
 
-	return cur_dev->block_write(cur_dev->dev,
+	return blk_dwrite(cur_dev,
 			cur_part_info.start + block, nr_blocks,	buf);
 }
 
@@ -932,6 +932,9 @@ static int do_fat_write(const char *filename, void *buffer,
 
 	dir_curclust = 0;
 
+	/* The FAT and directories are about to change */
+	fat_invalidate_caches();
+
 	if (read_bootsectandvi(&bs, &volinfo, &mydata->fatsize)) {
 		debug("error: reading boot sector\n");
 		return -1;
@@ -1087,6 +1090,10 @@ static int do_fat_write(const char *filename, void *buffer,
 	}
 
 exit:
+	if (blkcache_flush(cur_dev) && ret >= 0) {
+		printf("Error: flushing block cache\n");
+		ret = -1;
+	}
 	free(mydata->fatbuf);
 	return ret < 0 ? ret : write_size;
 }
@@ -663,7 +663,11 @@ jffs2_free_cache(struct part_info *part)
 		free_nodes(&pL->frag);
 		free_nodes(&pL->dir);
 		free(pL->readbuf);
+#ifdef CONFIG_JFFS2_SCAN_INDEX
+		free(pL->sect);
+#endif
 		free(pL);
+		part->jffs2_priv = NULL;
 	}
 }
 
@@ -1423,6 +1427,256 @@ dump_dirents(struct b_lists *pL)
 }
 #endif
 
+#ifdef CONFIG_JFFS2_SCAN_INDEX
+#ifndef CONFIG_CMD_FLASH
+#error CONFIG_JFFS2_SCAN_INDEX needs CONFIG_CMD_FLASH
+#endif
+/*
+ * Persistent scan index
+ *
+ * After a scan the dirent and fragment lists are written, in list order,
+ * to a spare NOR flash area together with a signature of every erase
+ * block of the partition.  The next time the partition is used the lists
+ * are rebuilt from that index instead of walking every node again.
+ *
+ * JFFS2 only ever appends to an erase block or erases it as a whole, so
+ * an erase block is unchanged if its first and its last node are the ones
+ * seen by the scan and the space behind the last node is still erased.
+ */
+#define JFFS2_SCAN_INDEX_MAGIC		0x4a324958	/* "J2IX" */
+#define JFFS2_SCAN_INDEX_SIG_LEN	64
+
+enum {
+	INDEX_NOT_SAVED = 0,
+	INDEX_SAVED,
+	INDEX_LOADED,
+};
+
+static const char *index_state_names[] = {
+	"not saved",
+	"saved after scan",
+	"used",
+};
+
+struct jffs2_scan_index {
+	u32 magic;
+	u32 crc;		/* crc32 of everything from 'len' on */
+	u32 len;		/* size of the whole index in bytes */
+	u32 part_offset;
+	u32 part_size;
+	u32 sector_size;
+	u32 dir_count;
+	u32 frag_count;
+	u32 max_totlen;
+	struct b_sect sect[0];
+	/* followed by the dir_count and frag_count node offsets */
+};
+
+static inline u32 scan_index_len(u32 nr_sectors, u32 dirs, u32 frags)
+{
+	return sizeof(struct jffs2_scan_index) +
+		nr_sectors * sizeof(struct b_sect) + (dirs + frags) * sizeof(u32);
+}
+
+/* remember the last node found in erase block 'sect' */
+static inline void
+scan_index_note(struct b_lists *pL, u32 sect, u32 ofs, u32 totlen)
+{
+	if (pL->sect) {
+		pL->sect[sect].last = ofs;
+		pL->sect[sect].used = ofs + ((totlen + 3) & ~3);
+	}
+}
+
+/*
+ * Compute the signature of erase block 'sect' from s->used and s->last.
+ * Returns 0 if the space behind the last node is not erased.
+ */
+static int
+scan_index_sign(struct part_info *part, u32 sect, struct b_sect *s)
+{
+	u32 base = part->offset + sect * part->sector_size;
+	u32 buf[JFFS2_SCAN_INDEX_SIG_LEN / 4];
+	u32 len;
+
+	s->sig = 0;
+	if (s->used > part->sector_size || s->last > s->used)
+		return 0;
+	if (s->used < part->sector_size &&
+	    *(u32 *)get_fl_mem(base + s->used, 4, buf) != 0xffffffff)
+		return 0;
+	if (!s->used)
+		return 1;
+
+	len = min_t(u32, JFFS2_SCAN_INDEX_SIG_LEN, part->sector_size);
+	s->sig = crc32(0, get_fl_mem(base, len, buf), len);
+	len = min_t(u32, JFFS2_SCAN_INDEX_SIG_LEN, part->sector_size - s->last);
+	s->sig = crc32(s->sig, get_fl_mem(base + s->last, len, buf), len);
+	return 1;
+}
+
+static struct b_node *
+append_node(struct b_list *list, u32 offset)
+{
+	struct b_node *b;
+
+	if (!(b = add_node(list)))
+		return NULL;
+	b->offset = offset;
+	b->next = NULL;
+	b->datacrc = CRC_UNKNOWN;
+	if (list->listTail != NULL)
+		list->listTail->next = b;
+	else
+		list->listHead = b;
+	list->listTail = b;
+	return b;
+}
+
+static int
+jffs2_1pass_load_index(struct part_info *part)
+{
+	const struct jffs2_scan_index *idx =
+		(void *)CONFIG_JFFS2_SCAN_INDEX_ADDR;
+	u32 nr_sectors = part->size / part->sector_size;
+	struct b_lists *pL;
+	struct b_sect s;
+	const u32 *off;
+	u32 i;
+
+	if (part->dev->id->type != MTD_DEV_TYPE_NOR)
+		return 0;
+
+	if (idx->magic != JFFS2_SCAN_INDEX_MAGIC ||
+	    idx->part_offset != part->offset ||
+	    idx->part_size != part->size ||
+	    idx->sector_size != part->sector_size ||
+	    idx->dir_count > CONFIG_JFFS2_SCAN_INDEX_SIZE / sizeof(u32) ||
+	    idx->frag_count > CONFIG_JFFS2_SCAN_INDEX_SIZE / sizeof(u32) ||
+	    idx->len > CONFIG_JFFS2_SCAN_INDEX_SIZE ||
+	    idx->len != scan_index_len(nr_sectors, idx->dir_count,
+				       idx->frag_count))
+		return 0;
+	if (idx->crc != crc32(0, (uchar *)&idx->len,
+			      idx->len - offsetof(struct jffs2_scan_index, len)))
+		return 0;
+
+	for (i = 0; i < nr_sectors; i++) {
+		s = idx->sect[i];
+		if (!scan_index_sign(part, i, &s) || s.sig != idx->sect[i].sig) {
+			printf("JFFS2 scan index is stale (erase block %u "
+			       "changed)\n", i);
+			return 0;
+		}
+	}
+
+	jffs_init_1pass_list(part);
+	if (!(pL = (struct b_lists *)part->jffs2_priv))
+		return 0;
+
+	off = (const u32 *)&idx->sect[nr_sectors];
+	for (i = 0; i < idx->dir_count; i++)
+		if (!append_node(&pL->dir, *off++))
+			goto nomem;
+	for (i = 0; i < idx->frag_count; i++)
+		if (!append_node(&pL->frag, *off++))
+			goto nomem;
+
+	pL->readbuf = malloc(idx->max_totlen);
+	pL->max_totlen = idx->max_totlen;
+	pL->index_state = INDEX_LOADED;
+	printf("JFFS2 FS: %u dirents, %u fragments from scan index\n",
+	       pL->dir.listCount, pL->frag.listCount);
+	return 1;
+
+nomem:
+	jffs2_free_cache(part);
+	return 0;
+}
+
+static void
+jffs2_1pass_save_index(struct part_info *part)
+{
+	struct b_lists *pL = (struct b_lists *)part->jffs2_priv;
+	u32 nr_sectors = part->size / part->sector_size;
+	ulong addr = CONFIG_JFFS2_SCAN_INDEX_ADDR;
+	struct jffs2_scan_index *idx;
+	flash_info_t *flash;
+	struct b_node *b;
+	ulong start;
+	u32 *off;
+	u32 i, len;
+	int rc;
+
+	pL->index_state = INDEX_NOT_SAVED;
+	if (part->dev->id->type != MTD_DEV_TYPE_NOR || !pL->sect)
+		return;
+
+	flash = &flash_info[part->dev->id->num];
+	start = flash->start[0] + part->offset;
+	if (addr < start + part->size &&
+	    start < addr + CONFIG_JFFS2_SCAN_INDEX_SIZE) {
+		puts("JFFS2 scan index area overlaps the partition\n");
+		return;
+	}
+
+	len = scan_index_len(nr_sectors, pL->dir.listCount, pL->frag.listCount);
+	if (len > CONFIG_JFFS2_SCAN_INDEX_SIZE) {
+		printf("JFFS2 scan index needs %u bytes, only %u reserved\n",
+		       len, CONFIG_JFFS2_SCAN_INDEX_SIZE);
+		return;
+	}
+	if (!(idx = malloc(len)))
+		return;
+
+	for (i = 0; i < nr_sectors; i++) {
+		idx->sect[i] = pL->sect[i];
+		if (!scan_index_sign(part, i, &idx->sect[i])) {
+			printf("JFFS2 erase block %u has a dirty tail, "
+			       "scan index not saved\n", i);
+			goto out;
+		}
+	}
+
+	off = (u32 *)&idx->sect[nr_sectors];
+	for (b = pL->dir.listHead; b; b = b->next)
+		*off++ = b->offset;
+	for (b = pL->frag.listHead; b; b = b->next)
+		*off++ = b->offset;
+
+	idx->magic = JFFS2_SCAN_INDEX_MAGIC;
+	idx->len = len;
+	idx->part_offset = part->offset;
+	idx->part_size = part->size;
+	idx->sector_size = part->sector_size;
+	idx->dir_count = pL->dir.listCount;
+	idx->frag_count = pL->frag.listCount;
+	idx->max_totlen = pL->max_totlen;
+	idx->crc = crc32(0, (uchar *)&idx->len,
+			 len - offsetof(struct jffs2_scan_index, len));
+
+	if (memcmp(idx, (void *)addr, len)) {
+		puts("Saving JFFS2 scan index\n");
+		if (flash_sect_erase(addr,
+				addr + CONFIG_JFFS2_SCAN_INDEX_SIZE - 1))
+			goto out;
+		rc = flash_write((char *)idx, addr, len);
+		if (rc) {
+			flash_perror(rc);
+			goto out;
+		}
+	}
+	pL->index_state = INDEX_SAVED;
+out:
+	free(idx);
+}
+#else
+static inline void
+scan_index_note(struct b_lists *pL, u32 sect, u32 ofs, u32 totlen)
+{
+}
+#endif /* CONFIG_JFFS2_SCAN_INDEX */
+
 #define DEFAULT_EMPTY_SCAN_SIZE	4096
 
 static inline uint32_t EMPTY_SCAN_SIZE(uint32_t sector_size)
@@ -1455,6 +1709,9 @@ jffs2_1pass_build_lists(struct part_info * part)
 	/* if we are building a list we need to refresh the cache. */
 	jffs_init_1pass_list(part);
 	pL = (struct b_lists *)part->jffs2_priv;
+#ifdef CONFIG_JFFS2_SCAN_INDEX
+	pL->sect = calloc(nr_sectors, sizeof(struct b_sect));
+#endif
 	buf = malloc(buf_size);
 	puts ("Scanning JFFS2 FS:   ");
 
@@ -1522,8 +1779,11 @@ jffs2_1pass_build_lists(struct part_info * part)
 				jffs2_free_cache(part);
 				return 0;
 			}
-			if (ret)
+			if (ret) {
+				scan_index_note(pL, i, part->sector_size -
+						sumlen, sumlen);
 				continue;
+			}
 
 		}
 #endif /* CONFIG_JFFS2_SUMMARY */
@@ -1694,6 +1954,7 @@ jffs2_1pass_build_lists(struct part_info * part)
 					node->nodetype,
 					node->totlen, ofs);
 			}
+			scan_index_note(pL, i, ofs - sector_ofs, node->totlen);
 			ofs += ((node->totlen + 3) & ~3);
 			counterF++;
 		}
@@ -1707,6 +1968,9 @@ jffs2_1pass_build_lists(struct part_info * part)
 	 * from flash (NOR).
 	 */
 	pL->readbuf = malloc(max_totlen);
+#ifdef CONFIG_JFFS2_SCAN_INDEX
+	pL->max_totlen = max_totlen;
+#endif
 
 	/* turn the lcd back on. */
 	/* splash(); */
@@ -1769,10 +2033,17 @@ jffs2_get_list(struct part_info * part, const char *who)
 	current_part = part;
 
 	if (jffs2_1pass_rescan_needed(part)) {
+#ifdef CONFIG_JFFS2_SCAN_INDEX
+		if (jffs2_1pass_load_index(part))
+			return (struct b_lists *)part->jffs2_priv;
+#endif
 		if (!jffs2_1pass_build_lists(part)) {
 			printf("%s: Failed to scan JFFSv2 file structure\n", who);
 			return NULL;
 		}
+#ifdef CONFIG_JFFS2_SCAN_INDEX
+		jffs2_1pass_save_index(part);
+#endif
 	}
 	return (struct b_lists *)part->jffs2_priv;
 }
@@ -1859,5 +2130,8 @@ jffs2_1pass_info(struct part_info * part)
 			info.compr_info[i].compr_sum,
 			info.compr_info[i].decompr_sum);
 	}
+#ifdef CONFIG_JFFS2_SCAN_INDEX
+	printf("Scan index: %s\n", index_state_names[pl->index_state]);
+#endif
 	return 1;
 }
@@ -22,10 +22,24 @@ struct b_list {
 	struct mem_block *listMemBase;
 };
 
+#ifdef CONFIG_JFFS2_SCAN_INDEX
+/* where the last valid node of an erase block ends, see the scan index */
+struct b_sect {
+	u32 used;	/* end of the last node, from the block start */
+	u32 last;	/* start of the last node, from the block start */
+	u32 sig;	/* crc32 over the first and the last node */
+};
+#endif
+
 struct b_lists {
 	struct b_list dir;
 	struct b_list frag;
 	void *readbuf;
+#ifdef CONFIG_JFFS2_SCAN_INDEX
+	struct b_sect *sect;
+	u32 max_totlen;
+	int index_state;
+#endif
 };
 
 struct b_compr_info {
@@ -514,27 +514,18 @@ out:
 
 /* file.c */
 
-static inline void *kmap(struct page *page)
+/*
+ * Decompress data node @dn of @block to @addr, which has room for @avail bytes
+ * (at most UBIFS_BLOCK_SIZE). The data goes straight to the destination, only
+ * a node holding more than @avail bytes, i.e. the last block of a load cut
+ * short by the caller, is bounced through @bounce.
+ */
+static int read_data_node(struct ubifs_info *c, struct inode *inode,
+			  struct ubifs_data_node *dn, unsigned int block,
+			  void *addr, int avail, void *bounce)
 {
-	return page->addr;
-}
-
-static int read_block(struct inode *inode, void *addr, unsigned int block,
-		      struct ubifs_data_node *dn)
-{
-	struct ubifs_info *c = inode->i_sb->s_fs_info;
-	int err, len, out_len;
-	union ubifs_key key;
-	unsigned int dlen;
-
-	data_key_init(c, &key, inode->i_ino, block);
-	err = ubifs_tnc_lookup(c, &key, dn);
-	if (err) {
-		if (err == -ENOENT)
-			/* Not found, so it must be a hole */
-			memset(addr, 0, UBIFS_BLOCK_SIZE);
-		return err;
-	}
+	int err, len, out_len, dlen, compr_type;
+	void *out = addr;
 
 	ubifs_assert(le64_to_cpu(dn->ch.sqnum) > ubifs_inode(inode)->creat_sqnum);
 
@@ -543,19 +534,32 @@ static int read_block(struct inode *inode, void *addr, unsigned int block,
 		goto dump;
 
 	dlen = le32_to_cpu(dn->ch.len) - UBIFS_DATA_NODE_SZ;
-	out_len = UBIFS_BLOCK_SIZE;
-	err = ubifs_decompress(&dn->data, dlen, addr, &out_len,
-			       le16_to_cpu(dn->compr_type));
+	compr_type = le16_to_cpu(dn->compr_type);
+	/* ubifs_decompress() copies uncompressed data without a size check */
+	if (compr_type == UBIFS_COMPR_NONE && dlen != len)
+		goto dump;
+
+	out_len = avail;
+	if (len > avail) {
+		out = bounce;
+		out_len = UBIFS_BLOCK_SIZE;
+	}
+	err = ubifs_decompress(&dn->data, dlen, out, &out_len, compr_type);
 	if (err || len != out_len)
 		goto dump;
 
+	if (out == bounce) {
+		memcpy(addr, bounce, avail);
+		return 0;
+	}
+
 	/*
 	 * Data length can be less than a full block, even for blocks that are
 	 * not the last in the file (e.g., as a result of making a hole and
 	 * appending data). Ensure that the remainder is zeroed out.
 	 */
-	if (len < UBIFS_BLOCK_SIZE)
-		memset(addr + len, 0, UBIFS_BLOCK_SIZE - len);
+	if (len < avail)
+		memset(addr + len, 0, avail - len);
 
 	return 0;
 
@@ -566,114 +570,82 @@ dump:
 	return -EINVAL;
 }
 
-static int do_readpage(struct ubifs_info *c, struct inode *inode,
-		       struct page *page, int last_block_size)
+/*
+ * Read the first @size bytes of @inode to @addr. The TNC is walked with
+ * 'ubifs_tnc_get_bu_keys()', so data nodes which sit back to back in one LEB
+ * are fetched by a single UBI read in 'ubifs_tnc_bulk_read()' and then
+ * decompressed in place. Blocks without a data node are holes.
+ */
+static int read_file(struct ubifs_info *c, struct inode *inode, void *addr,
+		     u32 size)
 {
-	void *addr;
-	int err = 0, i;
-	unsigned int block, beyond;
-	struct ubifs_data_node *dn;
-	loff_t i_size = inode->i_size;
-
-	dbg_gen("ino %lu, pg %lu, i_size %lld",
-		inode->i_ino, page->index, i_size);
-
-	addr = kmap(page);
-
-	block = page->index << UBIFS_BLOCKS_PER_PAGE_SHIFT;
-	beyond = (i_size + UBIFS_BLOCK_SIZE - 1) >> UBIFS_BLOCK_SHIFT;
-	if (block >= beyond) {
-		/* Reading beyond inode */
-		memset(addr, 0, PAGE_CACHE_SIZE);
+	struct bu_info *bu;
+	void *buf, *bounce;
+	unsigned int block = 0, blocks, i, n;
+	u32 offs;
+	int err = 0, avail;
+
+	blocks = (size + UBIFS_BLOCK_SIZE - 1) >> UBIFS_BLOCK_SHIFT;
+
+	bounce = kmalloc(UBIFS_BLOCK_SIZE, GFP_NOFS);
+	bu = kmalloc(sizeof(struct bu_info), GFP_NOFS);
+	if (!bounce || !bu) {
+		err = -ENOMEM;
+		goto out;
+	}
+
+	bu->buf_len = c->max_bu_buf_len;
+	bu->buf = kmalloc(bu->buf_len, GFP_NOFS);
+	if (!bu->buf) {
+		err = -ENOMEM;
 		goto out;
 	}
 
-	dn = kmalloc(UBIFS_MAX_DATA_NODE_SZ, GFP_NOFS);
-	if (!dn)
-		return -ENOMEM;
+	while (block < blocks) {
+		data_key_init(c, &bu->key, inode->i_ino, block);
+		err = ubifs_tnc_get_bu_keys(c, bu);
+		if (err)
+			break;
+
+		if (bu->cnt) {
+			err = ubifs_tnc_bulk_read(c, bu);
+			if (err)
+				break;
+		} else if (!bu->blk_cnt) {
+			/* No more data nodes, the rest of the file is a hole */
+			bu->blk_cnt = blocks - block;
+		}
 
-	i = 0;
-	while (1) {
-		int ret;
-
-		if (block >= beyond) {
-			/* Reading beyond inode */
-			err = -ENOENT;
-			memset(addr, 0, UBIFS_BLOCK_SIZE);
-		} else {
-			/*
-			 * Reading last block? Make sure to not write beyond
-			 * the requested size in the destination buffer.
-			 */
-			if (((block + 1) == beyond) || last_block_size) {
-				void *buff;
-				int dlen;
-
-				/*
-				 * We need to buffer the data locally for the
-				 * last block. This is to not pad the
-				 * destination area to a multiple of
-				 * UBIFS_BLOCK_SIZE.
-				 */
-				buff = malloc(UBIFS_BLOCK_SIZE);
-				if (!buff) {
-					printf("%s: Error, malloc fails!\n",
-					       __func__);
-					err = -ENOMEM;
-					break;
-				}
-
-				/* Read block-size into temp buffer */
-				ret = read_block(inode, buff, block, dn);
-				if (ret) {
-					err = ret;
-					if (err != -ENOENT) {
-						free(buff);
-						break;
-					}
-				}
-
-				if (last_block_size)
-					dlen = last_block_size;
-				else
-					dlen = le32_to_cpu(dn->size);
-
-				/* Now copy required size back to dest */
-				memcpy(addr, buff, dlen);
-
-				free(buff);
+		buf = bu->buf;
+		n = 0;
+		for (i = 0; i < bu->blk_cnt && block < blocks; i++, block++) {
+			offs = block << UBIFS_BLOCK_SHIFT;
+			avail = min(size - offs, (u32)UBIFS_BLOCK_SIZE);
+
+			if (n < bu->cnt &&
+			    key_block(c, &bu->zbranch[n].key) == block) {
+				err = read_data_node(c, inode, buf, block,
+						     addr + offs, avail,
+						     bounce);
+				if (err)
+					goto out;
+				buf += ALIGN(bu->zbranch[n].len, 8);
+				n++;
 			} else {
-				ret = read_block(inode, addr, block, dn);
-				if (ret) {
-					err = ret;
-					if (err != -ENOENT)
-						break;
-				}
+				dbg_gen("hole");
+				memset(addr + offs, 0, avail);
 			}
 		}
-		if (++i >= UBIFS_BLOCKS_PER_PAGE)
-			break;
-		block += 1;
-		addr += UBIFS_BLOCK_SIZE;
-	}
-	if (err) {
-		if (err == -ENOENT) {
-			/* Not found, so it must be a hole */
-			dbg_gen("hole");
-			goto out_free;
-		}
-		ubifs_err("cannot read page %lu of inode %lu, error %d",
-			  page->index, inode->i_ino, err);
-		goto error;
 	}
 
-out_free:
-	kfree(dn);
 out:
-	return 0;
-
-error:
-	kfree(dn);
+	if (err)
+		ubifs_err("cannot read inode %lu, error %d",
+			  inode->i_ino, err);
+	if (bu)
+		kfree(bu->buf);
+	kfree(bu);
+	kfree(bounce);
 	return err;
 }
 
@@ -682,11 +654,7 @@ int ubifs_load(char *filename, u32 addr, u32 size)
 	struct ubifs_info *c = ubifs_sb->s_fs_info;
 	unsigned long inum;
 	struct inode *inode;
-	struct page page;
 	int err = 0;
-	int i;
-	int count;
-	int last_block_size = 0;
 	char buf [10];
 
 	c->ubi = ubi_open_volume(c->vi.ubi_num, c->vi.vol_id, UBI_READONLY);
@@ -715,28 +683,10 @@ int ubifs_load(char *filename, u32 addr, u32 size)
 	if ((size == 0) || (size > inode->i_size))
 		size = inode->i_size;
 
-	count = (size + UBIFS_BLOCK_SIZE - 1) >> UBIFS_BLOCK_SHIFT;
 	printf("Loading file '%s' to addr 0x%08x with size %d (0x%08x)...\n",
 	       filename, addr, size, size);
 
-	page.addr = (void *)addr;
-	page.index = 0;
-	page.inode = inode;
-	for (i = 0; i < count; i++) {
-		/*
-		 * Make sure to not read beyond the requested size
-		 */
-		if (((i + 1) == count) && (size < inode->i_size))
-			last_block_size = size - (i * PAGE_SIZE);
-
-		err = do_readpage(c, inode, &page, last_block_size);
-		if (err)
-			break;
-
-		page.addr += PAGE_SIZE;
-		page.index++;
-	}
-
+	err = read_file(c, inode, (void *)addr, size);
 	if (err)
 		printf("Error reading file '%s'\n", filename);
 	else {
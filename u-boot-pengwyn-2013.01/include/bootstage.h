@@ -197,6 +197,9 @@ enum bootstage_id {
 	BOOTSTAGE_ID_MAIN_CPU_AWAKE,
 	BOOTSTAGE_ID_MAIN_CPU_READY,
 
+	BOOTSTAGE_ID_START_SPL,
+	BOOTSTAGE_ID_END_SPL,
+
 	/* a few spare for the user, from here */
 	BOOTSTAGE_ID_USER,
 	BOOTSTAGE_ID_COUNT = BOOTSTAGE_ID_USER + CONFIG_BOOTSTAGE_USER_COUNT,
@@ -222,7 +225,8 @@ void show_boot_progress(int val);
 #define show_boot_progress(val) do {} while (0)
 #endif
 
-#if defined(CONFIG_BOOTSTAGE) && !defined(CONFIG_SPL_BUILD)
+#if defined(CONFIG_BOOTSTAGE) && \
+	(!defined(CONFIG_SPL_BUILD) || defined(CONFIG_SPL_BOOTSTAGE))
 /* This is the full bootstage implementation */
 
 /*
@@ -237,6 +241,35 @@ ulong bootstage_mark_name(enum bootstage_id id, const char *name);
 /* Print a report about boot time */
 void bootstage_report(void);
 
+/*
+ * Add the records to a /bootstage node in the FDT for the kernel.
+ *
+ * @param blob	FDT to update, with some free space
+ * @return 0 if ok, -1 on error (the FDT was too small, most likely)
+ */
+int bootstage_fdt_add_report(void *blob);
+
+/*
+ * Save the records to memory in a binary format, so that the next boot
+ * stage can pick them up with bootstage_unstash().
+ *
+ * @param base	Start of the stash area
+ * @param size	Size of the stash area in bytes
+ * @return 0 if ok, -1 if the area was too small
+ */
+int bootstage_stash(void *base, int size);
+
+/*
+ * Merge records saved by bootstage_stash() into ours. Ids from the user
+ * range are allocated afresh so they do not collide with our own. The
+ * stash is invalidated afterwards, so it is only merged once.
+ *
+ * @param base	Start of the stash area
+ * @param size	Size of the stash area in bytes
+ * @return 0 if ok, -1 if there is no valid stash
+ */
+int bootstage_unstash(void *base, int size);
+
 #else
 /*
  * This is a dummy implementation which just calls show_boot_progress(),
@@ -260,6 +293,16 @@ static inline ulong bootstage_mark_name(enum bootstage_id id, const char *name)
 	return 0;
 }
 
+static inline int bootstage_stash(void *base, int size)
+{
+	return 0;	/* Pretend to succeed */
+}
+
+static inline int bootstage_unstash(void *base, int size)
+{
+	return 0;	/* Pretend to succeed */
+}
+
 
 #endif /* CONFIG_BOOTSTAGE */
 
@@ -23,6 +23,7 @@
 #define	_NAND_SPL_H_
 
 #define SPL_EXPORT	(0x00000001)
+#define SPL_SAVE	(0x00000002)
 
 #define SPL_EXPORT_FDT		(0x00000001)
 #define SPL_EXPORT_ATAGS	(0x00000002)
@@ -750,6 +750,8 @@ int	init_timebase (void);
 int gunzip(void *, int, unsigned char *, unsigned long *);
 int zunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp,
 						int stoponerr, int offset);
+int gunzip_crc32(void *dst, int dstlen, unsigned char *src,
+		 unsigned long *lenp, uint32_t *crc);
 
 /* lib/qsort.c */
 void qsort(void *base, size_t nmemb, size_t size,
@@ -36,9 +36,30 @@
 #define CONFIG_CMDLINE_TAG		/* enable passing of ATAGs */
 #define CONFIG_SETUP_MEMORY_TAGS
 #define CONFIG_INITRD_TAG
+#ifndef CONFIG_SPL_BUILD
+#define CONFIG_CRC32_SLICE_BY_8
+#define CONFIG_CMD_CRC32_BENCH
+#define CONFIG_USE_ARCH_MEMCPY
+#define CONFIG_USE_ARCH_MEMSET
+#define CONFIG_USE_ARCH_MEM_NEON
+#define CONFIG_CMD_MEMBENCH
+#define CONFIG_FIT
+#define CONFIG_SHA256
+#define CONFIG_OMAP_SHAM
+#define CONFIG_CMD_HASH
+#endif
 
 #define CONFIG_SYS_CACHELINE_SIZE       64
 
+/* Boot timing, SPL records are handed over to U-Boot and the kernel */
+#define CONFIG_BOOTSTAGE
+#define CONFIG_BOOTSTAGE_FDT
+#define CONFIG_BOOTSTAGE_STASH		0x80F00000
+#define CONFIG_BOOTSTAGE_STASH_SIZE	4096
+#ifndef CONFIG_USB_SPL
+#define CONFIG_SPL_BOOTSTAGE
+#endif
+
 /* commands to include */
 #include <config_cmd_default.h>
 
@@ -206,11 +227,18 @@
 #define CONFIG_MMC
 #define CONFIG_GENERIC_MMC
 #define CONFIG_OMAP_HSMMC
+#define CONFIG_OMAP_HSMMC_DDR
 #define CONFIG_CMD_MMC
 #define CONFIG_DOS_PARTITION
 #define CONFIG_CMD_FAT
 #define CONFIG_CMD_EXT2
 #define CONFIG_FAT_WRITE
+#ifndef CONFIG_SPL_BUILD
+#define CONFIG_BLOCK_CACHE
+#define CONFIG_BLOCK_CACHE_WRITEBACK
+#define CONFIG_CMD_BLOCK_CACHE
+#define CONFIG_OMAP_HSMMC_DMA
+#endif
 
 #define CONFIG_SPI
 #define CONFIG_OMAP3_SPI
@@ -274,6 +302,12 @@
 #define CONFIG_PHY_GIGE
 #define CONFIG_PHYLIB
 #define CONFIG_PHY_SMSC
+#ifndef CONFIG_SPL_BUILD
+#define CONFIG_SYS_RX_ETH_BUFFER	32	/* room for TFTP/NFS bursts */
+#define CONFIG_CMD_CPSW
+#define CONFIG_NFS_V3
+#define CONFIG_NFS_READ_WINDOW		16	/* 1 KiB reads, one frame each */
+#endif
 
  /* Physical Memory Map */
 #define CONFIG_NR_DRAM_BANKS		1		/*  1 bank of DRAM */
@@ -357,7 +391,12 @@
 #define CONFIG_SPL_STACK		CONFIG_SYS_INIT_SP_ADDR
 
 #define CONFIG_SPL_LDSCRIPT		"$(CPUDIR)/omap-common/u-boot-spl.lds"
+#ifdef CONFIG_SPL_OS_BOOT
+/* Falcon mode loads the kernel to the start of SDRAM, keep clear of it */
+#define CONFIG_SPL_BSS_START_ADDR	0x80a00000
+#else
 #define CONFIG_SPL_BSS_START_ADDR	0x80000000
+#endif
 #define CONFIG_SPL_BSS_MAX_SIZE		0x80000		/* 512 KB */
 
 /* Core features. */
@@ -420,6 +459,31 @@
 #define	CONFIG_SYS_NAND_U_BOOT_START	CONFIG_SYS_TEXT_BASE
 
 #define CONFIG_SYS_NAND_U_BOOT_OFFS	0x80000
+
+/*
+ * Falcon mode (am335x_evm_falcon): SPL starts Linux directly, using the
+ * parameter image saved with 'spl export' and 'spl save mmc' (or 'nand
+ * write' to CONFIG_CMD_SPL_NAND_OFS). Press 'c' on the console during
+ * SPL to get U-Boot instead.
+ */
+#ifdef CONFIG_SPL_OS_BOOT
+#ifndef CONFIG_SPL_BUILD
+#define CONFIG_CMD_SPL
+#endif
+#define CONFIG_CMD_SPL_WRITE_SIZE	(128 << 10)
+#define CONFIG_SYS_SPL_ARGS_ADDR	0x80F80000	/* fdtaddr */
+
+/* MMC raw: args at 1MiB, kernel at 2MiB; FAT: files below */
+#define CONFIG_SYS_MMCSD_RAW_MODE_ARGS_SECTOR	0x800
+#define CONFIG_SYS_MMCSD_RAW_MODE_ARGS_SECTORS	(CONFIG_CMD_SPL_WRITE_SIZE / 512)
+#define CONFIG_SYS_MMCSD_RAW_MODE_KERNEL_SECTOR	0x1000
+#define CONFIG_SPL_FAT_LOAD_ARGS_NAME		"args"
+#define CONFIG_SPL_FAT_LOAD_KERNEL_NAME		"uImage"
+
+/* NAND: args in the last block of the u-boot partition */
+#define CONFIG_CMD_SPL_NAND_OFS			0x240000
+#define CONFIG_SYS_NAND_SPL_KERNEL_OFFS		0x280000
+#endif
 #endif
 
 /*
@@ -433,7 +497,11 @@
 #else
 #define CONFIG_SYS_TEXT_BASE		0x80800000
 #endif
+#ifdef CONFIG_SPL_OS_BOOT
+#define CONFIG_SYS_SPL_MALLOC_START	0x80a80000	/* after SPL bss */
+#else
 #define CONFIG_SYS_SPL_MALLOC_START	0x80208000
+#endif
 #define CONFIG_SYS_SPL_MALLOC_SIZE	0x100000
 
 /* Since SPL did pll and ddr initialization for us,
@@ -449,7 +517,11 @@
 #define CONFIG_USB_MUSB_DSPS
 #define CONFIG_ARCH_MISC_INIT
 #define CONFIG_MUSB_GADGET
+#ifdef CONFIG_SPL_BUILD
 #define CONFIG_MUSB_PIO_ONLY
+#else
+#define CONFIG_USB_TI_CPPI41_DMA
+#endif
 #define CONFIG_USB_GADGET_DUALSPEED
 #define CONFIG_USB_GADGET_VBUS_DRAW	2
 #define CONFIG_MUSB_HOST
@@ -491,6 +563,7 @@
 #ifdef CONFIG_NAND
 #define CONFIG_CMD_NAND
 #define CONFIG_NAND_OMAP_GPMC
+#define CONFIG_NAND_OMAP_GPMC_PREFETCH
 #define GPMC_NAND_ECC_LP_x16_LAYOUT	1
 #define CONFIG_SYS_NAND_BASE		(0x08000000)	/* physical address */
 							/* to access nand at */
@@ -69,6 +69,13 @@ static inline unsigned int get_mmc_blk_size(int dev)
 #define DFU_NAME_SIZE 32
 #define DFU_CMD_BUF_SIZE 128
 #define DFU_DATA_BUF_SIZE (1024*64) /* 64 KB (the huge buffer is overkill) */
+#define DFU_WRITE_CHUNK_SIZE (1024*16) /* medium write between USB polls */
+
+#ifdef CONFIG_SYS_DFU_NUM_BUFS
+#define DFU_NUM_BUFS CONFIG_SYS_DFU_NUM_BUFS
+#else
+#define DFU_NUM_BUFS 2
+#endif
 
 struct dfu_entity {
 	char			name[DFU_NAME_SIZE];
@@ -103,6 +110,11 @@ struct dfu_entity {
 
 	u32 bad_skip;	/* for nand use */
 
+	/* download statistics */
+	ulong start_time;
+	ulong write_time;	/* ms spent in write_medium */
+	int write_err;
+
 	unsigned int inited : 1;
 };
 
@@ -117,6 +129,8 @@ char *dfu_extract_token(char** e, int *n);
 
 int dfu_read(struct dfu_entity *de, void *buf, int size, int blk_seq_num);
 int dfu_write(struct dfu_entity *de, void *buf, int size, int blk_seq_num);
+int dfu_write_poll(void);
+int dfu_write_flush(void);
 /* Device specific */
 #ifdef CONFIG_DFU_MMC
 extern int dfu_fill_entity_mmc(struct dfu_entity *dfu, char *s);
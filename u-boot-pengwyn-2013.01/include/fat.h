@@ -187,6 +187,49 @@ typedef struct {
 	int	fatbufnum;	/* Used by get_fatent, init to -1 */
 } fsdata;
 
+/* Run of contiguous clusters in a file's cluster chain */
+struct fat_extent {
+	__u32	start;		/* First cluster of the run */
+	__u32	count;		/* Number of clusters in the run */
+};
+
+/* Cluster chain of a file, decoded into runs */
+struct fat_chain {
+	__u32	startclust;	/* Start cluster, 0 if the slot is free */
+	__u32	clusters;	/* Number of clusters resolved */
+	int	nr_extents;
+	int	max_extents;	/* Allocated size of 'extents' */
+	unsigned long	age;	/* For LRU replacement */
+	struct fat_extent *extents;
+};
+
+#define FAT_DIR_HASH_SIZE	64
+
+/* Short or long name of an indexed directory entry */
+struct fat_dir_name {
+	__u32	hash;
+	int	name;		/* Offset of the lowercase name in 'pool' */
+	int	dent;		/* Index into 'dents' */
+	int	next;		/* Next name in the hash bucket, -1 ends */
+};
+
+/* Name lookup index of one directory */
+struct fat_dir_index {
+	__u32	clust;		/* First cluster, 0 for the root directory */
+	int	valid;
+	unsigned long	age;	/* For LRU replacement */
+	dir_entry	*dents;
+	int	nr_dents;
+	int	max_dents;
+	struct fat_dir_name *names;
+	int	nr_names;
+	int	max_names;
+	char	*pool;
+	int	pool_len;
+	int	pool_size;
+	int	buckets[FAT_DIR_HASH_SIZE];
+};
+
 typedef int	(file_detectfs_func)(void);
 typedef int	(file_ls_func)(const char *dir);
 typedef long	(file_read_func)(const char *filename, void *buffer,
@@ -0,0 +1,64 @@
+/*
+ * Hash algorithms and the implementations behind them
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+#ifndef _HASH_H
+#define _HASH_H
+
+#define HASH_MAX_DIGEST_SIZE	32
+
+/*
+ * One implementation of one algorithm. Several providers may exist
+ * for an algorithm (an accelerator and the generic C code, say); they
+ * are tried fastest first.
+ */
+struct hash_provider {
+	const char	*algo;		/* "sha1", "sha256" or "md5" */
+	const char	*name;		/* the implementation */
+	int		digest_size;
+	/*
+	 * Hash len bytes at data into output, calling WATCHDOG_RESET()
+	 * every chunk_sz bytes or so. Returns 0, or -1 when the provider
+	 * cannot do it right now, in which case the next one is used.
+	 */
+	int		(*digest)(const void *data, uint len, uint8_t *output,
+				  uint chunk_sz);
+};
+
+/* Provider number n in order of preference, NULL past the last one */
+const struct hash_provider *hash_get_provider(int n);
+
+/*
+ * Hash data with the fastest working provider of algo and store the
+ * digest length in *output_len. Returns -1 for an unknown algorithm.
+ */
+int hash_digest(const char *algo, const void *data, uint len,
+		uint8_t *output, int *output_len);
+
+/* drivers/crypto/omap_sham.c */
+int omap_sham_sha1(const void *data, uint len, uint8_t *output,
+		   uint chunk_sz);
+int omap_sham_sha256(const void *data, uint len, uint8_t *output,
+		     uint chunk_sz);
+int omap_sham_md5(const void *data, uint len, uint8_t *output,
+		  uint chunk_sz);
+
+#endif /* _HASH_H */
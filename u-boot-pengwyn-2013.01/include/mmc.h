@@ -43,10 +43,18 @@
 
 #define MMC_MODE_HS		0x001
 #define MMC_MODE_HS_52MHz	0x010
+#define MMC_MODE_DDR_52MHz	0x020
+#define MMC_MODE_HS200		0x040
 #define MMC_MODE_4BIT		0x100
 #define MMC_MODE_8BIT		0x200
 #define MMC_MODE_SPI		0x400
 #define MMC_MODE_HC		0x800
+#define MMC_MODE_UHS_SDR50	0x1000
+#define MMC_MODE_UHS_SDR104	0x2000
+#define MMC_MODE_UHS_DDR50	0x4000
+
+#define MMC_MODE_UHS	(MMC_MODE_UHS_SDR50 | MMC_MODE_UHS_SDR104 | \
+			 MMC_MODE_UHS_DDR50)
 
 #define MMC_MODE_MASK_WIDTH_BITS (MMC_MODE_4BIT | MMC_MODE_8BIT)
 #define MMC_MODE_WIDTH_BITS_SHIFT 8
@@ -78,6 +86,8 @@
 #define MMC_CMD_SET_BLOCKLEN		16
 #define MMC_CMD_READ_SINGLE_BLOCK	17
 #define MMC_CMD_READ_MULTIPLE_BLOCK	18
+#define MMC_CMD_SEND_TUNING_BLOCK	19
+#define MMC_CMD_SEND_TUNING_BLOCK_HS200	21
 #define MMC_CMD_WRITE_SINGLE_BLOCK	24
 #define MMC_CMD_WRITE_MULTIPLE_BLOCK	25
 #define MMC_CMD_ERASE_GROUP_START	35
@@ -90,6 +100,7 @@
 #define SD_CMD_SEND_RELATIVE_ADDR	3
 #define SD_CMD_SWITCH_FUNC		6
 #define SD_CMD_SEND_IF_COND		8
+#define SD_CMD_SWITCH_UHS18V		11
 
 #define SD_CMD_APP_SET_BUS_WIDTH	6
 #define SD_CMD_ERASE_WR_BLK_START	32
@@ -101,11 +112,19 @@
 #define SD_HIGHSPEED_BUSY	0x00020000
 #define SD_HIGHSPEED_SUPPORTED	0x00020000
 
+/* Access mode (function group 1) functions of CMD6 */
+#define SD_ACCESS_SDR12		0
+#define SD_ACCESS_SDR25		1
+#define SD_ACCESS_SDR50		2
+#define SD_ACCESS_SDR104	3
+#define SD_ACCESS_DDR50		4
+
 #define MMC_HS_TIMING		0x00000100
 #define MMC_HS_52MHZ		0x2
 
 #define OCR_BUSY		0x80000000
 #define OCR_HCS			0x40000000
+#define OCR_S18R		0x01000000	/* 1.8V signalling request/accept */
 #define OCR_VOLTAGE_MASK	0x007FFF80
 #define OCR_ACCESS_MODE		0x60000000
 
@@ -172,10 +191,37 @@
 
 #define EXT_CSD_CARD_TYPE_26	(1 << 0)	/* Card can run at 26MHz */
 #define EXT_CSD_CARD_TYPE_52	(1 << 1)	/* Card can run at 52MHz */
+#define EXT_CSD_CARD_TYPE_DDR_1_8V	(1 << 2)	/* DDR52, 1.8V or 3V I/O */
+#define EXT_CSD_CARD_TYPE_DDR_1_2V	(1 << 3)	/* DDR52, 1.2V I/O */
+#define EXT_CSD_CARD_TYPE_HS200_1_8V	(1 << 4)	/* HS200, 1.8V I/O */
+#define EXT_CSD_CARD_TYPE_HS200_1_2V	(1 << 5)	/* HS200, 1.2V I/O */
+#define EXT_CSD_CARD_TYPE_DDR_52	(EXT_CSD_CARD_TYPE_DDR_1_8V | \
+					 EXT_CSD_CARD_TYPE_DDR_1_2V)
+#define EXT_CSD_CARD_TYPE_HS200		(EXT_CSD_CARD_TYPE_HS200_1_8V | \
+					 EXT_CSD_CARD_TYPE_HS200_1_2V)
 
 #define EXT_CSD_BUS_WIDTH_1	0	/* Card is in 1 bit mode */
 #define EXT_CSD_BUS_WIDTH_4	1	/* Card is in 4 bit mode */
 #define EXT_CSD_BUS_WIDTH_8	2	/* Card is in 8 bit mode */
+#define EXT_CSD_DDR_BUS_WIDTH_4	5	/* Card is in 4 bit DDR mode */
+#define EXT_CSD_DDR_BUS_WIDTH_8	6	/* Card is in 8 bit DDR mode */
+
+#define EXT_CSD_TIMING_LEGACY	0	/* Backwards compatible timing */
+#define EXT_CSD_TIMING_HS	1	/* High speed */
+#define EXT_CSD_TIMING_HS200	2	/* HS200 */
+
+/* Bus timing the host controller is asked to use, see struct mmc */
+#define MMC_TIMING_LEGACY	0
+#define MMC_TIMING_MMC_HS	1
+#define MMC_TIMING_SD_HS	2
+#define MMC_TIMING_UHS_SDR50	3
+#define MMC_TIMING_UHS_SDR104	4
+#define MMC_TIMING_UHS_DDR50	5
+#define MMC_TIMING_MMC_DDR52	6
+#define MMC_TIMING_MMC_HS200	7
+
+#define MMC_SIGNAL_VOLTAGE_330	0
+#define MMC_SIGNAL_VOLTAGE_180	1
 
 #define R1_ILLEGAL_COMMAND		(1 << 22)
 #define R1_APP_CMD			(1 << 5)
@@ -239,6 +285,8 @@ struct mmc {
 	int high_capacity;
 	uint bus_width;
 	uint clock;
+	uint timing;		/* MMC_TIMING_*, applied by set_ios */
+	uint signal_voltage;	/* MMC_SIGNAL_VOLTAGE_* */
 	uint card_caps;
 	uint host_caps;
 	uint ocr;
@@ -259,6 +307,16 @@ struct mmc {
 	void (*set_ios)(struct mmc *mmc);
 	int (*init)(struct mmc *mmc);
 	int (*getcd)(struct mmc *mmc);
+	/*
+	 * Optional: switch the I/O lines to another signal voltage, after
+	 * the card accepted CMD11 for SD.  Needed for the SD UHS modes.
+	 */
+	int (*set_signal_voltage)(struct mmc *mmc, uint voltage);
+	/*
+	 * Optional: run the sampling point tuning procedure with the given
+	 * tuning command.  Needed for HS200 and SD UHS SDR104.
+	 */
+	int (*execute_tuning)(struct mmc *mmc, uint opcode);
 	uint b_max;
 };
 
@@ -147,6 +147,89 @@ static inline int get_device_and_partition(const char *ifname,
 { *dev_desc = NULL; return -1; }
 #endif
 
+#ifdef CONFIG_BLOCK_CACHE
+/* drivers/block/blkcache.c */
+struct block_cache_stats {
+	unsigned hits;
+	unsigned misses;
+	unsigned evictions;
+	unsigned deferred;	/* writes held back in the cache */
+	unsigned writebacks;	/* dirty entries written to the medium */
+	unsigned entries;	/* current number of entries */
+	unsigned max_blocks_per_entry;
+	unsigned max_entries;
+};
+
+ulong blk_dread(block_dev_desc_t *dev_desc, lbaint_t start,
+		lbaint_t blkcnt, void *buffer);
+ulong blk_dwrite(block_dev_desc_t *dev_desc, lbaint_t start,
+		 lbaint_t blkcnt, const void *buffer);
+int blkcache_flush(block_dev_desc_t *dev_desc);
+void blkcache_invalidate(int if_type, int dev);
+int blkcache_written(int if_type, int dev, lbaint_t start, lbaint_t blkcnt);
+void blkcache_configure(unsigned blocks, unsigned entries);
+void blkcache_stats(struct block_cache_stats *stats);
+#else
+static inline ulong blk_dread(block_dev_desc_t *dev_desc, lbaint_t start,
+			      lbaint_t blkcnt, void *buffer)
+{
+	if (!dev_desc->block_read)
+		return 0;
+	return dev_desc->block_read(dev_desc->dev, start, blkcnt, buffer);
+}
+static inline ulong blk_dwrite(block_dev_desc_t *dev_desc, lbaint_t start,
+			       lbaint_t blkcnt, const void *buffer)
+{
+	if (!dev_desc->block_write)
+		return 0;
+	return dev_desc->block_write(dev_desc->dev, start, blkcnt, buffer);
+}
+static inline int blkcache_flush(block_dev_desc_t *dev_desc) { return 0; }
+static inline void blkcache_invalidate(int if_type, int dev) {}
+static inline int blkcache_written(int if_type, int dev, lbaint_t start,
+				   lbaint_t blkcnt)
+{ return 1; }
+#endif
+
+/*
+ * Drivers call blk_media_changed() whenever the whole contents of a device
+ * may have changed behind the filesystems' back (re-probe, hardware
+ * partition switch), and blk_media_written() from their write and erase
+ * hooks.  Writes the block cache issues itself come from a filesystem that
+ * keeps its own metadata up to date, so they change nothing here; other
+ * raw writes only drop the cached blocks they cover.  Filesystems that
+ * keep decoded metadata across commands compare blk_media_gen against the
+ * value they cached it under.
+ */
+#if defined(CONFIG_PARTITIONS) && !defined(CONFIG_SPL_BUILD)
+/* disk/part.c */
+extern unsigned long blk_media_gen;
+
+static inline void blk_media_changed(int if_type, int dev)
+{
+	blk_media_gen++;
+	blkcache_invalidate(if_type, dev);
+}
+
+static inline void blk_media_written(int if_type, int dev, lbaint_t start,
+				     lbaint_t blkcnt)
+{
+	if (blkcache_written(if_type, dev, start, blkcnt))
+		blk_media_gen++;
+}
+#else
+static inline void blk_media_changed(int if_type, int dev)
+{
+	blkcache_invalidate(if_type, dev);
+}
+
+static inline void blk_media_written(int if_type, int dev, lbaint_t start,
+				     lbaint_t blkcnt)
+{
+	blkcache_written(if_type, dev, start, blkcnt);
+}
+#endif
+
 #ifdef CONFIG_MAC_PARTITION
 /* disk/part_mac.c */
 int get_partition_info_mac (block_dev_desc_t * dev_desc, int part, disk_partition_t *info);
@@ -13,4 +13,7 @@ void sha256_starts(sha256_context * ctx);
 void sha256_update(sha256_context * ctx, uint8_t * input, uint32_t length);
 void sha256_finish(sha256_context * ctx, uint8_t digest[SHA256_SUM_LEN]);
 
+void sha256_csum_wd(unsigned char *input, unsigned int ilen,
+		unsigned char *output, unsigned int chunk_sz);
+
 #endif /* _SHA256_H */
@@ -37,10 +37,14 @@
 #define	SPI_LSB_FIRST	0x08			/* per-word bits-on-wire */
 #define	SPI_3WIRE	0x10			/* SI/SO signals shared */
 #define	SPI_LOOP	0x20			/* loopback mode */
+#define	SPI_RX_DUAL	0x40			/* data can be read on 2 wires */
+#define	SPI_RX_QUAD	0x80			/* data can be read on 4 wires */
 
 /* SPI transfer flags */
 #define SPI_XFER_BEGIN	0x01			/* Assert CS before transfer */
 #define SPI_XFER_END	0x02			/* Deassert CS after transfer */
+#define SPI_XFER_DUAL	0x04			/* Receive data on 2 wires */
+#define SPI_XFER_QUAD	0x08			/* Receive data on 4 wires */
 
 /*-----------------------------------------------------------------------
  * Representation of a SPI slave, i.e. what we're communicating with.
@@ -140,6 +144,19 @@ void spi_release_bus(struct spi_slave *slave);
 int  spi_xfer(struct spi_slave *slave, unsigned int bitlen, const void *dout,
 		void *din, unsigned long flags);
 
+/*-----------------------------------------------------------------------
+ * Report the multi-wire receive modes of the controller.
+ *
+ * A controller that can clock a read-only data phase in on two or four
+ * wires (SPI_XFER_DUAL / SPI_XFER_QUAD) provides this; the default
+ * returns 0, i.e. single wire only.
+ *
+ *   slave:	The SPI slave
+ *
+ * Returns: A bitwise combination of SPI_RX_DUAL and SPI_RX_QUAD.
+ */
+unsigned int spi_get_rx_modes(struct spi_slave *slave);
+
 /*-----------------------------------------------------------------------
  * Determine if a SPI chipselect is valid.
  * This function is provided by the board if the low-level SPI driver
@@ -38,6 +38,9 @@ struct spi_flash {
 	u32		page_size;
 	/* Erase (sector) size */
 	u32		sector_size;
+	/* Array read command and SPI_XFER_* width of its data phase */
+	u8		read_cmd;
+	u8		read_flags;
 
 	int		(*read)(struct spi_flash *flash, u32 offset,
 				size_t len, void *buf);
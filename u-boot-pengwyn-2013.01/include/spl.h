@@ -53,6 +53,7 @@ u32 spl_boot_mode(void);
 void spl_parse_image_header(const struct image_header *header);
 void spl_board_prepare_for_linux(void);
 void __noreturn jump_to_image_linux(void *arg);
+int spl_check_os_args(const void *arg);
 int spl_start_uboot(void);
 void spl_display_print(void);
 
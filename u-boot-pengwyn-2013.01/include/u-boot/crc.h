@@ -30,4 +30,12 @@ uint32_t crc32 (uint32_t, const unsigned char *, uint);
 uint32_t crc32_wd (uint32_t, const unsigned char *, uint, uint);
 uint32_t crc32_no_comp (uint32_t, const unsigned char *, uint);
 
+/* Implementations behind crc32_no_comp(), for benchmarking */
+struct crc32_impl {
+	const char	*name;
+	uint32_t	(*no_comp)(uint32_t, const unsigned char *, uint);
+};
+
+const struct crc32_impl *crc32_get_impl(int n);
+
 #endif /* _UBOOT_CRC_H */
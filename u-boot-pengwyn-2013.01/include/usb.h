@@ -157,6 +157,7 @@ int submit_control_msg(struct usb_device *dev, unsigned long pipe, void *buffer,
 			int transfer_len, struct devrequest *setup);
 int submit_int_msg(struct usb_device *dev, unsigned long pipe, void *buffer,
 			int transfer_len, int interval);
+int usb_get_max_xfer_size(struct usb_device *dev, size_t *size);
 
 /* Defines */
 #define USB_UHCI_VEND_ID	0x8086
@@ -53,7 +53,8 @@ void gzfree(void *x, void *addr, unsigned nb)
 	free (addr);
 }
 
-int gunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp)
+/* Return the offset of the deflate data in a gzip stream, or -1 */
+static int gzip_parse_header(unsigned char *src, unsigned long len)
 {
 	int i, flags;
 
@@ -74,17 +75,87 @@ int gunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp)
 			;
 	if ((flags & HEAD_CRC) != 0)
 		i += 2;
-	if (i >= *lenp) {
+	if (i >= len) {
 		puts ("Error: gunzip out of data in header\n");
 		return (-1);
 	}
 
+	return i;
+}
+
+int gunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp)
+{
+	int i;
+
+	i = gzip_parse_header(src, *lenp);
+	if (i < 0)
+		return (-1);
+
 	return zunzip(dst, dstlen, src, lenp, 1, i);
 }
 
 /*
- * Uncompress blocks compressed with zlib without headers
+ * Like gunzip(), but also compute the CRC32 of all *lenp bytes at src.
+ * The input is handed to inflate() in CHUNKSZ_CRC32 pieces and each piece
+ * is summed right before it is uncompressed, while it is still in the
+ * cache, so checking an image costs no separate pass over it.
  */
+int gunzip_crc32(void *dst, int dstlen, unsigned char *src,
+		 unsigned long *lenp, uint32_t *crc)
+{
+	z_stream s;
+	unsigned long len = *lenp, done;
+	uint chunk;
+	uint32_t c;
+	int i, r;
+
+	i = gzip_parse_header(src, len);
+	if (i < 0)
+		return -1;
+
+	s.zalloc = gzalloc;
+	s.zfree = gzfree;
+
+	r = inflateInit2(&s, -MAX_WBITS);
+	if (r != Z_OK) {
+		printf ("Error: inflateInit2() returned %d\n", r);
+		return -1;
+	}
+
+	c = crc32(0, src, i);
+	done = i;
+	s.next_in = src + i;
+	s.avail_in = 0;
+	s.next_out = dst;
+	s.avail_out = dstlen;
+	do {
+		if (s.avail_in == 0 && done < len) {
+			chunk = min(len - done, (ulong)CHUNKSZ_CRC32);
+			c = crc32(c, src + done, chunk);
+			s.avail_in = chunk;
+			done += chunk;
+			WATCHDOG_RESET();
+		}
+		r = inflate(&s, done == len ? Z_FINISH : Z_NO_FLUSH);
+	} while (r == Z_OK);
+
+	if (r != Z_STREAM_END) {
+		printf("Error: inflate() returned %d\n", r);
+		inflateEnd(&s);
+		return -1;
+	}
+
+	/* the gzip trailer (and any padding) is covered by the CRC too */
+	if (done < len)
+		c = crc32(c, src + done, len - done);
+
+	*crc = c;
+	*lenp = s.next_out - (unsigned char *) dst;
+	inflateEnd(&s);
+
+	return 0;
+}
+
 int zunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp,
 						int stoponerr, int offset)
 {
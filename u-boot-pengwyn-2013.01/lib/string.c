@@ -542,6 +542,11 @@ void * memmove(void * dest,const void *src,size_t count)
 	if (src == dest)
 		return dest;
 
+	/* no overlap (the usual case for image moves): use the fast copy */
+	if ((char *)dest + count <= (char *)src ||
+	    (char *)src + count <= (char *)dest)
+		return memcpy(dest, src, count);
+
 	if (dest <= src) {
 		tmp = (char *) dest;
 		s = (char *) src;
@@ -22,6 +22,13 @@
  * possible, maximum 16 steps). There is no clearing of ".."'s inside the
  * path, so please DON'T DO THAT. thx. */
 
+/* NOTE 4: With CONFIG_NFS_V3 the MOUNT and NFS version 3 programs are used
+ * when the server's portmapper knows them, NFSv2 otherwise.  The file is
+ * read with up to NFS_READ_WINDOW READ requests in flight; each reply is
+ * stored at its own offset, so they may arrive in any order, and only the
+ * requests still outstanding are sent again, on a timeout or once a whole
+ * window of later replies has overtaken them. */
+
 #include <common.h>
 #include <command.h>
 #include <net.h>
@@ -37,13 +44,36 @@
 # define NFS_TIMEOUT CONFIG_NFS_TIMEOUT
 #endif
 
+#define NFS_RPC_ERR	9999	/* RPC or local failure */
+#define NFS_RPC_DROP	9998	/* stale or truncated reply, ignore it */
+
 static int fs_mounted;
 static unsigned long rpc_id;
-static int nfs_offset = -1;
-static int nfs_len;
 
-static char dirfh[NFS_FHSIZE];	/* file handle of directory */
-static char filefh[NFS_FHSIZE]; /* file handle of kernel image */
+#ifdef CONFIG_NFS_V3
+static int nfs_version;
+#define nfs_v3()	(nfs_version == NFS_V3)
+#else
+#define nfs_v3()	0
+#endif
+
+/* READ requests in flight, a free slot has id 0 */
+struct nfs_read_slot {
+	unsigned long id;
+	unsigned int offset;
+	unsigned int len;
+	unsigned int passed;	/* replies to later requests since sent */
+};
+
+static struct nfs_read_slot nfs_slots[NFS_READ_WINDOW];
+static unsigned int nfs_next;	/* next file offset to request */
+static unsigned int nfs_eof;	/* file size, ~0 until the server tells */
+static unsigned int nfs_rcvd;	/* bytes stored, for the hashes */
+
+static char dirfh[NFS3_FHSIZE];	/* file handle of directory */
+static char filefh[NFS3_FHSIZE]; /* file handle of kernel image */
+static int dirfh_len;
+static int filefh_len;
 
 static enum net_loop_state nfs_download_state;
 static IPaddr_t NfsServerIP;
@@ -167,24 +197,40 @@ static long *rpc_add_credentials(long *p)
 	return p;
 }
 
+/**************************************************************************
+RPC_ADD_FH - Add a file handle, NFSv3 handles carry their length
+**************************************************************************/
+static uint32_t *rpc_add_fh(uint32_t *p, const char *fh, int fhlen)
+{
+	if (nfs_v3())
+		*p++ = htonl(fhlen);
+	if (fhlen & 3)
+		*(p + fhlen / 4) = 0; /* add zero padding */
+	memcpy(p, fh, fhlen);
+	return p + (fhlen + 3) / 4;
+}
+
 /**************************************************************************
 RPC_LOOKUP - Lookup RPC Port numbers
 **************************************************************************/
 static void
-rpc_req(int rpc_prog, int rpc_proc, uint32_t *data, int datalen)
+rpc_send(unsigned long id, int rpc_prog, int rpc_proc, uint32_t *data,
+	 int datalen)
 {
 	struct rpc_t pkt;
-	unsigned long id;
 	uint32_t *p;
 	int pktlen;
 	int sport;
+	int vers = 2;	/* portmapper is version 2, and so are MOUNT/NFS */
+
+	if (nfs_v3() && rpc_prog != PROG_PORTMAP)
+		vers = 3;
 
-	id = ++rpc_id;
 	pkt.u.call.id = htonl(id);
 	pkt.u.call.type = htonl(MSG_CALL);
 	pkt.u.call.rpcvers = htonl(2);	/* use RPC version 2 */
 	pkt.u.call.prog = htonl(rpc_prog);
-	pkt.u.call.vers = htonl(2);	/* portmapper is version 2 */
+	pkt.u.call.vers = htonl(vers);
 	pkt.u.call.proc = htonl(rpc_proc);
 	p = (uint32_t *)&(pkt.u.call.data);
 
@@ -207,6 +253,12 @@ rpc_req(int rpc_prog, int rpc_proc, uint32_t *data, int datalen)
 		pktlen);
 }
 
+static void
+rpc_req(int rpc_prog, int rpc_proc, uint32_t *data, int datalen)
+{
+	rpc_send(++rpc_id, rpc_prog, rpc_proc, data, datalen);
+}
+
 /**************************************************************************
 RPC_LOOKUP - Lookup RPC Port numbers
 **************************************************************************/
@@ -291,12 +343,12 @@ nfs_readlink_req(void)
 	p = &(data[0]);
 	p = (uint32_t *)rpc_add_credentials((long *)p);
 
-	memcpy(p, filefh, NFS_FHSIZE);
-	p += (NFS_FHSIZE / 4);
+	p = rpc_add_fh(p, filefh, filefh_len);
 
 	len = (uint32_t *)p - (uint32_t *)&(data[0]);
 
-	rpc_req(PROG_NFS, NFS_READLINK, data, len);
+	rpc_req(PROG_NFS, nfs_v3() ? NFS3PROC_READLINK : NFS_READLINK, data,
+		len);
 }
 
 /**************************************************************************
@@ -315,8 +367,7 @@ nfs_lookup_req(char *fname)
 	p = &(data[0]);
 	p = (uint32_t *)rpc_add_credentials((long *)p);
 
-	memcpy(p, dirfh, NFS_FHSIZE);
-	p += (NFS_FHSIZE / 4);
+	p = rpc_add_fh(p, dirfh, dirfh_len);
 	*p++ = htonl(fnamelen);
 	if (fnamelen & 3)
 		*(p + fnamelen / 4) = 0;
@@ -325,14 +376,14 @@ nfs_lookup_req(char *fname)
 
 	len = (uint32_t *)p - (uint32_t *)&(data[0]);
 
-	rpc_req(PROG_NFS, NFS_LOOKUP, data, len);
+	rpc_req(PROG_NFS, nfs_v3() ? NFS3PROC_LOOKUP : NFS_LOOKUP, data, len);
 }
 
 /**************************************************************************
 NFS_READ - Read File on NFS Server
 **************************************************************************/
 static void
-nfs_read_req(int offset, int readlen)
+nfs_read_req(struct nfs_read_slot *s)
 {
 	uint32_t data[1024];
 	uint32_t *p;
@@ -341,15 +392,75 @@ nfs_read_req(int offset, int readlen)
 	p = &(data[0]);
 	p = (uint32_t *)rpc_add_credentials((long *)p);
 
-	memcpy(p, filefh, NFS_FHSIZE);
-	p += (NFS_FHSIZE / 4);
-	*p++ = htonl(offset);
-	*p++ = htonl(readlen);
-	*p++ = 0;
+	p = rpc_add_fh(p, filefh, filefh_len);
+	if (nfs_v3()) {
+		*p++ = 0;		/* offset3 is 64 bits */
+		*p++ = htonl(s->offset);
+		*p++ = htonl(s->len);
+	} else {
+		*p++ = htonl(s->offset);
+		*p++ = htonl(s->len);
+		*p++ = 0;
+	}
 
 	len = (uint32_t *)p - (uint32_t *)&(data[0]);
 
-	rpc_req(PROG_NFS, NFS_READ, data, len);
+	rpc_send(s->id, PROG_NFS, nfs_v3() ? NFS3PROC_READ : NFS_READ, data,
+		 len);
+}
+
+/* Start reading the file from the beginning */
+static void
+nfs_read_start(void)
+{
+	memset(nfs_slots, 0, sizeof(nfs_slots));
+	nfs_next = 0;
+	nfs_eof = ~0U;
+	nfs_rcvd = 0;
+}
+
+/* Fill free slots with requests for the next parts of the file */
+static void
+nfs_read_fill(void)
+{
+	struct nfs_read_slot *s;
+
+	for (s = nfs_slots; s < nfs_slots + NFS_READ_WINDOW; s++) {
+		if (s->id)
+			continue;
+		if (nfs_next >= nfs_eof)
+			break;
+		s->id = ++rpc_id;
+		s->offset = nfs_next;
+		s->len = NFS_READ_SIZE;
+		s->passed = 0;
+		nfs_next += NFS_READ_SIZE;
+		nfs_read_req(s);
+	}
+}
+
+/* Send again the requests that are still outstanding */
+static void
+nfs_read_resend(void)
+{
+	struct nfs_read_slot *s;
+
+	for (s = nfs_slots; s < nfs_slots + NFS_READ_WINDOW; s++)
+		if (s->id)
+			nfs_read_req(s);
+}
+
+static int
+nfs_read_done(void)
+{
+	struct nfs_read_slot *s;
+
+	if (nfs_eof == ~0U)
+		return 0;
+	for (s = nfs_slots; s < nfs_slots + NFS_READ_WINDOW; s++)
+		if (s->id)
+			return 0;
+	return 1;
 }
 
 /**************************************************************************
@@ -363,10 +474,10 @@ NfsSend(void)
 
 	switch (NfsState) {
 	case STATE_PRCLOOKUP_PROG_MOUNT_REQ:
-		rpc_lookup_req(PROG_MOUNT, 1);
+		rpc_lookup_req(PROG_MOUNT, nfs_v3() ? 3 : 1);
 		break;
 	case STATE_PRCLOOKUP_PROG_NFS_REQ:
-		rpc_lookup_req(PROG_NFS, 2);
+		rpc_lookup_req(PROG_NFS, nfs_v3() ? NFS_V3 : NFS_V2);
 		break;
 	case STATE_MOUNT_REQ:
 		nfs_mount_req(nfs_path);
@@ -378,7 +489,7 @@ NfsSend(void)
 		nfs_lookup_req(nfs_filename);
 		break;
 	case STATE_READ_REQ:
-		nfs_read_req(nfs_offset, nfs_len);
+		nfs_read_resend();
 		break;
 	case STATE_READLINK_REQ:
 		nfs_readlink_req();
@@ -395,7 +506,7 @@ rpc_lookup_reply(int prog, uchar *pkt, unsigned len)
 {
 	struct rpc_t rpc_pkt;
 
-	memcpy((unsigned char *)&rpc_pkt, pkt, len);
+	memcpy((unsigned char *)&rpc_pkt, pkt, min(len, sizeof(rpc_pkt)));
 
 	debug("%s\n", __func__);
 
@@ -426,7 +537,7 @@ nfs_mount_reply(uchar *pkt, unsigned len)
 
 	debug("%s\n", __func__);
 
-	memcpy((unsigned char *)&rpc_pkt, pkt, len);
+	memcpy((unsigned char *)&rpc_pkt, pkt, min(len, sizeof(rpc_pkt)));
 
 	if (ntohl(rpc_pkt.u.reply.id) != rpc_id)
 		return -1;
@@ -438,7 +549,15 @@ nfs_mount_reply(uchar *pkt, unsigned len)
 		return -1;
 
 	fs_mounted = 1;
-	memcpy(dirfh, rpc_pkt.u.reply.data + 1, NFS_FHSIZE);
+	if (nfs_v3()) {
+		dirfh_len = ntohl(rpc_pkt.u.reply.data[1]);
+		if (dirfh_len > NFS3_FHSIZE)
+			return -1;
+		memcpy(dirfh, rpc_pkt.u.reply.data + 2, dirfh_len);
+	} else {
+		dirfh_len = NFS_FHSIZE;
+		memcpy(dirfh, rpc_pkt.u.reply.data + 1, NFS_FHSIZE);
+	}
 
 	return 0;
 }
@@ -450,7 +569,7 @@ nfs_umountall_reply(uchar *pkt, unsigned len)
 
 	debug("%s\n", __func__);
 
-	memcpy((unsigned char *)&rpc_pkt, pkt, len);
+	memcpy((unsigned char *)&rpc_pkt, pkt, min(len, sizeof(rpc_pkt)));
 
 	if (ntohl(rpc_pkt.u.reply.id) != rpc_id)
 		return -1;
@@ -473,7 +592,7 @@ nfs_lookup_reply(uchar *pkt, unsigned len)
 
 	debug("%s\n", __func__);
 
-	memcpy((unsigned char *)&rpc_pkt, pkt, len);
+	memcpy((unsigned char *)&rpc_pkt, pkt, min(len, sizeof(rpc_pkt)));
 
 	if (ntohl(rpc_pkt.u.reply.id) != rpc_id)
 		return -1;
@@ -484,7 +603,22 @@ nfs_lookup_reply(uchar *pkt, unsigned len)
 	    rpc_pkt.u.reply.data[0])
 		return -1;
 
-	memcpy(filefh, rpc_pkt.u.reply.data + 1, NFS_FHSIZE);
+	if (nfs_v3()) {
+		uint32_t *p;
+
+		filefh_len = ntohl(rpc_pkt.u.reply.data[1]);
+		if (filefh_len > NFS3_FHSIZE)
+			return -1;
+		memcpy(filefh, rpc_pkt.u.reply.data + 2, filefh_len);
+
+		/* READ of a symlink fails differently per server, check */
+		p = rpc_pkt.u.reply.data + 2 + (filefh_len + 3) / 4;
+		if (ntohl(p[0]) && ntohl(p[1]) == NF3LNK)
+			return 1;
+	} else {
+		filefh_len = NFS_FHSIZE;
+		memcpy(filefh, rpc_pkt.u.reply.data + 1, NFS_FHSIZE);
+	}
 
 	return 0;
 }
@@ -493,11 +627,12 @@ static int
 nfs_readlink_reply(uchar *pkt, unsigned len)
 {
 	struct rpc_t rpc_pkt;
+	uint32_t *p;
 	int rlen;
 
 	debug("%s\n", __func__);
 
-	memcpy((unsigned char *)&rpc_pkt, pkt, len);
+	memcpy((unsigned char *)&rpc_pkt, pkt, min(len, sizeof(rpc_pkt)));
 
 	if (ntohl(rpc_pkt.u.reply.id) != rpc_id)
 		return -1;
@@ -508,56 +643,126 @@ nfs_readlink_reply(uchar *pkt, unsigned len)
 	    rpc_pkt.u.reply.data[0])
 		return -1;
 
-	rlen = ntohl(rpc_pkt.u.reply.data[1]); /* new path length */
+	p = rpc_pkt.u.reply.data + 1;
+	if (nfs_v3() && ntohl(*p++))	/* symlink_attributes follow */
+		p += NFS3_FATTR_WORDS;
+	rlen = ntohl(*p++); /* new path length */
+	if ((uchar *)p + rlen > (uchar *)&rpc_pkt + min(len, sizeof(rpc_pkt)))
+		return -1;
 
-	if (*((char *)&(rpc_pkt.u.reply.data[2])) != '/') {
+	if (*((char *)p) != '/') {
 		int pathlen;
 		strcat(nfs_path, "/");
 		pathlen = strlen(nfs_path);
-		memcpy(nfs_path + pathlen, (uchar *)&(rpc_pkt.u.reply.data[2]),
-			rlen);
+		if (pathlen + rlen >= sizeof(nfs_path_buff))
+			return -1;
+		memcpy(nfs_path + pathlen, (uchar *)p, rlen);
 		nfs_path[pathlen + rlen] = 0;
 	} else {
-		memcpy(nfs_path, (uchar *)&(rpc_pkt.u.reply.data[2]), rlen);
+		if (rlen >= sizeof(nfs_path_buff))
+			return -1;
+		memcpy(nfs_path, (uchar *)p, rlen);
 		nfs_path[rlen] = 0;
 	}
 	return 0;
 }
 
+static void
+nfs_show_progress(unsigned int rlen)
+{
+	unsigned int step = NFS_READ_SIZE / 2 * 10;
+	unsigned int hashes = nfs_rcvd / step;
+
+	nfs_rcvd += rlen;
+	while (hashes < nfs_rcvd / step) {
+		if (hashes && !(hashes % HASHES_PER_LINE))
+			puts("\n\t ");
+		putc('#');
+		hashes++;
+	}
+}
+
 static int
 nfs_read_reply(uchar *pkt, unsigned len)
 {
 	struct rpc_t rpc_pkt;
-	int rlen;
+	struct nfs_read_slot *s, *o;
+	unsigned long id;
+	uint32_t *p;
+	unsigned int hdrlen, size;
+	int rlen, eof;
 
 	debug("%s\n", __func__);
 
-	memcpy((uchar *)&rpc_pkt, pkt, sizeof(rpc_pkt.u.reply));
+	memcpy((uchar *)&rpc_pkt, pkt, min(len, sizeof(rpc_pkt.u.reply)));
 
-	if (ntohl(rpc_pkt.u.reply.id) != rpc_id)
-		return -1;
+	id = ntohl(rpc_pkt.u.reply.id);
+	for (s = nfs_slots; s < nfs_slots + NFS_READ_WINDOW; s++)
+		if (s->id && s->id == id)
+			break;
+	if (s == nfs_slots + NFS_READ_WINDOW)
+		return -NFS_RPC_DROP;
 
 	if (rpc_pkt.u.reply.rstatus  ||
 	    rpc_pkt.u.reply.verifier ||
 	    rpc_pkt.u.reply.astatus  ||
 	    rpc_pkt.u.reply.data[0]) {
 		if (rpc_pkt.u.reply.rstatus)
-			return -9999;
+			return -NFS_RPC_ERR;
 		if (rpc_pkt.u.reply.astatus)
-			return -9999;
+			return -NFS_RPC_ERR;
 		return -ntohl(rpc_pkt.u.reply.data[0]);
 	}
 
-	if ((nfs_offset != 0) && !((nfs_offset) %
-			(NFS_READ_SIZE / 2 * 10 * HASHES_PER_LINE)))
-		puts("\n\t ");
-	if (!(nfs_offset % ((NFS_READ_SIZE / 2) * 10)))
-		putc('#');
+	p = rpc_pkt.u.reply.data + 1;
+	if (nfs_v3()) {
+		if (ntohl(*p++))	/* file_attributes follow */
+			p += NFS3_FATTR_WORDS;
+		rlen = ntohl(*p++);
+		eof = ntohl(*p++);
+		p++;			/* length of the opaque data */
+	} else {
+		/* no eof flag in NFSv2, compare with the size in the fattr */
+		size = ntohl(p[5]);
+		p += 17;		/* fattr */
+		rlen = ntohl(*p++);
+		eof = s->offset + rlen >= size;
+	}
+	hdrlen = (uchar *)p - (uchar *)&rpc_pkt;
+	if (hdrlen > len || rlen < 0 || rlen > s->len ||
+	    len - hdrlen < rlen)
+		return -NFS_RPC_DROP;	/* lost fragments, sent again */
+
+	/* an empty reply past the end must not stretch the file size */
+	if (rlen && store_block(pkt + hdrlen, s->offset, rlen))
+		return -NFS_RPC_ERR;
+	nfs_show_progress(rlen);
+
+	/*
+	 * A request overtaken by a whole window of later replies has most
+	 * likely lost its reply: ask again now rather than at the timeout.
+	 */
+	for (o = nfs_slots; o < nfs_slots + NFS_READ_WINDOW; o++) {
+		if (o->id && o->id < id && ++o->passed >= NFS_READ_WINDOW) {
+			o->passed = 0;
+			nfs_read_req(o);
+		}
+	}
 
-	rlen = ntohl(rpc_pkt.u.reply.data[18]);
-	if (store_block((uchar *)pkt + sizeof(rpc_pkt.u.reply),
-			nfs_offset, rlen))
-		return -9999;
+	if (eof || !rlen) {
+		if (s->offset + rlen < nfs_eof)
+			nfs_eof = s->offset + rlen;
+		s->id = 0;
+	} else if (rlen < s->len) {
+		/* short read, ask for the rest of this range */
+		s->id = ++rpc_id;
+		s->offset += rlen;
+		s->len -= rlen;
+		s->passed = 0;
+		nfs_read_req(s);
+	} else {
+		s->id = 0;
+	}
 
 	return rlen;
 }
@@ -589,6 +794,15 @@ NfsHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src, unsigned len)
 	if (dest != NfsOurPort)
 		return;
 
+	/* late replies to READs that were in flight when reading stopped */
+	if (NfsState != STATE_READ_REQ && len >= sizeof(uint32_t)) {
+		uint32_t id;
+
+		memcpy(&id, pkt, sizeof(id));
+		if (ntohl(id) != rpc_id)
+			return;
+	}
+
 	switch (NfsState) {
 	case STATE_PRCLOOKUP_PROG_MOUNT_REQ:
 		rpc_lookup_reply(PROG_MOUNT, pkt, len);
@@ -597,7 +811,17 @@ NfsHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src, unsigned len)
 		break;
 
 	case STATE_PRCLOOKUP_PROG_NFS_REQ:
-		rpc_lookup_reply(PROG_NFS, pkt, len);
+		if (!rpc_lookup_reply(PROG_NFS, pkt, len) && nfs_v3() &&
+		    (!NfsSrvMountPort || !NfsSrvNfsPort)) {
+			/* portmapper has no port for the version 3 programs */
+			puts("NFSv3 not available, using NFSv2 ");
+#ifdef CONFIG_NFS_V3
+			nfs_version = NFS_V2;
+#endif
+			NfsState = STATE_PRCLOOKUP_PROG_MOUNT_REQ;
+			NfsSend();
+			break;
+		}
 		NfsState = STATE_MOUNT_REQ;
 		NfsSend();
 		break;
@@ -625,15 +849,19 @@ NfsHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src, unsigned len)
 		break;
 
 	case STATE_LOOKUP_REQ:
-		if (nfs_lookup_reply(pkt, len)) {
+		rlen = nfs_lookup_reply(pkt, len);
+		if (rlen < 0) {
 			puts("*** ERROR: File lookup fail\n");
 			NfsState = STATE_UMOUNT_REQ;
 			NfsSend();
+		} else if (rlen > 0) {
+			/* symbolic link */
+			NfsState = STATE_READLINK_REQ;
+			NfsSend();
 		} else {
 			NfsState = STATE_READ_REQ;
-			nfs_offset = 0;
-			nfs_len = NFS_READ_SIZE;
-			NfsSend();
+			nfs_read_start();
+			nfs_read_fill();
 		}
 		break;
 
@@ -654,17 +882,23 @@ NfsHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src, unsigned len)
 
 	case STATE_READ_REQ:
 		rlen = nfs_read_reply(pkt, len);
+		if (rlen == -NFS_RPC_DROP)
+			break;
 		NetSetTimeout(NFS_TIMEOUT, NfsTimeout);
-		if (rlen > 0) {
-			nfs_offset += rlen;
-			NfsSend();
+		if (rlen >= 0) {
+			NfsTimeoutCount = 0;	/* progress, the link works */
+			if (nfs_read_done()) {
+				nfs_download_state = NETLOOP_SUCCESS;
+				NfsState = STATE_UMOUNT_REQ;
+				NfsSend();
+			} else {
+				nfs_read_fill();
+			}
 		} else if ((rlen == -NFSERR_ISDIR) || (rlen == -NFSERR_INVAL)) {
 			/* symbolic link */
 			NfsState = STATE_READLINK_REQ;
 			NfsSend();
 		} else {
-			if (!rlen)
-				nfs_download_state = NETLOOP_SUCCESS;
 			NfsState = STATE_UMOUNT_REQ;
 			NfsSend();
 		}
@@ -743,6 +977,9 @@ NfsStart(void)
 
 	NfsTimeoutCount = 0;
 	NfsState = STATE_PRCLOOKUP_PROG_MOUNT_REQ;
+#ifdef CONFIG_NFS_V3
+	nfs_version = NFS_V3;
+#endif
 
 	/*NfsOurPort = 4096 + (get_ticks() % 3072);*/
 	/*FIX ME !!!*/
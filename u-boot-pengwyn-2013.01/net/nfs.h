@@ -28,7 +28,18 @@
 #define NFS_READLINK    5
 #define NFS_READ        6
 
+#define NFS3PROC_LOOKUP		3
+#define NFS3PROC_READLINK	5
+#define NFS3PROC_READ		6
+
 #define NFS_FHSIZE      32
+#define NFS3_FHSIZE     64
+
+#define NFS_V2		2
+#define NFS_V3		3
+
+#define NFS3_FATTR_WORDS	21	/* size of a fattr3 */
+#define NF3LNK			5	/* fattr3 type of a symlink */
 
 #define NFSERR_PERM     1
 #define NFSERR_NOENT    2
@@ -47,6 +58,13 @@
 #define NFS_READ_SIZE 1024 /* biggest power of two that fits Ether frame */
 #endif
 
+/* Number of READ requests kept in flight at the same time */
+#ifdef CONFIG_NFS_READ_WINDOW
+#define NFS_READ_WINDOW CONFIG_NFS_READ_WINDOW
+#else
+#define NFS_READ_WINDOW 1
+#endif
+
 #define NFS_MAXLINKDEPTH 16
 
 struct rpc_t {
@@ -68,7 +86,7 @@ struct rpc_t {
 			uint32_t verifier;
 			uint32_t v2;
 			uint32_t astatus;
-			uint32_t data[19];
+			uint32_t data[26];	/* NFSv3 READ reply header */
 		} reply;
 	} u;
 };
@@ -129,6 +129,24 @@ static char tftp_filename[MAX_LEN];
 static unsigned short TftpBlkSize = TFTP_BLOCK_SIZE;
 static unsigned short TftpBlkSizeOption = TFTP_MTU_BLOCKSIZE;
 
+/*
+ * RFC 7440 windowsize: the server sends this many blocks before waiting
+ * for an ACK, so a transfer is no longer bound to one round trip per
+ * block.  Reads only; 1 is plain lock-step TFTP and sends no option.
+ */
+#ifdef CONFIG_TFTP_WINDOWSIZE
+#define TFTP_WINDOWSIZE CONFIG_TFTP_WINDOWSIZE
+#else
+#define TFTP_WINDOWSIZE 1
+#endif
+
+static unsigned short TftpWindowSize = 1;
+static unsigned short TftpWindowSizeOption = TFTP_WINDOWSIZE;
+/* block number that completes the current window */
+static ulong	TftpNextAck;
+/* last block acknowledged again because of a gap in the window */
+static ulong	TftpLastNack;
+
 #ifdef CONFIG_MCAST_TFTP
 #include <malloc.h>
 #define MTFTP_BITMAPSIZE	0x1000
@@ -200,6 +218,7 @@ static void new_transfer(void)
 	TftpLastBlock = 0;
 	TftpBlockWrap = 0;
 	TftpBlockWrapOffset = 0;
+	TftpLastNack = -1;
 #ifdef CONFIG_CMD_TFTPPUT
 	TftpFinalBlock = 0;
 #endif
@@ -352,6 +371,9 @@ TftpSend(void)
 		/* try for more effic. blk size */
 		pkt += sprintf((char *)pkt, "blksize%c%d%c",
 				0, TftpBlkSizeOption, 0);
+		if (TftpState == STATE_SEND_RRQ && TftpWindowSizeOption > 1)
+			pkt += sprintf((char *)pkt, "windowsize%c%d%c",
+					0, TftpWindowSizeOption, 0);
 #ifdef CONFIG_MCAST_TFTP
 		/* Check all preconditions before even trying the option */
 		if (!ProhibitMcast) {
@@ -383,6 +405,8 @@ TftpSend(void)
 		s[0] = htons(TFTP_ACK);
 		s[1] = htons(TftpBlock);
 		pkt = (uchar *)(s + 2);
+		/* the server sends a new window after each ACK */
+		TftpNextAck = (unsigned short)(TftpBlock + TftpWindowSize);
 #ifdef CONFIG_CMD_TFTPPUT
 		if (TftpWriting) {
 			int toload = TftpBlkSize;
@@ -508,6 +532,7 @@ TftpHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src,
 			pkt + strlen((char *)pkt) + 1);
 		TftpState = STATE_OACK;
 		TftpRemotePort = src;
+		TftpLastNack = -1;
 		/*
 		 * Check for 'blksize' option.
 		 * Careful: "i" is signed, "len" is unsigned, thus
@@ -521,6 +546,15 @@ TftpHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src,
 				debug("Blocksize ack: %s, %d\n",
 					(char *)pkt+i+8, TftpBlkSize);
 			}
+			if (strcmp((char *)pkt+i, "windowsize") == 0) {
+				TftpWindowSize = (unsigned short)
+					simple_strtoul((char *)pkt+i+11, NULL,
+						       10);
+				if (TftpWindowSize == 0)
+					TftpWindowSize = 1;
+				debug("Windowsize ack: %s, %d\n",
+					(char *)pkt+i+11, TftpWindowSize);
+			}
 #ifdef CONFIG_TFTP_TSIZE
 			if (strcmp((char *)pkt+i, "tsize") == 0) {
 				TftpTsize = simple_strtoul((char *)pkt+i+6,
@@ -532,6 +566,8 @@ TftpHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src,
 		}
 #ifdef CONFIG_MCAST_TFTP
 		parse_multicast_oack((char *)pkt, len-1);
+		if (Multicast)
+			TftpWindowSize = 1;
 		if ((Multicast) && (!MasterClient))
 			TftpState = STATE_DATA;	/* passive.. */
 		else
@@ -551,6 +587,36 @@ TftpHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src,
 		len -= 2;
 		TftpBlock = ntohs(*(ushort *)pkt);
 
+		/*
+		 * With a window in flight, a lost block shows up as a gap.
+		 * Drop whatever follows it, as well as duplicates, and ack
+		 * the last block received in order, once per gap: the
+		 * server then resends the window from there.  This has to
+		 * come before the wrap check below.  If block 1 itself was
+		 * lost, ack block 0 again rather than start over.
+		 */
+		if (TftpState == STATE_OACK && TftpWindowSize > 1 &&
+		    TftpBlock != 1) {
+			debug("Unexpected block %lu, expected 1\n", TftpBlock);
+			TftpBlock = 0;
+			if (TftpLastNack != 0) {
+				TftpLastNack = 0;
+				TftpSend();
+			}
+			break;
+		}
+		if (TftpState == STATE_DATA && TftpWindowSize > 1 &&
+		    TftpBlock != (unsigned short)(TftpLastBlock + 1)) {
+			debug("Unexpected block %lu, expected %lu\n",
+			      TftpBlock, (TftpLastBlock + 1) & 0xffff);
+			TftpBlock = TftpLastBlock;
+			if (TftpLastNack != TftpLastBlock) {
+				TftpLastNack = TftpLastBlock;
+				TftpSend();
+			}
+			break;
+		}
+
 		update_block_number();
 
 		if (TftpState == STATE_SEND_RRQ)
@@ -620,7 +686,10 @@ TftpHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src,
 			}
 		}
 #endif
-		TftpSend();
+		/* With a window, only its last block and the final one */
+		if (TftpWindowSize == 1 || TftpBlock == TftpNextAck ||
+		    len < TftpBlkSize)
+			TftpSend();
 
 #ifdef CONFIG_MCAST_TFTP
 		if (Multicast) {
@@ -694,6 +763,10 @@ void TftpStart(enum proto_t protocol)
 	if (ep != NULL)
 		TftpTimeoutMSecs = simple_strtol(ep, NULL, 10);
 
+	ep = getenv("tftpwindowsize");
+	if (ep != NULL)
+		TftpWindowSizeOption = simple_strtol(ep, NULL, 10);
+
 	if (TftpTimeoutMSecs < 1000) {
 		printf("TFTP timeout (%ld ms) too low, "
 			"set minimum = 1000 ms\n",
@@ -701,8 +774,8 @@ void TftpStart(enum proto_t protocol)
 		TftpTimeoutMSecs = 1000;
 	}
 
-	debug("TFTP blocksize = %i, timeout = %ld ms\n",
-		TftpBlkSizeOption, TftpTimeoutMSecs);
+	debug("TFTP blocksize = %i, windowsize = %i, timeout = %ld ms\n",
+		TftpBlkSizeOption, TftpWindowSizeOption, TftpTimeoutMSecs);
 
 	TftpRemoteIP = NetServerIP;
 	if (BootFile[0] == '\0') {
@@ -799,8 +872,9 @@ void TftpStart(enum proto_t protocol)
 
 	/* zero out server ether in case the server ip has changed */
 	memset(NetServerEther, 0, 6);
-	/* Revert TftpBlkSize to dflt */
+	/* Revert TftpBlkSize and TftpWindowSize to dflt */
 	TftpBlkSize = TFTP_BLOCK_SIZE;
+	TftpWindowSize = 1;
 #ifdef CONFIG_MCAST_TFTP
 	mcast_cleanup();
 #endif
@@ -829,8 +903,9 @@ TftpStartServer(void)
 	TftpTimeoutMSecs = TIMEOUT;
 	NetSetTimeout(TftpTimeoutMSecs, TftpTimeout);
 
-	/* Revert TftpBlkSize to dflt */
+	/* Revert TftpBlkSize and TftpWindowSize to dflt */
 	TftpBlkSize = TFTP_BLOCK_SIZE;
+	TftpWindowSize = 1;
 	TftpBlock = 0;
 	TftpOurPort = WELL_KNOWN_PORT;
 